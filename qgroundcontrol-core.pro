@@ -0,0 +1,56 @@
+#-------------------------------------------------
+#
+# QGroundControl - Micro Air Vehicle Groundstation
+#
+# Please see our website at <http://qgroundcontrol.org>
+#
+# Author:
+# Lorenz Meier <mavteam@student.ethz.ch>
+#
+# (c) 2009-2010 PIXHAWK Team
+#
+# This file is part of the mav groundstation project
+# QGroundControl is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+# QGroundControl is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+# You should have received a copy of the GNU General Public License
+# along with QGroundControl. If not, see <http://www.gnu.org/licenses/>.
+#
+#-------------------------------------------------
+
+# Static library with the links, the MAVLink protocol stack and the vehicle
+# model, built without any dialog or audio output. Used by the headless
+# server in standalone/qgroundcontrol-server.
+#
+# QtGui is still linked because the vehicle model hands out QColor values
+# for plot colors, but no widget is ever created.
+
+QT += network
+
+TEMPLATE = lib
+CONFIG += staticlib
+TARGET = qgroundcontrol-core
+BASEDIR = .
+BUILDDIR = build/core
+LANGUAGE = C++
+CONFIG += debug_and_release
+OBJECTS_DIR = $$BUILDDIR/obj
+MOC_DIR = $$BUILDDIR/moc
+DESTDIR = $$BASEDIR/lib
+
+DEFINES += QGC_NO_GUI
+
+INCLUDEPATH += . \
+    $$BASEDIR/../mavlink/contrib/slugs/include \
+    $$BASEDIR/../mavlink/include
+
+# Include serial port library
+include(src/lib/qextserialport/qextserialport.pri)
+
+# Include communication and vehicle core
+include(src/core.pri)
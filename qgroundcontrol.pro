@@ -36,6 +36,9 @@ include(src/lib/qextserialport/qextserialport.pri)
 
 # Include QWT plotting library
 include(src/lib/qwt/qwt.pri)
+
+# Include communication and vehicle core
+include(src/core.pri)
 DEPENDPATH += . \
     lib/QMapControl \
     lib/QMapControl/src \
@@ -89,18 +92,8 @@ INCLUDEPATH += src \
     src/ui/mavlink \
     src/ui/param \
     src/ui/watchdog
-HEADERS += src/MG.h \
-    src/Core.h \
-    src/uas/UASInterface.h \
-    src/uas/UAS.h \
-    src/uas/UASManager.h \
-    src/comm/LinkManager.h \
-    src/comm/LinkInterface.h \
-    src/comm/SerialLinkInterface.h \
-    src/comm/SerialLink.h \
+HEADERS += src/Core.h \
     src/comm/SerialSimulationLink.h \
-    src/comm/ProtocolInterface.h \
-    src/comm/MAVLinkProtocol.h \
     src/comm/AS4Protocol.h \
     src/ui/CommConfigurationWindow.h \
     src/ui/SerialConfigurationWindow.h \
@@ -113,14 +106,11 @@ HEADERS += src/MG.h \
     src/ui/linechart/LinechartPlot.h \
     src/ui/linechart/Scrollbar.h \
     src/ui/linechart/ScrollZoomer.h \
-    src/configuration.h \
     src/ui/uas/UASView.h \
     src/ui/CameraView.h \
     src/comm/MAVLinkSimulationLink.h \
-    src/comm/UDPLink.h \
     src/ui/ParameterInterface.h \
     src/ui/WaypointList.h \
-    src/Waypoint.h \
     src/ui/WaypointView.h \
     src/ui/ObjectDetectionView.h \
     src/input/JoystickInput.h \
@@ -136,19 +126,18 @@ HEADERS += src/MG.h \
     src/ui/AudioOutputWidget.h \
     src/GAudioOutput.h \
     src/LogCompressor.h \
+    src/QGCCsvLoader.h \
+    src/LogWriter.h \
+    src/LogReader.h \
+    src/MissionLogReader.h \
     src/ui/QGCParamWidget.h \
     src/ui/QGCSensorSettingsWidget.h \
     src/ui/linechart/Linecharts.h \
-    src/uas/SlugsMAV.h \
-    src/uas/PxQuadMAV.h \
-    src/uas/ArduPilotMAV.h \
     src/comm/MAVLinkSyntaxHighlighter.h \
     src/ui/watchdog/WatchdogControl.h \
     src/ui/watchdog/WatchdogProcessView.h \
     src/ui/watchdog/WatchdogView.h \
-    src/uas/UASWaypointManager.h \
     src/ui/HSIDisplay.h \
-    src/QGC.h \
     src/ui/QGCFirmwareUpdate.h \
     src/ui/QGCPxImuFirmwareUpdate.h \
     src/comm/MAVLinkLightProtocol.h \
@@ -157,15 +146,12 @@ HEADERS += src/MG.h \
     src/ui/map/Waypoint2DIcon.h \
     src/ui/map/MAV2DIcon.h \
     src/ui/map/QGC2DIcon.h \
-    src/ui/QGCRemoteControlView.h
+    src/ui/QGCRemoteControlView.h \
+    src/ui/LinkStatisticsView.h \
+    src/ui/MessageBandwidthView.h
 SOURCES += src/main.cc \
     src/Core.cc \
-    src/uas/UASManager.cc \
-    src/uas/UAS.cc \
-    src/comm/LinkManager.cc \
-    src/comm/SerialLink.cc \
     src/comm/SerialSimulationLink.cc \
-    src/comm/MAVLinkProtocol.cc \
     src/comm/AS4Protocol.cc \
     src/ui/CommConfigurationWindow.cc \
     src/ui/SerialConfigurationWindow.cc \
@@ -181,10 +167,8 @@ SOURCES += src/main.cc \
     src/ui/uas/UASView.cc \
     src/ui/CameraView.cc \
     src/comm/MAVLinkSimulationLink.cc \
-    src/comm/UDPLink.cc \
     src/ui/ParameterInterface.cc \
     src/ui/WaypointList.cc \
-    src/Waypoint.cc \
     src/ui/WaypointView.cc \
     src/ui/ObjectDetectionView.cc \
     src/input/JoystickInput.cc \
@@ -200,19 +184,18 @@ SOURCES += src/main.cc \
     src/ui/AudioOutputWidget.cc \
     src/GAudioOutput.cc \
     src/LogCompressor.cc \
+    src/QGCCsvLoader.cc \
+    src/LogWriter.cc \
+    src/LogReader.cc \
+    src/MissionLogReader.cc \
     src/ui/QGCParamWidget.cc \
     src/ui/QGCSensorSettingsWidget.cc \
     src/ui/linechart/Linecharts.cc \
-    src/uas/SlugsMAV.cc \
-    src/uas/PxQuadMAV.cc \
-    src/uas/ArduPilotMAV.cc \
     src/comm/MAVLinkSyntaxHighlighter.cc \
     src/ui/watchdog/WatchdogControl.cc \
     src/ui/watchdog/WatchdogProcessView.cc \
     src/ui/watchdog/WatchdogView.cc \
-    src/uas/UASWaypointManager.cc \
     src/ui/HSIDisplay.cc \
-    src/QGC.cc \
     src/ui/QGCFirmwareUpdate.cc \
     src/ui/QGCPxImuFirmwareUpdate.cc \
     src/comm/MAVLinkLightProtocol.cc \
@@ -221,7 +204,9 @@ SOURCES += src/main.cc \
     src/ui/map/Waypoint2DIcon.cc \
     src/ui/map/MAV2DIcon.cc \
     src/ui/map/QGC2DIcon.cc \
-    src/ui/QGCRemoteControlView.cc
+    src/ui/QGCRemoteControlView.cc \
+    src/ui/LinkStatisticsView.cc \
+    src/ui/MessageBandwidthView.cc
 RESOURCES = mavground.qrc
 
 # Include RT-LAB Library
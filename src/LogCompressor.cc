@@ -29,9 +29,11 @@ This file is part of the QGROUNDCONTROL project
  */
 
 #include <QFile>
-#include <QTextStream>
-#include <QStringList>
 #include <QFileInfo>
+#include <QTemporaryFile>
+#include <QMap>
+#include <QtAlgorithms>
+#include <limits>
 #include "LogCompressor.h"
 
 #include <QDebug>
@@ -45,139 +47,320 @@ LogCompressor::LogCompressor(QString logFileName, QString outFileName, int uasid
         running(true),
         currentDataLine(0),
         dataLines(1),
-        uasid(uasid)
+        uasid(uasid),
+        memoryBudget(64 * 1024 * 1024),
+        aborted(false),
+        memoryUsed(0)
 {
+    // Rows are delivered to other threads by queued connections
+    qRegisterMetaType<QVector<double> >("QVector<double>");
+}
+
+LogCompressor::~LogCompressor()
+{
+    wait();
+    qDeleteAll(runs);
 }
 
 void LogCompressor::run()
 {
-    QString separator = "\t";
-    QString fileName = logFileName;
-    QFile file(fileName);
+    lastUpdate.start();
+    if (!compress())
+    {
+        qDeleteAll(runs);
+        runs.clear();
+    }
+    running = false;
+}
+
+bool LogCompressor::compress()
+{
+    const char separator = '\t';
+    QFile file(logFileName);
     QFile outfile(outFileName);
-    QStringList* keys = new QStringList();
-    QStringList* times = new QStringList();
 
-    if (!file.exists()) return;
+    if (!file.exists()) return false;
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-        return;
+        return false;
 
     if (outFileName != "")
     {
         // Check if file is writeable
         if (!QFileInfo(outfile).isWritable())
         {
-            return;
+            return false;
         }
     }
 
-    // Find all keys
-    QTextStream in(&file);
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        // Accumulate map of keys
-        // Data field name is at position 2
-        QString key = line.split(separator).at(2);
-        if (!keys->contains(key)) keys->append(key);
-    }
-    keys->sort();
+    // Progress is counted in kilobytes, once for reading the raw
+    // log and once for merging the runs
+    int inputKiB = qMax((qint64)1, file.size() / 1024);
+    dataLines = 2 * inputKiB;
 
-    QString header = "";
-    QString spacer = "";
-    for (int i = 0; i < keys->length(); i++)
+    // Collect the samples in a single pass
+    while (!file.atEnd())
     {
-        header += keys->at(i) + separator;
-        spacer += " " + separator;
-    }
+        if (aborted) return false;
+        QByteArray line = file.readLine();
+        currentDataLine = file.pos() / 1024;
+        updateProgress();
+        if (line.endsWith('\n')) line.chop(1);
+        // Fields are time, system id, value name and value
+        QList<QByteArray> parts = line.split(separator);
+        if (parts.size() < 3) continue;
+        const QByteArray& time = parts.at(0);
+        const QByteArray& field = parts.at(2);
+        QByteArray value = (parts.size() > 3) ? parts.at(3) : QByteArray();
+        // Enforce NaN if no value is present
+        if (value.trimmed().isEmpty())
+        {
+            value = "NaN";
+        }
+
+        int column = keyIndex.value(field, -1);
+        if (column < 0)
+        {
+            column = keys.size();
+            keyIndex.insert(field, column);
+            keys.append(field);
+            columns.append(QVector<QByteArray>());
+        }
+        int row = timeIndex.value(time, -1);
+        if (row < 0)
+        {
+            row = times.size();
+            timeIndex.insert(time, row);
+            times.append(time);
+            memoryUsed += time.size() + 64;
+        }
+        QVector<QByteArray>& values = columns[column];
+        if (values.size() <= row)
+        {
+            memoryUsed += (times.size() - values.size()) * sizeof(QByteArray);
+            values.resize(times.size());
+        }
+        memoryUsed += value.size() + 32;
+        // A later sample of the same value and time replaces the earlier one
+        values[row] = value;
 
-    //qDebug() << header;
-
-    //qDebug() << "NOW READING TIMES";
-
-    // Find all times
-    //in.reset();
-    file.reset();
-    in.reset();
-    in.resetStatus();
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        // Accumulate map of keys
-        // Data field name is at position 2
-        QString time = line.split(separator).at(0);
-        if (!times->contains(time))
+        if (memoryUsed > memoryBudget && !spill())
         {
-            times->append(time);
+            return false;
         }
     }
+    file.close();
+    if (aborted || !spill()) return false;
 
-    dataLines = times->length();
+    qint64 runBytes = 0;
+    foreach (QTemporaryFile* runFile, runs)
+    {
+        runBytes += runFile->size();
+    }
 
-    times->sort();
+    if (outFileName == "")
+    {
+        // The raw log has been read completely and can be replaced
+        QFile::remove(file.fileName());
+        outfile.setFileName(file.fileName());
+    }
+    if (!outfile.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+    if (!merge(outfile, runBytes))
+        return false;
+    outfile.close();
+
+    qDeleteAll(runs);
+    runs.clear();
+    currentDataLine = dataLines;
+    updateProgress(true);
+    currentDataLine = 0;
+    dataLines = 1;
+    qDebug() << "Done with logfile processing";
+    emit finishedFile(outfile.fileName());
+    return true;
+}
+
+/**
+ * The rows are written ordered by timestamp, one line per row with the
+ * timestamp followed by pairs of column and value. Only the values which
+ * are set are written. The memory of the run is released afterwards.
+ *
+ * @return true if the run was written, false if the disk is not writable
+ */
+bool LogCompressor::spill()
+{
+    if (times.isEmpty()) return true;
 
-    // Create lines
-    QStringList* outLines = new QStringList();
-    for (int i = 0; i < times->length(); i++)
+    // Runs are stored next to the raw log, the temporary directory
+    // is often too small for the logs of long flights
+    QTemporaryFile* runFile = new QTemporaryFile(QFileInfo(logFileName).absolutePath() + "/qgc_log_run_XXXXXX");
+    runs.append(runFile);
+    if (!runFile->open())
     {
-        outLines->append(times->at(i) + separator + spacer);
+        qDebug() << "Could not write run file for" << logFileName;
+        return false;
     }
 
-    // Fill in the values for all keys
-    file.reset();
-    QTextStream data(&file);
-    int linecounter = 0;
-    while (!data.atEnd()) {
-        linecounter++;
-        currentDataLine = linecounter;
-        QString line = data.readLine();
-        QStringList parts = line.split(separator);
-        // Get time
-        QString time = parts.first();
-        QString field = parts.at(2);
-        QString value = parts.at(3);
-        // Enforce NaN if no value is present
-        if (value.length() == 0 || value == "" || value == " " || value == "\t" || value == "\n")
+    QVector<QPair<QByteArray, int> > order;
+    order.reserve(times.size());
+    for (int row = 0; row < times.size(); row++)
+    {
+        order.append(qMakePair(times.at(row), row));
+    }
+    qSort(order);
+
+    QByteArray line;
+    for (int i = 0; i < order.size(); i++)
+    {
+        int row = order.at(i).second;
+        line = order.at(i).first;
+        for (int column = 0; column < columns.size(); column++)
         {
-            value = "NaN";
+            const QVector<QByteArray>& values = columns.at(column);
+            if (row < values.size() && !values.at(row).isNull())
+            {
+                line += '\t';
+                line += QByteArray::number(column);
+                line += '\t';
+                line += values.at(row);
+            }
         }
-        // Get matching output line
-        quint64 index = times->indexOf(time);
-        QString outLine = outLines->at(index);
-        QStringList outParts = outLine.split(separator);
-        // Replace measurement placeholder with current value
-        outParts.replace(keys->indexOf(field)+1, value);
-        outLine = outParts.join(separator);
-        outLines->replace(index, outLine);
+        line += '\n';
+        runFile->write(line);
     }
+    runFile->flush();
+    runFile->reset();
 
+    timeIndex.clear();
+    times.clear();
+    for (int column = 0; column < columns.size(); column++)
+    {
+        columns[column].clear();
+    }
+    memoryUsed = 0;
+    return true;
+}
 
-
-    // Add header, write out file
-    file.close();
-
-    if (outFileName == "")
+/**
+ * All runs are read in parallel, the timestamps in each run are sorted and
+ * unique. Rows of the same timestamp in several runs are combined, the
+ * values of later runs replace those of earlier ones like in the raw log.
+ *
+ * @param outfile The opened output file
+ * @param runBytes Total size of the runs, for the progress
+ * @return true if the output was written completely
+ */
+bool LogCompressor::merge(QFile& outfile, qint64 runBytes)
+{
+    const char separator = '\t';
+    int inputKiB = dataLines / 2;
+
+    // Output columns are ordered by value name
+    QList<QByteArray> sortedKeys = keys;
+    qSort(sortedKeys);
+    QVector<int> position(keys.size());
+    QByteArray header("unix_timestamp");
+    header += separator;
+    for (int i = 0; i < sortedKeys.size(); i++)
     {
-        QFile::remove(file.fileName());
-        outfile.setFileName(file.fileName());
+        position[keyIndex.value(sortedKeys.at(i))] = i;
+        header += QByteArray(sortedKeys.at(i)).replace(' ', '_');
+        header += separator;
+    }
+    header += '\n';
+    if (outfile.write(header) < 0) return false;
+
+    // The merged rows are only converted to numbers if somebody listens
+    bool emitRows = receivers(SIGNAL(rowsCompressed(QVector<double>,int))) > 0;
+    QVector<double> rows;
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    QStringList names("unix_timestamp");
+    foreach (const QByteArray& key, sortedKeys)
+    {
+        names.append(QString::fromLatin1(QByteArray(key).replace(' ', '_')));
+    }
+    emit columnsFound(names);
+    // Overwriting the raw log can not be stopped, it has been removed already
+    bool abortable = (outfile.fileName() != logFileName);
+
+    // Current line of each run, queued by timestamp
+    QVector<QList<QByteArray> > heads(runs.size());
+    QMap<QByteArray, QList<int> > pending;
+    qint64 consumed = 0;
+    for (int i = 0; i < runs.size(); i++)
+    {
+        if (!runs.at(i)->atEnd())
+        {
+            QByteArray line = runs.at(i)->readLine();
+            consumed += line.size();
+            line.chop(1);
+            heads[i] = line.split(separator);
+            pending[heads[i].first()].append(i);
+        }
     }
-    if (!outfile.open(QIODevice::WriteOnly | QIODevice::Text))
-        return;
-    outfile.write(QString(QString("unix_timestamp") + separator + header.replace(" ", "_") + QString("\n")).toLatin1());
-    //QString fileHeader = QString("unix_timestamp") + header.replace(" ", "_") + QString("\n");
 
-    // File output
-    for (int i = 0; i < outLines->length(); i++)
+    QVector<QByteArray> row(keys.size());
+    QByteArray line;
+    while (!pending.isEmpty())
     {
-        //qDebug() << outLines->at(i);
-        outfile.write(QString(outLines->at(i) + "\n").toLatin1());
+        QMap<QByteArray, QList<int> >::iterator first = pending.begin();
+        QByteArray time = first.key();
+        QList<int> current = first.value();
+        pending.erase(first);
+        qSort(current);
+
+        row.fill(QByteArray());
+        foreach (int i, current)
+        {
+            const QList<QByteArray>& parts = heads.at(i);
+            for (int j = 1; j + 1 < parts.size(); j += 2)
+            {
+                row[position[parts.at(j).toInt()]] = parts.at(j + 1);
+            }
+            if (!runs.at(i)->atEnd())
+            {
+                QByteArray next = runs.at(i)->readLine();
+                consumed += next.size();
+                next.chop(1);
+                heads[i] = next.split(separator);
+                pending[heads[i].first()].append(i);
+            }
+        }
 
-    }
+        line = time;
+        line += separator;
+        for (int i = 0; i < row.size(); i++)
+        {
+            line += row.at(i).isNull() ? QByteArray(" ") : row.at(i);
+            line += separator;
+        }
+        line += '\n';
+        if (outfile.write(line) < 0) return false;
+        currentDataLine = inputKiB + (int)(consumed * inputKiB / qMax(runBytes, (qint64)1));
 
-    currentDataLine = 0;
-    dataLines = 1;
-    delete keys;
-    qDebug() << "Done with logfile processing";
-    emit finishedFile(outfile.fileName());
-    running = false;
+        if (emitRows)
+        {
+            rows.append(time.toDouble());
+            for (int i = 0; i < row.size(); i++)
+            {
+                bool ok = false;
+                double value = row.at(i).isNull() ? nan : row.at(i).toDouble(&ok);
+                rows.append(ok ? value : nan);
+            }
+            if (lastUpdate.elapsed() >= 100)
+            {
+                emit rowsCompressed(rows, row.size() + 1);
+                rows.clear();
+            }
+        }
+        updateProgress();
+        if (aborted && abortable) return false;
+    }
+    if (!rows.isEmpty())
+    {
+        emit rowsCompressed(rows, row.size() + 1);
+    }
+    return true;
 }
 
 void LogCompressor::startCompression()
@@ -199,3 +382,32 @@ int LogCompressor::getDataLines()
 {
     return dataLines;
 }
+
+void LogCompressor::setMemoryBudget(qint64 bytes)
+{
+    memoryBudget = bytes;
+}
+
+/**
+ * Can be called from any thread. The runs written so far are removed, the
+ * output file is left incomplete.
+ */
+void LogCompressor::abort()
+{
+    aborted = true;
+}
+
+/**
+ * The signals are limited to ten per second, each one is an event in the
+ * thread of the receiver.
+ *
+ * @param force Emit the progress even if the last update was just now
+ */
+void LogCompressor::updateProgress(bool force)
+{
+    if (force || lastUpdate.elapsed() >= 100)
+    {
+        lastUpdate.restart();
+        emit progressChanged(currentDataLine, dataLines);
+    }
+}
@@ -2,32 +2,91 @@
 #define LOGCOMPRESSOR_H
 
 #include <QThread>
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+#include <QList>
+#include <QStringList>
+#include <QTime>
 
+class QFile;
+class QTemporaryFile;
+
+/**
+ * @brief Merges a raw log with one sample per line into a table
+ *
+ * The raw log has the tab-separated fields time, system id, value name and
+ * value. The output has one row per timestamp and one column per value name.
+ * The raw log is read once; the rows are collected column-major in memory
+ * and written to sorted runs on disk whenever the memory budget is
+ * exceeded. The runs are merged into the output at the end, so logs of any
+ * length are processed in bounded memory.
+ *
+ * The compression runs in its own thread and reports its progress and the
+ * merged rows with signals, it can be stopped with abort().
+ */
 class LogCompressor : public QThread
 {
     Q_OBJECT
 public:
     /** @brief Create the log compressor. It will only get active upon calling startCompression() */
     LogCompressor(QString logFileName, QString outFileName="", int uasid = 0);
+    ~LogCompressor();
     void startCompression();
     bool isFinished();
+    /** @brief Get the total amount of work, in units of getCurrentLine() */
     int getDataLines();
+    /** @brief Get the work done, one unit per kilobyte read from the raw log or the runs */
     int getCurrentLine();
+    /** @brief Set the memory the rows may use before they are written to disk, in bytes */
+    void setMemoryBudget(qint64 bytes);
+    /** @brief Stop the compression, no file is emitted with finishedFile() */
+    void abort();
 
 protected:
     void run();
+    /** @brief Compress the log, returns false if it failed or was aborted */
+    bool compress();
+    /** @brief Emit the progress if the last update is long enough ago */
+    void updateProgress(bool force = false);
+    /** @brief Write the rows collected in memory as sorted run to disk */
+    bool spill();
+    /** @brief Merge all runs into the output file */
+    bool merge(QFile& outfile, qint64 runBytes);
+
     QString logFileName;
     QString outFileName;
     bool running;
     int currentDataLine;
     int dataLines;
     int uasid;
+    qint64 memoryBudget;            ///< Estimated bytes the rows may use before they are spilled
+    volatile bool aborted;          ///< Set to stop the compression
+    QTime lastUpdate;               ///< Time of the last progress or rows signal
+
+    QHash<QByteArray, int> keyIndex;    ///< Column of each value name, in order of appearance
+    QList<QByteArray> keys;             ///< Value names by column
+    QHash<QByteArray, int> timeIndex;   ///< Row of each timestamp in the current run
+    QVector<QByteArray> times;          ///< Timestamps of the rows in the current run
+    QVector<QVector<QByteArray> > columns; ///< Values of the current run by column and row, null if not set
+    qint64 memoryUsed;                  ///< Estimated bytes used by the current run
+    QList<QTemporaryFile*> runs;        ///< Sorted runs written to disk, oldest first
 
 signals:
     /** @brief This signal is emitted once a logfile has been finished writing
      * @param fileName The name out the output (CSV) file
      */
     void finishedFile(QString fileName);
+    /** @brief The compression advanced, in units of getCurrentLine() */
+    void progressChanged(int current, int total);
+    /** @brief The columns of the output are known, the first is the timestamp */
+    void columnsFound(const QStringList& names);
+    /**
+     * @brief Rows have been merged into the output, only emitted if connected
+     * @param rows The values row by row, NaN where a row has no value
+     * @param columns Number of values per row, the timestamp included
+     */
+    void rowsCompressed(const QVector<double>& rows, int columns);
 };
 
 #endif // LOGCOMPRESSOR_H
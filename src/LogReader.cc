@@ -0,0 +1,170 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the reader for binary sample logs
+ *
+ */
+
+#include <cstring>
+#include <QFile>
+#include <QSet>
+#include <QtEndian>
+#include "LogReader.h"
+
+LogReader::LogReader() :
+        truncated(false)
+{
+}
+
+LogReader::~LogReader()
+{
+}
+
+void LogReader::clear()
+{
+    curves.clear();
+    curveIndex.clear();
+    names.clear();
+    truncated = false;
+}
+
+/**
+ * The file is memory mapped if possible, else read at once.
+ *
+ * @param fileName The binary log, usually the text log name with ".bin" appended
+ */
+bool LogReader::read(const QString& fileName)
+{
+    clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QByteArray buffer;
+    const uchar* data = file.map(0, file.size());
+    if (data == NULL)
+    {
+        buffer = file.readAll();
+        data = reinterpret_cast<const uchar*>(buffer.constData());
+    }
+    qint64 size = file.size();
+
+    // Magic "QGCLOG" followed by the version as quint16
+    const int headerLength = 8;
+    if (size < headerLength || memcmp(data, "QGCLOG", 6) != 0 || qFromLittleEndian<quint16>(data + 6) != VERSION)
+    {
+        return false;
+    }
+    parse(data + headerLength, size - headerLength);
+    return true;
+}
+
+void LogReader::parse(const uchar* data, qint64 size)
+{
+    const int nameHeader = 1 + 4 + 4;
+    const int sampleLength = 1 + 8 + 4 + 4 + 8;
+    qint64 position = 0;
+    while (position < size)
+    {
+        const uchar* record = data + position;
+        qint64 available = size - position;
+        if (record[0] == 'N' && available >= nameHeader)
+        {
+            int channel = qFromLittleEndian<qint32>(record + 1);
+            int length = qFromLittleEndian<qint32>(record + 5);
+            if (length < 0 || available < nameHeader + length) break;
+            names.insert(channel, QString::fromLatin1(reinterpret_cast<const char*>(record + nameHeader), length));
+            position += nameHeader + length;
+        }
+        else if (record[0] == 'S' && available >= sampleLength)
+        {
+            quint64 usec = qFromLittleEndian<quint64>(record + 1);
+            int uasId = qFromLittleEndian<qint32>(record + 9);
+            int channel = qFromLittleEndian<qint32>(record + 13);
+            quint64 bits = qFromLittleEndian<quint64>(record + 17);
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+
+            int index = getCurve(uasId, channel);
+            curves[index].times.append(usec);
+            curves[index].values.append(value);
+            position += sampleLength;
+        }
+        else
+        {
+            break;
+        }
+    }
+    truncated = (position < size);
+}
+
+int LogReader::getCurve(int uasId, int channel)
+{
+    quint64 key = (static_cast<quint64>(static_cast<quint32>(uasId)) << 32) | static_cast<quint32>(channel);
+    int index = curveIndex.value(key, -1);
+    if (index < 0)
+    {
+        index = curves.size();
+        Curve curve;
+        curve.uasId = uasId;
+        curve.channel = channel;
+        curves.append(curve);
+        curveIndex.insert(key, index);
+    }
+    return index;
+}
+
+QStringList LogReader::getCurveNames() const
+{
+    QSet<int> systems;
+    foreach (const Curve& curve, curves)
+    {
+        systems.insert(curve.uasId);
+    }
+
+    QStringList result;
+    foreach (const Curve& curve, curves)
+    {
+        QString name = names.value(curve.channel, QString("channel %1").arg(curve.channel));
+        if (systems.size() > 1) name += QString(" (%1)").arg(curve.uasId);
+        result.append(name);
+    }
+    return result;
+}
+
+const QVector<double>& LogReader::getTimes(int curve) const
+{
+    return curves.at(curve).times;
+}
+
+const QVector<double>& LogReader::getValues(int curve) const
+{
+    return curves.at(curve).values;
+}
+
+bool LogReader::isTruncated() const
+{
+    return truncated;
+}
@@ -0,0 +1,88 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the reader for binary sample logs
+ *
+ */
+
+#ifndef LOGREADER_H
+#define LOGREADER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+/**
+ * @brief Reads the binary copy written by LogWriter
+ *
+ * The samples are sorted into one curve per system and channel, with the
+ * times in microseconds and the values at full precision. The format is
+ * described in LogWriter. A log cut short, e.g. because the application
+ * ended while writing, is read up to its last complete record.
+ **/
+class LogReader
+{
+public:
+    LogReader();
+    virtual ~LogReader();
+
+    /** @brief Read a binary log, returns false if the file can not be read or is no binary log */
+    virtual bool read(const QString& fileName);
+    /** @brief Get the names of the curves, suffixed with the system id if the log has several systems */
+    QStringList getCurveNames() const;
+    /** @brief Get the timestamps of a curve in microseconds */
+    const QVector<double>& getTimes(int curve) const;
+    /** @brief Get the values of a curve */
+    const QVector<double>& getValues(int curve) const;
+    /** @brief Check if the log ended with an incomplete record */
+    bool isTruncated() const;
+
+    static const quint16 VERSION = 1; ///< Format version written by LogWriter
+
+protected:
+    /** @brief The samples of one channel of one system */
+    struct Curve
+    {
+        int uasId;
+        int channel;
+        QVector<double> times;
+        QVector<double> values;
+    };
+
+    /** @brief Parse the records following the header */
+    void parse(const uchar* data, qint64 size);
+    /** @brief Get the index of the curve of a channel, the curve is added if it does not exist yet */
+    int getCurve(int uasId, int channel);
+    /** @brief Clear the curves before reading a file */
+    void clear();
+
+    QVector<Curve> curves;
+    QHash<quint64, int> curveIndex; ///< Index into curves by system id and channel
+    QHash<int, QString> names;      ///< Channel names as recorded in the log
+    bool truncated;
+};
+
+#endif // LOGREADER_H
@@ -0,0 +1,225 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the buffered writer for raw sample logs
+ *
+ */
+
+#include "LogWriter.h"
+#include "UASChannelRegistry.h"
+
+#include <QDebug>
+
+LogWriter::LogWriter(const QString& fileName, QObject* parent) : QThread(parent),
+textFile(fileName),
+binaryFile(fileName + ".bin"),
+binaryEnabled(false),
+buffer(CAPACITY),
+head(0),
+tail(0),
+dropped(0),
+stopping(false)
+{
+}
+
+LogWriter::~LogWriter()
+{
+    stop();
+}
+
+void LogWriter::setBinarySidecar(bool enabled)
+{
+    binaryEnabled = enabled;
+}
+
+QString LogWriter::getFileName() const
+{
+    return textFile.fileName();
+}
+
+QString LogWriter::getBinaryFileName() const
+{
+    return binaryFile.fileName();
+}
+
+int LogWriter::getDropped()
+{
+    return dropped.fetchAndAddRelaxed(0);
+}
+
+bool LogWriter::open()
+{
+    if (!textFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        return false;
+    }
+    if (binaryEnabled)
+    {
+        if (!binaryFile.open(QIODevice::WriteOnly))
+        {
+            textFile.close();
+            return false;
+        }
+        QDataStream out(&binaryFile);
+        out.setByteOrder(QDataStream::LittleEndian);
+        out.writeRawData("QGCLOG", 6);
+        out << (quint16)1;
+    }
+    return true;
+}
+
+/**
+ * Only the producer writes the head. The sample is stored before the new
+ * head is published with release semantics, the consumer reads the head
+ * with acquire semantics and so sees the complete sample.
+ */
+void LogWriter::append(quint64 usec, int uasId, int channel, double value)
+{
+    if (channel < 0) return;
+    int current = head.fetchAndAddRelaxed(0);
+    int next = (current + 1) & (CAPACITY - 1);
+    if (next == tail.fetchAndAddAcquire(0))
+    {
+        // The writer is behind by a full buffer, drop instead of blocking the caller
+        if (dropped.fetchAndAddRelaxed(1) == 0)
+        {
+            qDebug() << "LogWriter: buffer full, dropping samples of" << textFile.fileName();
+        }
+        return;
+    }
+    Sample& sample = buffer[current];
+    sample.usec = usec;
+    sample.uasId = uasId;
+    sample.channel = channel;
+    sample.value = value;
+    head.fetchAndStoreRelease(next);
+}
+
+void LogWriter::stop()
+{
+    stopping = true;
+    wait();
+    if (textFile.isOpen())
+    {
+        // Catch samples queued after the thread ended or if it was never started
+        drain();
+        textFile.close();
+    }
+    if (binaryFile.isOpen())
+    {
+        binaryFile.close();
+    }
+    if (getDropped() > 0)
+    {
+        qDebug() << "LogWriter: dropped" << getDropped() << "samples of" << textFile.fileName();
+    }
+}
+
+void LogWriter::run()
+{
+    while (!stopping)
+    {
+        msleep(FLUSH_INTERVAL);
+        drain();
+    }
+}
+
+/**
+ * All samples up to the current head are formatted into one batch per
+ * file, which is written with a single call.
+ */
+void LogWriter::drain()
+{
+    int end = head.fetchAndAddAcquire(0);
+    int current = tail.fetchAndAddRelaxed(0);
+    if (current == end) return;
+
+    textBatch.clear();
+    binaryBatch.clear();
+    QDataStream* binary = NULL;
+    if (binaryFile.isOpen())
+    {
+        binary = new QDataStream(&binaryBatch, QIODevice::WriteOnly);
+        binary->setByteOrder(QDataStream::LittleEndian);
+        binary->setFloatingPointPrecision(QDataStream::DoublePrecision);
+    }
+
+    while (current != end)
+    {
+        const Sample& sample = buffer[current];
+        // Same formatting as QString::number() for the values
+        textBatch.append(QByteArray::number(sample.usec));
+        textBatch.append('\t');
+        textBatch.append(QByteArray::number(sample.uasId));
+        textBatch.append('\t');
+        textBatch.append(channelName(sample.channel, binary));
+        textBatch.append('\t');
+        textBatch.append(QByteArray::number(sample.value, 'g', 6));
+        textBatch.append('\n');
+        if (binary)
+        {
+            binary->writeRawData("S", 1);
+            *binary << sample.usec << (qint32)sample.uasId << (qint32)sample.channel << sample.value;
+        }
+        current = (current + 1) & (CAPACITY - 1);
+    }
+    // Hand the slots back to the producer
+    tail.fetchAndStoreRelease(current);
+
+    textFile.write(textBatch);
+    textFile.flush();
+    if (binary)
+    {
+        delete binary;
+        binaryFile.write(binaryBatch);
+        binaryFile.flush();
+    }
+}
+
+/**
+ * @param channel The channel, see UASChannelRegistry
+ * @param binary The stream of the binary copy, NULL if disabled
+ * @return The Latin-1 name of the channel
+ */
+const QByteArray& LogWriter::channelName(int channel, QDataStream* binary)
+{
+    if (channel >= names.size())
+    {
+        names.resize(channel + 1);
+    }
+    QByteArray& name = names[channel];
+    if (name.isNull())
+    {
+        name = UASChannelRegistry::instance()->getName(channel).toLatin1();
+        if (name.isNull()) name = QByteArray("");
+        if (binary)
+        {
+            binary->writeRawData("N", 1);
+            *binary << (qint32)channel << (qint32)name.size();
+            binary->writeRawData(name.constData(), name.size());
+        }
+    }
+    return name;
+}
@@ -0,0 +1,127 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the buffered writer for raw sample logs
+ *
+ */
+
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Writes the samples of a raw log in its own thread
+ *
+ * The samples are appended to a lock-free ring buffer with a single
+ * producer, the thread calling append(), and a single consumer, the
+ * writer thread. The writer drains the buffer periodically, formats all
+ * pending samples at once and writes them with one large write per drain,
+ * so the producer never waits for the disk.
+ *
+ * The text log has the tab-separated fields time, system id, value name
+ * and value, as expected by LogCompressor. Optionally a binary copy is
+ * written next to it, which keeps the values at full precision and can be
+ * reloaded without parsing text with LogReader, e.g. by the data plot.
+ *
+ * Binary format, little endian: the magic "QGCLOG", a quint16 version and
+ * a sequence of records. A record starts with one character, 'N' for the
+ * name of a channel (qint32 channel, qint32 length, Latin-1 bytes) or 'S'
+ * for a sample (quint64 time, qint32 system, qint32 channel, double value).
+ * A channel is named before its first sample.
+ **/
+class LogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    /** @brief Create the writer for a log file, it is created with open() */
+    LogWriter(const QString& fileName, QObject* parent = 0);
+    ~LogWriter();
+
+    /** @brief Also write the binary copy, must be set before open() */
+    void setBinarySidecar(bool enabled);
+    /** @brief Create the log files, returns false if one can not be written */
+    bool open();
+    /** @brief Get the name of the binary copy of the log */
+    QString getBinaryFileName() const;
+    /** @brief Get the name of the text log */
+    QString getFileName() const;
+    /**
+     * @brief Queue one sample, never blocks
+     *
+     * Must only be called from one thread at a time. The sample is dropped
+     * if the writer falls behind by more than the buffer size.
+     *
+     * @param usec The timestamp of the sample
+     * @param uasId The system the value belongs to
+     * @param channel The channel of the value, see UASChannelRegistry
+     * @param value The value
+     */
+    void append(quint64 usec, int uasId, int channel, double value);
+    /** @brief Write all queued samples and stop the thread, returns after the files are closed */
+    void stop();
+    /** @brief Get the number of samples dropped because the buffer was full */
+    int getDropped();
+
+    static const int CAPACITY = 131072;     ///< Samples the buffer holds, a power of two
+    static const int FLUSH_INTERVAL = 100;  ///< Time in ms between two drains of the buffer
+
+protected:
+    void run();
+    /** @brief Write all samples queued so far */
+    void drain();
+    /** @brief Get the name of a channel, cached and written to the binary copy on the first lookup */
+    const QByteArray& channelName(int channel, QDataStream* binary);
+
+    /** @brief One sample as queued by the producer */
+    struct Sample
+    {
+        quint64 usec;
+        int uasId;
+        int channel;
+        double value;
+    };
+
+    QFile textFile;               ///< The text log
+    QFile binaryFile;             ///< The binary copy, only open if enabled
+    bool binaryEnabled;
+    QVector<Sample> buffer;       ///< Ring buffer, one slot stays empty to tell full from empty
+    QAtomicInt head;              ///< Next slot the producer writes
+    QAtomicInt tail;              ///< Next slot the consumer reads
+    QAtomicInt dropped;           ///< Samples lost because the buffer was full
+    volatile bool stopping;       ///< Set to drain the buffer a last time and finish
+    QVector<QByteArray> names;    ///< Latin-1 names by channel, null if not yet looked up
+    QByteArray textBatch;         ///< Formatted lines of one drain, reused
+    QByteArray binaryBatch;       ///< Binary records of one drain, reused
+};
+
+#endif // LOGWRITER_H
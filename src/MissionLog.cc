@@ -23,37 +23,42 @@ This file is part of the PIXHAWK project
  
 /**
  * @file
- *   @brief Brief Description
+ *   @brief Implementation of the columnar telemetry recorder
  *
  *   @author Lorenz Meier <mavteam@student.ethz.ch>
  *
  */
 
-#include <QFile>
-#include <QFlags>
-#include <QThread>
-#include <QSplashScreen>
-#include <QPixmap>
-#include <QDesktopWidget>
-#include <QPainter>
-#include <QStyleFactory>
-#include <QAction>
+#include <cstring>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QtEndian>
 
 #include <MissionLog.h>
-#include <MG.h>
+#include <UASChannelRegistry.h>
+#include "configuration.h"
 
 #include <QDebug>
 
+/* A window is written early once a vehicle has this many values in it,
+ * values beyond MAX_PENDING are dropped until the writer catches up */
+static const int FLUSH_THRESHOLD = 64 * 1024;
+static const int MAX_PENDING = 8 * FLUSH_THRESHOLD;
+static const char LOG_MAGIC[] = "QGCMLOG";
 
 /**
  * @brief Constructor for the mission log
  *
  **/
-
-MissionLog::MissionLog(QObject* parent) : QObject(parent)
+MissionLog::MissionLog(QObject* parent) : QThread(parent),
+recorders(),
+notified(0),
+dropped(0),
+stopping(false)
 {
-    logLines = new QMap<QString, LogLine*>();
-    logFiles = new QMap<QString, QFile*>();
 }
 
 /**
@@ -62,25 +67,316 @@ MissionLog::MissionLog(QObject* parent) : QObject(parent)
  **/
 MissionLog::~MissionLog()
 {
-    delete logFiles;
-    delete logLines;
+    stopAll();
+    wakeMutex.lock();
+    stopping = true;
+    wake.wakeAll();
+    wakeMutex.unlock();
+    wait();
 }
 
-void MissionLog::startLog(UASInterface* uas, QString format)
+bool MissionLog::isLogHeader(const char* header)
 {
-    QString separator;
+    return memcmp(header, LOG_MAGIC, sizeof(LOG_MAGIC) - 1) == 0;
+}
 
-    if (format.contains(",")) separator = ",";
-    if (format.contains(";")) separator = ";";
-    if (format.contains("\t")) separator = "\t";
+bool MissionLog::isLogging(UASInterface* uas)
+{
+    if (!uas) return false;
+    QReadLocker locker(&recordersLock);
+    return recorders.contains(uas->getUASID());
+}
 
-    QStringList fields = format.split(separator);
+QString MissionLog::getFileName(UASInterface* uas)
+{
+    if (!uas) return QString();
+    QReadLocker locker(&recordersLock);
+    Recorder* recorder = recorders.value(uas->getUASID(), NULL);
+    return recorder ? recorder->file.fileName() : QString();
 }
 
-void MissionLog::stopLog(UASInterface* uas, QString format)
+int MissionLog::getDropped()
 {
-    // TODO Check if file has to be closed explicitely
-    logFiles->remove(format);
+    return dropped.fetchAndAddRelaxed(0);
 }
 
+/**
+ * The file header and the vehicle record are written right away, the
+ * writer thread is started with the first recorded vehicle.
+ */
+bool MissionLog::startLog(UASInterface* uas, QString fileName)
+{
+    if (!uas) return false;
+    if (isLogging(uas)) return true;
+
+    if (fileName.isEmpty())
+    {
+        fileName = QCoreApplication::applicationDirPath() + QString("/mission-%1-%2.mlog")
+                   .arg(uas->getUASID())
+                   .arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+    }
+
+    Recorder* recorder = new Recorder();
+    recorder->uas = uas;
+    recorder->uasId = uas->getUASID();
+    recorder->samples = 0;
+    recorder->firstTime = 0;
+    recorder->lastTime = 0;
+    recorder->file.setFileName(fileName);
+    if (!recorder->file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "Could not open mission log" << fileName << recorder->file.errorString();
+        delete recorder;
+        return false;
+    }
+
+    char header[FILE_HEADER_LENGTH];
+    memcpy(header, LOG_MAGIC, sizeof(LOG_MAGIC) - 1);
+    header[FILE_HEADER_LENGTH - 1] = FORMAT_VERSION;
+    QByteArray& out = recorder->out;
+    out.append(header, FILE_HEADER_LENGTH);
+    QByteArray name = uas->getUASName().toLatin1();
+    appendHeader(out, RECORD_VEHICLE, sizeof(quint32) + name.size());
+    uchar id[sizeof(quint32)];
+    qToLittleEndian<quint32>(recorder->uasId, id);
+    out.append(reinterpret_cast<const char*>(id), sizeof(id));
+    out.append(name);
+    recorder->file.write(out);
+
+    recordersLock.lockForWrite();
+    recorders.insert(recorder->uasId, recorder);
+    recordersLock.unlock();
+
+    // The frames are appended in the thread of the vehicle, not queued to this one
+    connect(uas, SIGNAL(valuesChanged(UASValueFrame)), this, SLOT(addFrame(UASValueFrame)), Qt::DirectConnection);
+    if (!isRunning())
+    {
+        stopping = false;
+        start(QThread::LowPriority);
+    }
+    return true;
+}
 
+/**
+ * Writes the values received so far and closes the file of the vehicle.
+ */
+void MissionLog::stopLog(UASInterface* uas)
+{
+    if (!uas) return;
+    disconnect(uas, SIGNAL(valuesChanged(UASValueFrame)), this, SLOT(addFrame(UASValueFrame)));
+
+    recordersLock.lockForWrite();
+    Recorder* recorder = recorders.take(uas->getUASID());
+    recordersLock.unlock();
+    if (!recorder) return;
+
+    // Waits for a running write, the writer does not see the vehicle afterwards
+    QMutexLocker locker(&writeMutex);
+    flush(recorder);
+    recorder->file.close();
+    delete recorder;
+}
+
+void MissionLog::stopAll()
+{
+    recordersLock.lockForWrite();
+    QList<Recorder*> stopped = recorders.values();
+    recorders.clear();
+    recordersLock.unlock();
+
+    QMutexLocker locker(&writeMutex);
+    foreach (Recorder* recorder, stopped)
+    {
+        if (recorder->uas)
+        {
+            disconnect(recorder->uas, SIGNAL(valuesChanged(UASValueFrame)), this, SLOT(addFrame(UASValueFrame)));
+        }
+        flush(recorder);
+        recorder->file.close();
+        delete recorder;
+    }
+}
+
+/**
+ * Executed in the thread of the vehicle. The values are only appended to
+ * the blocks of their channels in memory, the disk is never accessed.
+ *
+ * @param frame The channels and values of one message
+ */
+void MissionLog::addFrame(const UASValueFrame& frame)
+{
+    QReadLocker locker(&recordersLock);
+    Recorder* recorder = recorders.value(frame.uasId, NULL);
+    if (!recorder) return;
+
+    recorder->mutex.lock();
+    if (recorder->samples + frame.count > MAX_PENDING)
+    {
+        recorder->mutex.unlock();
+        // The disk does not keep up, drop instead of growing without bounds
+        if (dropped.fetchAndAddRelaxed(frame.count) == 0)
+        {
+            qDebug() << "Mission log" << recorder->file.fileName() << "is behind, dropping values";
+        }
+        return;
+    }
+    if (recorder->samples == 0 || frame.msec < recorder->firstTime)
+    {
+        recorder->firstTime = frame.msec;
+    }
+    if (recorder->samples == 0 || frame.msec > recorder->lastTime)
+    {
+        recorder->lastTime = frame.msec;
+    }
+    for (int i = 0; i < frame.count; i++)
+    {
+        int channel = frame.channels[i];
+        int block = recorder->blockOf.value(channel, -1);
+        if (block < 0)
+        {
+            block = recorder->pending.size();
+            recorder->pending.resize(block + 1);
+            recorder->pending[block].channel = channel;
+            recorder->blockOf.insert(channel, block);
+        }
+        recorder->pending[block].times.append(frame.msec);
+        recorder->pending[block].values.append(frame.values[i]);
+    }
+    recorder->samples += frame.count;
+    bool full = recorder->samples >= FLUSH_THRESHOLD;
+    recorder->mutex.unlock();
+
+    // Request an early write once per filled window. The writer checks the
+    // request under the mutex before waiting, so the wake up is not lost
+    if (full && notified.testAndSetOrdered(0, 1))
+    {
+        wakeMutex.lock();
+        wake.wakeOne();
+        wakeMutex.unlock();
+    }
+}
+
+void MissionLog::run()
+{
+    while (!stopping)
+    {
+        wakeMutex.lock();
+        if (!stopping && notified.fetchAndAddOrdered(0) == 0)
+        {
+            wake.wait(&wakeMutex, MISSIONLOG_WINDOW);
+        }
+        wakeMutex.unlock();
+        flushAll();
+    }
+}
+
+/**
+ * Executed in the writer thread. The recorders are only locked to copy
+ * the list, so vehicles keep adding frames while the disk is busy. A
+ * vehicle stopped meanwhile is deleted once the write mutex is released.
+ */
+void MissionLog::flushAll()
+{
+    notified.fetchAndStoreOrdered(0);
+    QMutexLocker locker(&writeMutex);
+    recordersLock.lockForRead();
+    QList<Recorder*> recording = recorders.values();
+    recordersLock.unlock();
+    foreach (Recorder* recorder, recording)
+    {
+        flush(recorder);
+    }
+}
+
+/**
+ * The blocks are swapped, so the vehicle continues to fill the next
+ * window while this one is encoded and written. The names of channels
+ * appearing for the first time are written before the window.
+ *
+ * @param recorder The vehicle to write
+ */
+void MissionLog::flush(Recorder* recorder)
+{
+    recorder->mutex.lock();
+    if (recorder->samples == 0)
+    {
+        recorder->mutex.unlock();
+        return;
+    }
+    qSwap(recorder->pending, recorder->writing);
+    recorder->blockOf.clear();
+    quint64 firstTime = recorder->firstTime;
+    quint64 lastTime = recorder->lastTime;
+    recorder->samples = 0;
+    recorder->mutex.unlock();
+
+    QByteArray& out = recorder->out;
+    out.resize(0);
+    const QVector<Block>& blocks = recorder->writing;
+
+    // Name new channels and size the window record
+    quint32 length = 2 * sizeof(quint64) + sizeof(quint32);
+    for (int i = 0; i < blocks.size(); i++)
+    {
+        const Block& block = blocks.at(i);
+        if (!recorder->named.contains(block.channel))
+        {
+            QByteArray name = UASChannelRegistry::instance()->getName(block.channel).toLatin1();
+            appendHeader(out, RECORD_CHANNEL, sizeof(quint32) + name.size());
+            uchar channel[sizeof(quint32)];
+            qToLittleEndian<quint32>(block.channel, channel);
+            out.append(reinterpret_cast<const char*>(channel), sizeof(channel));
+            out.append(name);
+            recorder->named.insert(block.channel);
+        }
+        length += 2 * sizeof(quint32) + block.times.size() * (sizeof(quint64) + sizeof(double));
+    }
+
+    // Encode the window, per block first all times and then all values
+    appendHeader(out, RECORD_WINDOW, length);
+    int start = out.size();
+    out.resize(start + length);
+    uchar* data = reinterpret_cast<uchar*>(out.data()) + start;
+    qToLittleEndian<quint64>(firstTime, data);
+    qToLittleEndian<quint64>(lastTime, data + sizeof(quint64));
+    qToLittleEndian<quint32>(blocks.size(), data + 2 * sizeof(quint64));
+    data += 2 * sizeof(quint64) + sizeof(quint32);
+    for (int i = 0; i < blocks.size(); i++)
+    {
+        const Block& block = blocks.at(i);
+        int count = block.times.size();
+        qToLittleEndian<quint32>(block.channel, data);
+        qToLittleEndian<quint32>(count, data + sizeof(quint32));
+        data += 2 * sizeof(quint32);
+        const quint64* times = block.times.constData();
+        for (int j = 0; j < count; j++)
+        {
+            qToLittleEndian<quint64>(times[j], data);
+            data += sizeof(quint64);
+        }
+        const double* values = block.values.constData();
+        for (int j = 0; j < count; j++)
+        {
+            quint64 bits;
+            memcpy(&bits, &values[j], sizeof(bits));
+            qToLittleEndian<quint64>(bits, data);
+            data += sizeof(quint64);
+        }
+    }
+    recorder->writing.clear();
+
+    qint64 written = recorder->file.write(out);
+    recorder->file.flush();
+    if (written != out.size())
+    {
+        qDebug() << "Mission log" << recorder->file.fileName() << "truncated:" << recorder->file.errorString();
+    }
+}
+
+void MissionLog::appendHeader(QByteArray& out, RecordType type, quint32 length)
+{
+    uchar header[RECORD_HEADER_LENGTH];
+    header[0] = static_cast<uchar>(type);
+    qToLittleEndian<quint32>(length, header + 1);
+    out.append(reinterpret_cast<const char*>(header), RECORD_HEADER_LENGTH);
+}
@@ -23,7 +23,7 @@ This file is part of the PIXHAWK project
  
 /**
  * @file
- *   @brief Brief Description
+ *   @brief Definition of the columnar telemetry recorder
  *
  *   @author Lorenz Meier <mavteam@student.ethz.ch>
  *
@@ -32,75 +32,128 @@ This file is part of the PIXHAWK project
 #ifndef _MISSIONLOG_H_
 #define _MISSIONLOG_H_
 
+#include <QThread>
 #include <QString>
 #include <QFile>
-#include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QByteArray>
+#include <QPointer>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QWaitCondition>
+#include <QAtomicInt>
 #include <UASInterface.h>
 
 /**
- * @brief Log the mission executed by this groundstation
- * 
- * Displays all events in a console window and writes (if enabled) all events to a logfile
+ * @brief Records the telemetry of the vehicles, one file per vehicle
  *
+ * The recorder subscribes once to the value frames of each recorded
+ * vehicle. The frames are delivered directly from the thread of the
+ * vehicle and appended to the window of the vehicle in memory, one block
+ * per channel. The writer thread closes the windows every
+ * MISSIONLOG_WINDOW milliseconds, or earlier when a window gets large,
+ * and writes each as one record with a single large write. Disk access
+ * stays sequential per file and a value is on disk at most one window
+ * after it was received. MissionLogReader reads the files back.
+ *
+ * All values are little endian. The file starts with an 8 byte header,
+ * the 7 byte magic "QGCMLOG" followed by the format version as one byte.
+ * Records follow, each with a 5 byte header:
+ *
+ * - quint8 type, see RecordType
+ * - quint32 payload length
  **/
-class MissionLog : public QObject {
+class MissionLog : public QThread {
     Q_OBJECT
 
 public:
+    enum RecordType {
+        RECORD_VEHICLE = 0, ///< Payload is the qint32 system id and the Latin-1 name of the vehicle
+        RECORD_CHANNEL = 1, ///< Payload is the qint32 channel and the Latin-1 value name, precedes the first block of the channel
+        RECORD_WINDOW = 2   ///< Payload is the quint64 first and last time in ms, the quint32 block count and the blocks
+    };
+    enum {
+        FILE_HEADER_LENGTH = 8,   ///< Length of magic and version
+        RECORD_HEADER_LENGTH = 5, ///< Length of type and length of a record
+        FORMAT_VERSION = 1
+    };
+
     MissionLog(QObject* parent = NULL);
     ~MissionLog();
 
+    /** @brief Check if the telemetry of a vehicle is being recorded */
+    bool isLogging(UASInterface* uas);
+    /** @brief Get the name of the file a vehicle is recorded to, empty if it is not recorded */
+    QString getFileName(UASInterface* uas);
+    /** @brief Get the number of values dropped because the writer fell behind */
+    int getDropped();
+
+    /** @brief Check the magic of the file header */
+    static bool isLogHeader(const char* header);
+
 public slots:
-    void startLog(UASInterface* uas, QString format);
-    void stopLog(UASInterface* uas, QString format);
+    /**
+     * @brief Start recording the telemetry of a vehicle
+     *
+     * @param uas The vehicle to record
+     * @param fileName The file to record to, a new file in the application directory if empty
+     * @return True if the file could be created or the vehicle is already recorded
+     */
+    bool startLog(UASInterface* uas, QString fileName = "");
+    /** @brief Stop recording a vehicle, returns after its file is complete */
+    void stopLog(UASInterface* uas);
+    /** @brief Stop recording all vehicles */
+    void stopAll();
+    /** @brief Append the values of a frame to the window of its vehicle, called from the thread of the vehicle */
+    void addFrame(const UASValueFrame& frame);
 
 protected:
-    /**
-         * @brief This nested class is just a data container for a log line
-         */
-    class LogFile
+    /** @brief The values of one channel in the current window */
+    struct Block
     {
-    public:
-        void setField(QString id, double value)
-        {
-            //fields->value(id.trimmed()) = value;
-            fieldsDone++;
-            if (fieldsDone == fields->size()) writeLine();
-        }
-
-            protected:
-        QMap<QString, double>* fields;
-        int fieldsDone;
-        QFile* file;
-
-        LogFile(QFile* file, QString format)
-        {
-            fields = new QMap<QString, double>();
-            fieldsDone = 0;
-            file->open(QIODevice::WriteOnly | QIODevice::Text);
-        }
-
-        void addField(QString id)
-        {
-            fields->insert(id, 0.0f);
-        }
+        int channel;
+        QVector<quint64> times;
+        QVector<double> values;
+    };
 
-        void writeLine()
-        {
-            QString line = "";
-            // Iterate through the fields
+    /** @brief The file and the current window of one vehicle */
+    struct Recorder
+    {
+        QPointer<UASInterface> uas;
+        int uasId;
+        QFile file;              ///< Only written by the writer thread once recording
+        QMutex mutex;            ///< Protects the window
+        QHash<int, int> blockOf; ///< Block of each channel in the current window
+        QVector<Block> pending;  ///< Blocks of the current window
+        QVector<Block> writing;  ///< Blocks being written, swapped with pending
+        int samples;             ///< Values in the current window
+        quint64 firstTime;       ///< Time of the first value of the current window
+        quint64 lastTime;        ///< Time of the last value of the current window
+        QSet<int> named;         ///< Channels whose name has been written
+        QByteArray out;          ///< Encoded records of one window, reused
+    };
 
-            // Reset value to zero after write
-            line += "\n";
-            file->write(line.toAscii());
-            file->flush();
-        }
+    void run();
+    /** @brief Write the window of every vehicle */
+    void flushAll();
+    /** @brief Close the window of a vehicle and write it, with the write mutex held */
+    void flush(Recorder* recorder);
+    /** @brief Append a record header to the output of a recorder */
+    static void appendHeader(QByteArray& out, RecordType type, quint32 length);
 
-    };
-    QMap<QString, LogFile*>* logFiles;
+    QHash<int, Recorder*> recorders;  ///< Recorded vehicles by system id
+    QReadWriteLock recordersLock;     ///< Protects the recorders, never held during disk access
+    QMutex writeMutex;                ///< Held while writing, a stopped recorder is deleted after the write
+    QMutex wakeMutex;                 ///< Guards the wake up of the writer
+    QWaitCondition wake;              ///< Wakes the writer before the end of the window
+    QAtomicInt notified;              ///< 1 if an early write has been requested and not yet executed
+    QAtomicInt dropped;               ///< Values dropped because a window was full
+    volatile bool stopping;           ///< Set to end the writer thread
 
 private:
-
+    Q_DISABLE_COPY(MissionLog)
 };
 
 #endif // _MISSIONLOG_H_
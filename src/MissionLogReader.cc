@@ -0,0 +1,156 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the reader for mission logs
+ *
+ */
+
+#include <cstring>
+#include <QFile>
+#include <QtEndian>
+#include "MissionLogReader.h"
+#include "MissionLog.h"
+
+MissionLogReader::MissionLogReader() :
+        LogReader(),
+        uasId(0)
+{
+}
+
+/**
+ * The file is memory mapped if possible, else read at once.
+ *
+ * @param fileName The mission log, usually named mission-<system id>-<date>.mlog
+ */
+bool MissionLogReader::read(const QString& fileName)
+{
+    clear();
+    uasId = 0;
+    vehicleName.clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QByteArray buffer;
+    const uchar* data = file.map(0, file.size());
+    if (data == NULL)
+    {
+        buffer = file.readAll();
+        data = reinterpret_cast<const uchar*>(buffer.constData());
+    }
+    qint64 size = file.size();
+
+    if (size < MissionLog::FILE_HEADER_LENGTH
+        || !MissionLog::isLogHeader(reinterpret_cast<const char*>(data))
+        || data[MissionLog::FILE_HEADER_LENGTH - 1] != MissionLog::FORMAT_VERSION)
+    {
+        return false;
+    }
+    parseRecords(data + MissionLog::FILE_HEADER_LENGTH, size - MissionLog::FILE_HEADER_LENGTH);
+    return true;
+}
+
+QString MissionLogReader::getVehicleName() const
+{
+    return vehicleName;
+}
+
+void MissionLogReader::parseRecords(const uchar* data, qint64 size)
+{
+    const int headerLength = MissionLog::RECORD_HEADER_LENGTH;
+    qint64 position = 0;
+    while (size - position >= headerLength)
+    {
+        const uchar* record = data + position;
+        quint32 length = qFromLittleEndian<quint32>(record + 1);
+        if (static_cast<quint64>(size - position - headerLength) < length) break;
+        const uchar* payload = record + headerLength;
+
+        switch (record[0])
+        {
+        case MissionLog::RECORD_VEHICLE:
+            if (length < sizeof(quint32)) break;
+            uasId = qFromLittleEndian<qint32>(payload);
+            vehicleName = QString::fromLatin1(reinterpret_cast<const char*>(payload + sizeof(quint32)), length - sizeof(quint32));
+            break;
+        case MissionLog::RECORD_CHANNEL:
+            if (length < sizeof(quint32)) break;
+            names.insert(qFromLittleEndian<qint32>(payload),
+                         QString::fromLatin1(reinterpret_cast<const char*>(payload + sizeof(quint32)), length - sizeof(quint32)));
+            break;
+        case MissionLog::RECORD_WINDOW:
+            if (!parseWindow(payload, length))
+            {
+                truncated = true;
+                return;
+            }
+            break;
+        default:
+            // Written by a later version, the length allows to skip it
+            break;
+        }
+        position += headerLength + length;
+    }
+    truncated = (position < size);
+}
+
+/**
+ * A window starts with its first and last time and the number of blocks.
+ * Each block holds the channel, the number of values, all times and then
+ * all values.
+ *
+ * @param data The payload of the record
+ * @param length The length of the payload
+ */
+bool MissionLogReader::parseWindow(const uchar* data, quint32 length)
+{
+    const quint32 windowHeader = 2 * sizeof(quint64) + sizeof(quint32);
+    const quint32 blockHeader = 2 * sizeof(quint32);
+    if (length < windowHeader) return false;
+    quint32 blocks = qFromLittleEndian<quint32>(data + 2 * sizeof(quint64));
+    quint32 position = windowHeader;
+    for (quint32 i = 0; i < blocks; i++)
+    {
+        if (length - position < blockHeader) return false;
+        int channel = qFromLittleEndian<qint32>(data + position);
+        quint32 count = qFromLittleEndian<quint32>(data + position + sizeof(quint32));
+        position += blockHeader;
+        if ((length - position) / (2 * sizeof(quint64)) < count) return false;
+
+        Curve& curve = curves[getCurve(uasId, channel)];
+        const uchar* times = data + position;
+        const uchar* values = times + count * sizeof(quint64);
+        for (quint32 j = 0; j < count; j++)
+        {
+            curve.times.append(qFromLittleEndian<quint64>(times + j * sizeof(quint64)) * 1000.0);
+            quint64 bits = qFromLittleEndian<quint64>(values + j * sizeof(quint64));
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            curve.values.append(value);
+        }
+        position += count * 2 * sizeof(quint64);
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the reader for mission logs
+ *
+ */
+
+#ifndef MISSIONLOGREADER_H
+#define MISSIONLOGREADER_H
+
+#include "LogReader.h"
+
+/**
+ * @brief Reads the telemetry of one vehicle recorded by MissionLog
+ *
+ * The blocks of all windows are appended to one curve per channel, the
+ * times are converted from milliseconds to microseconds like those of
+ * LogReader. Records of unknown type are skipped, a file cut short is
+ * read up to its last complete record.
+ **/
+class MissionLogReader : public LogReader
+{
+public:
+    MissionLogReader();
+
+    /** @brief Read a mission log, returns false if the file can not be read or is no mission log */
+    bool read(const QString& fileName);
+    /** @brief Get the name of the recorded vehicle */
+    QString getVehicleName() const;
+
+protected:
+    /** @brief Parse the records following the header */
+    void parseRecords(const uchar* data, qint64 size);
+    /** @brief Append the blocks of one window record, returns false if the record is malformed */
+    bool parseWindow(const uchar* data, quint32 length);
+
+    int uasId;
+    QString vehicleName;
+};
+
+#endif // MISSIONLOGREADER_H
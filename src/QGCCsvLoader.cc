@@ -0,0 +1,535 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the parallel loader for CSV log files
+ *
+ */
+
+#include <QRunnable>
+#include <QThreadPool>
+#include <QMutexLocker>
+#include <QDebug>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include "QGCCsvLoader.h"
+
+/** @brief Size of the chunks the file is split into, in bytes */
+#define CSV_CHUNK_SIZE (8 * 1024 * 1024)
+
+/**
+ * @brief Processes one chunk of a QGCCsvLoader in the thread pool
+ */
+class QGCCsvLoaderTask : public QRunnable
+{
+public:
+    QGCCsvLoaderTask(QGCCsvLoader* loader, int index, bool parse) :
+            loader(loader),
+            index(index),
+            parse(parse)
+    {
+    }
+
+    void run()
+    {
+        if (!loader->aborted)
+        {
+            if (parse)
+            {
+                loader->parseChunk(index);
+            }
+            else
+            {
+                loader->countChunk(index);
+            }
+        }
+        loader->finishChunk(index);
+    }
+
+protected:
+    QGCCsvLoader* loader;
+    int index;
+    bool parse;
+};
+
+/**
+ * @param begin Start of the line
+ * @param end End of the data
+ * @param lineEnd Set to the end of the line, without line break
+ * @return Start of the next line
+ */
+static inline const char* nextLine(const char* begin, const char* end, const char** lineEnd)
+{
+    const char* newline = (const char*)memchr(begin, '\n', end - begin);
+    const char* next = newline ? newline + 1 : end;
+    const char* last = newline ? newline : end;
+    if (last > begin && last[-1] == '\r') last--;
+    *lineEnd = last;
+    return next;
+}
+
+/**
+ * Locale-free replacement for strtod() on a field which is not null
+ * terminated. Up to 19 significant digits are used, which is more than
+ * a double holds.
+ *
+ * @return The value of the field, NaN if it is empty or not a number
+ */
+static double parseNumber(const char* p, const char* end)
+{
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+                                    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    while (p < end && (*p == ' ' || *p == '"')) p++;
+    while (end > p && (end[-1] == ' ' || end[-1] == '"')) end--;
+    if (p == end) return nan;
+
+    bool negative = false;
+    if (*p == '-' || *p == '+')
+    {
+        negative = (*p == '-');
+        p++;
+    }
+
+    quint64 mantissa = 0;
+    int significant = 0;
+    int exponent = 0;
+    bool digits = false;
+    for (; p < end && *p >= '0' && *p <= '9'; p++)
+    {
+        digits = true;
+        if (significant < 19)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa > 0) significant++;
+        }
+        else
+        {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++)
+        {
+            digits = true;
+            if (significant < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa > 0) significant++;
+                exponent--;
+            }
+        }
+    }
+    if (!digits)
+    {
+        if (end - p == 3 && qstrnicmp(p, "inf", 3) == 0)
+        {
+            return negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+        }
+        return nan;
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            negativeExponent = (*p == '-');
+            p++;
+        }
+        if (p == end) return nan;
+        int e = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++)
+        {
+            if (e < 10000) e = e * 10 + (*p - '0');
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+    if (p != end) return nan;
+
+    double value = (double)mantissa;
+    if (exponent < 0)
+    {
+        value = (exponent >= -22) ? value / powers[-exponent] : value * pow(10.0, exponent);
+    }
+    else if (exponent > 0)
+    {
+        value = (exponent <= 22) ? value * powers[exponent] : value * pow(10.0, exponent);
+    }
+    return negative ? -value : value;
+}
+
+QGCCsvLoader::QGCCsvLoader(QObject* parent) :
+        QThread(parent),
+        data(NULL),
+        size(0),
+        dataStart(0),
+        totalRows(-1),
+        readyRows(0),
+        loadedBytes(0),
+        aborted(false)
+{
+}
+
+QGCCsvLoader::~QGCCsvLoader()
+{
+    abort();
+    wait();
+    close();
+}
+
+/**
+ * The separator is detected from the header: it is the sequence of
+ * separator characters between the first and the second column name.
+ *
+ * @param fileName The CSV or TSV file, the first line has to be the header
+ * @return true if the file could be opened and mapped
+ */
+bool QGCCsvLoader::open(const QString& fileName)
+{
+    abort();
+    wait();
+    close();
+    aborted = false;
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    size = file.size();
+
+    // First line is header
+    QString header = QString::fromLatin1(file.readLine()).trimmed();
+    dataStart = file.pos();
+
+    bool charRead = false;
+    separator = "";
+    QList<QChar> sepCandidates;
+    sepCandidates << '\t';
+    sepCandidates << ',';
+    sepCandidates << ';';
+    sepCandidates << ' ';
+    sepCandidates << '~';
+    sepCandidates << '|';
+
+    // Iterate until separator is found
+    // or full header is parsed
+    for (int i = 0; i < header.length(); i++)
+    {
+        if (sepCandidates.contains(header.at(i)))
+        {
+            // Separator found
+            if (charRead)
+            {
+                separator += header[i];
+            }
+        }
+        else
+        {
+            // Char found
+            charRead = true;
+            // If the separator is not empty, this char
+            // has been read after a separator, so detection
+            // is now complete
+            if (separator != "") break;
+        }
+    }
+    separatorBytes = separator.toLatin1();
+    columnNames = separator.isEmpty() ? QStringList(header) : header.split(separator, QString::SkipEmptyParts);
+    values.resize(columnNames.size());
+
+    // Map the whole file, fall back to reading it if the address
+    // space is too small, e.g. for large files on 32 bit systems
+    data = (const char*)file.map(0, size);
+    if (data == NULL)
+    {
+        qDebug() << "Could not map" << fileName << "- reading it instead";
+        file.seek(0);
+        buffer = file.readAll();
+        if (buffer.size() != size)
+        {
+            close();
+            return false;
+        }
+        data = buffer.constData();
+    }
+    return true;
+}
+
+QString QGCCsvLoader::getSeparator() const
+{
+    return separator;
+}
+
+QStringList QGCCsvLoader::getColumnNames() const
+{
+    return columnNames;
+}
+
+/**
+ * Returns immediately, the rows are announced with rowsLoaded() while
+ * the file is loaded.
+ *
+ * @param columns Indices of the columns to load, the other columns are skipped
+ */
+void QGCCsvLoader::load(const QList<int>& columns)
+{
+    if (data == NULL || isRunning()) return;
+    loadColumns.clear();
+    foreach (int column, columns)
+    {
+        if (column >= 0 && column < columnNames.size() && !loadColumns.contains(column))
+        {
+            loadColumns.append(column);
+        }
+    }
+    start();
+}
+
+void QGCCsvLoader::abort()
+{
+    aborted = true;
+}
+
+int QGCCsvLoader::getRows()
+{
+    QMutexLocker locker(&mutex);
+    return readyRows;
+}
+
+int QGCCsvLoader::getTotalRows()
+{
+    QMutexLocker locker(&mutex);
+    return totalRows;
+}
+
+/**
+ * The values of the first getRows() rows are final, the rest of the array
+ * may still be written by the loader.
+ *
+ * @param column Index of the column in getColumnNames()
+ */
+const double* QGCCsvLoader::getColumn(int column) const
+{
+    if (column < 0 || column >= values.size() || values.at(column).isEmpty()) return NULL;
+    return values.at(column).constData();
+}
+
+int QGCCsvLoader::getSize() const
+{
+    return qMax((qint64)1, size / 1024);
+}
+
+int QGCCsvLoader::getLoaded()
+{
+    QMutexLocker locker(&mutex);
+    return loadedBytes / 1024;
+}
+
+void QGCCsvLoader::run()
+{
+    // Split the rows into line-aligned chunks
+    chunks.clear();
+    qint64 begin = dataStart;
+    while (begin < size)
+    {
+        qint64 end = qMin(begin + CSV_CHUNK_SIZE, size);
+        if (end < size)
+        {
+            const char* newline = (const char*)memchr(data + end, '\n', size - end);
+            end = newline ? (newline - data) + 1 : size;
+        }
+        Chunk chunk;
+        chunk.begin = begin;
+        chunk.end = end;
+        chunk.firstRow = 0;
+        chunk.rows = 0;
+        chunk.done = false;
+        chunks.append(chunk);
+        begin = end;
+    }
+
+    // Count the rows, then the columns can be allocated at once
+    runPhase(false);
+    if (aborted) return;
+    int rows = 0;
+    for (int i = 0; i < chunks.size(); i++)
+    {
+        chunks[i].firstRow = rows;
+        rows += chunks.at(i).rows;
+    }
+    foreach (int column, loadColumns)
+    {
+        values[column] = QVector<double>(rows);
+    }
+    mutex.lock();
+    totalRows = rows;
+    mutex.unlock();
+
+    runPhase(true);
+}
+
+/**
+ * All tasks are queued at once, the chunks are then awaited in file order.
+ * After the parse phase each chunk is announced with rowsLoaded() as soon
+ * as it and all chunks before it are done.
+ *
+ * @param parse false to count the rows, true to parse them
+ */
+void QGCCsvLoader::runPhase(bool parse)
+{
+    for (int i = 0; i < chunks.size(); i++)
+    {
+        chunks[i].done = false;
+        QThreadPool::globalInstance()->start(new QGCCsvLoaderTask(this, i, parse));
+    }
+    // Wait for every task, they access the chunks and columns
+    for (int i = 0; i < chunks.size(); i++)
+    {
+        mutex.lock();
+        while (!chunks.at(i).done)
+        {
+            chunkDone.wait(&mutex);
+        }
+        if (parse && !aborted)
+        {
+            readyRows = chunks.at(i).firstRow + chunks.at(i).rows;
+            loadedBytes = chunks.at(i).end;
+        }
+        int rows = readyRows;
+        mutex.unlock();
+        if (parse && !aborted)
+        {
+            emit rowsLoaded(rows);
+        }
+    }
+}
+
+void QGCCsvLoader::countChunk(int index)
+{
+    const char* p = data + chunks.at(index).begin;
+    const char* end = data + chunks.at(index).end;
+    const char* lineEnd;
+    int rows = 0;
+    while (p < end)
+    {
+        const char* line = p;
+        p = nextLine(p, end, &lineEnd);
+        // Empty lines are no rows
+        if (lineEnd > line) rows++;
+    }
+    chunks[index].rows = rows;
+}
+
+void QGCCsvLoader::parseChunk(int index)
+{
+    const char* p = data + chunks.at(index).begin;
+    const char* end = data + chunks.at(index).end;
+    const char* lineEnd;
+    const char* sep = separatorBytes.constData();
+    const int sepLength = separatorBytes.size();
+
+    // Output array of each field, NULL if the field is skipped
+    int fields = 0;
+    foreach (int column, loadColumns) fields = qMax(fields, column + 1);
+    QVector<double*> targets(fields);
+    foreach (int column, loadColumns)
+    {
+        targets[column] = values[column].data();
+    }
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    int row = chunks.at(index).firstRow;
+    while (p < end)
+    {
+        const char* line = p;
+        p = nextLine(p, end, &lineEnd);
+        if (lineEnd == line) continue;
+
+        // Missing fields stay NaN
+        foreach (int column, loadColumns)
+        {
+            targets[column][row] = nan;
+        }
+
+        // Empty fields are skipped like QString::SkipEmptyParts does
+        int field = 0;
+        const char* fieldBegin = line;
+        while (fieldBegin < lineEnd && field < fields)
+        {
+            const char* fieldEnd = lineEnd;
+            if (sepLength == 1)
+            {
+                const char* found = (const char*)memchr(fieldBegin, sep[0], lineEnd - fieldBegin);
+                if (found) fieldEnd = found;
+            }
+            else if (sepLength > 1)
+            {
+                for (const char* s = fieldBegin; s + sepLength <= lineEnd; s++)
+                {
+                    if (memcmp(s, sep, sepLength) == 0)
+                    {
+                        fieldEnd = s;
+                        break;
+                    }
+                }
+            }
+            if (fieldEnd > fieldBegin)
+            {
+                if (targets.at(field) != NULL)
+                {
+                    targets[field][row] = parseNumber(fieldBegin, fieldEnd);
+                }
+                field++;
+            }
+            fieldBegin = (fieldEnd < lineEnd) ? fieldEnd + sepLength : lineEnd;
+        }
+        row++;
+    }
+}
+
+void QGCCsvLoader::finishChunk(int index)
+{
+    QMutexLocker locker(&mutex);
+    chunks[index].done = true;
+    chunkDone.wakeAll();
+}
+
+void QGCCsvLoader::close()
+{
+    if (data != NULL && buffer.isEmpty())
+    {
+        file.unmap((uchar*)data);
+    }
+    data = NULL;
+    buffer.clear();
+    file.close();
+    values.clear();
+    chunks.clear();
+    loadColumns.clear();
+    totalRows = -1;
+    readyRows = 0;
+    loadedBytes = 0;
+}
@@ -0,0 +1,134 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the parallel loader for CSV log files
+ *
+ */
+
+#ifndef QGCCSVLOADER_H
+#define QGCCSVLOADER_H
+
+#include <QThread>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+
+/**
+ * @brief Loads the columns of a CSV or TSV file in the background
+ *
+ * The file is memory mapped and split into line-aligned chunks. The chunks
+ * are first counted and then parsed in parallel on the global thread pool,
+ * each into its own range of the preallocated column arrays. The rows are
+ * announced in file order with rowsLoaded() as soon as all chunks up to
+ * them are parsed, so the first rows can be plotted while the rest of the
+ * file is still loading.
+ *
+ * Numbers are parsed without locale, fields which are empty or not a
+ * number are loaded as NaN.
+ **/
+class QGCCsvLoader : public QThread
+{
+    Q_OBJECT
+
+public:
+    QGCCsvLoader(QObject* parent = 0);
+    ~QGCCsvLoader();
+
+    /** @brief Open a file and read its header, returns false if it can not be read */
+    bool open(const QString& fileName);
+    /** @brief Get the separator detected in the header */
+    QString getSeparator() const;
+    /** @brief Get the names of the columns */
+    QStringList getColumnNames() const;
+    /** @brief Start loading the given columns in the background */
+    void load(const QList<int>& columns);
+    /** @brief Stop loading, the rows loaded so far stay available */
+    void abort();
+    /** @brief Get the number of rows loaded, these are complete in all loaded columns */
+    int getRows();
+    /** @brief Get the total number of rows, -1 while they are still being counted */
+    int getTotalRows();
+    /** @brief Get the values of a column, NULL if the column is not loaded */
+    const double* getColumn(int column) const;
+    /** @brief Get the file size in kilobytes, for the progress */
+    int getSize() const;
+    /** @brief Get the kilobytes loaded so far */
+    int getLoaded();
+
+signals:
+    /** @brief The first rows of all loaded columns are available now */
+    void rowsLoaded(int rows);
+
+protected:
+    /** @brief A line-aligned part of the file */
+    struct Chunk
+    {
+        qint64 begin;       ///< Offset of the first line
+        qint64 end;         ///< Offset after the last line
+        int firstRow;       ///< Index of the first row of this chunk
+        int rows;           ///< Number of rows in this chunk
+        bool done;          ///< Set when the current phase finished for this chunk
+    };
+
+    void run();
+    /** @brief Count the rows of a chunk, called in the thread pool */
+    void countChunk(int index);
+    /** @brief Parse the rows of a chunk into the columns, called in the thread pool */
+    void parseChunk(int index);
+    /** @brief Mark a chunk as done for the current phase */
+    void finishChunk(int index);
+    /** @brief Run one phase on all chunks and wait for the chunks in order */
+    void runPhase(bool parse);
+    /** @brief Release the file mapping and the loaded columns */
+    void close();
+
+    QFile file;                     ///< The file being loaded
+    const char* data;               ///< The mapped file, or the fallback buffer
+    QByteArray buffer;              ///< Contents of the file if it can not be mapped
+    qint64 size;                    ///< Size of the file in bytes
+    qint64 dataStart;               ///< Offset of the first row after the header
+    QString separator;              ///< Field separator detected in the header
+    QByteArray separatorBytes;      ///< The separator as bytes
+    QStringList columnNames;        ///< Names of the columns from the header
+    QVector<QVector<double> > values; ///< Loaded columns, empty if not loaded
+    QVector<int> loadColumns;       ///< Indices of the columns being loaded
+    QVector<Chunk> chunks;          ///< The parts of the file
+    int totalRows;                  ///< Rows in the file, -1 until counted
+    int readyRows;                  ///< Rows loaded in all chunks up to them
+    qint64 loadedBytes;             ///< Bytes of the chunks loaded in order
+    volatile bool aborted;          ///< Set to stop loading
+    QMutex mutex;                   ///< Protects the chunk states
+    QWaitCondition chunkDone;       ///< Signaled when a chunk finished a phase
+
+    friend class QGCCsvLoaderTask;
+
+private:
+    Q_DISABLE_COPY(QGCCsvLoader)
+};
+
+#endif // QGCCSVLOADER_H
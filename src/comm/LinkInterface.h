@@ -34,6 +34,8 @@ along with PIXHAWK. If not, see <http://www.gnu.org/licenses/>.
 
 #include <QThread>
 
+class LinkRingBuffer;
+
 /**
 * The link interface defines the interface for all links used to communicate
 * with the groundstation application.
@@ -42,6 +44,10 @@ along with PIXHAWK. If not, see <http://www.gnu.org/licenses/>.
 class LinkInterface : public QThread {
     Q_OBJECT
 public:
+    LinkInterface() :
+            receiveBuffer(NULL)
+    {
+    }
     //virtual ~LinkInterface() = 0;
 
     /* Connection management */
@@ -179,6 +185,46 @@ public:
      **/
     virtual qint64 bytesAvailable() = 0;
 
+    /**
+     * @brief Let the link write received bytes directly into a ring buffer
+     *
+     * If a ring is set, the link reader writes the received bytes in place
+     * into the ring instead of emitting them with bytesReceived(). The signal
+     * is then only emitted if other receivers are connected to it.
+     * Links which do not support this return false and keep emitting all
+     * bytes with bytesReceived().
+     *
+     * @param buffer The ring to write to, NULL to detach the ring
+     * @return True if the link writes into the ring, false if not supported
+     **/
+    virtual bool setReceiveBuffer(LinkRingBuffer* buffer)
+    {
+        Q_UNUSED(buffer);
+        return false;
+    }
+
+    /**
+     * @brief Write bytes addressed to one system
+     *
+     * Links reaching several systems, e.g. one UDP port shared by several
+     * vehicles, can send the bytes only to the given system. By default
+     * the bytes are written to the whole link.
+     *
+     * @param systemId The MAVLink system id of the receiver
+     * @param bytes The pointer to the byte array containing the data
+     * @param length The length of the data array
+     **/
+    virtual void writeBytesToSystem(int systemId, const char* bytes, qint64 length)
+    {
+        Q_UNUSED(systemId);
+        writeBytes(bytes, length);
+    }
+    /** @brief Get the ring the link writes received bytes to, NULL if none is attached */
+    LinkRingBuffer* getReceiveBuffer()
+    {
+        return receiveBuffer;
+    }
+
 public slots:
 
     /**
@@ -228,6 +274,8 @@ signals:
     void nameChanged(QString name);
 
 protected:
+    LinkRingBuffer* receiveBuffer; ///< Ring to write received bytes to, NULL to emit them
+
     static int getNextLinkId()
     {
         static int nextId = 0;
@@ -30,7 +30,7 @@ This file is part of the QGROUNDCONTROL project
  */
 
 #include <QList>
-#include <QApplication>
+#include <QCoreApplication>
 #include "LinkManager.h"
 
 #include <QDebug>
@@ -72,8 +72,14 @@ void LinkManager::add(LinkInterface* link)
 void LinkManager::addProtocol(LinkInterface* link, ProtocolInterface* protocol)
 {
     // Connect link to protocol
-    // the protocol will receive new bytes from the link
-    connect(link, SIGNAL(bytesReceived(LinkInterface*, QByteArray)), protocol, SLOT(receiveBytes(LinkInterface*, QByteArray)));
+    // the protocol either drains the receive ring of the link in place,
+    // or receives new bytes from the link directly in the thread of
+    // the link. The protocol is responsible to process the bytes
+    // of different links in parallel
+    if (!protocol->attachLink(link))
+    {
+        connect(link, SIGNAL(bytesReceived(LinkInterface*, QByteArray)), protocol, SLOT(receiveBytes(LinkInterface*, QByteArray)), Qt::DirectConnection);
+    }
     // Store the connection information in the protocol links map
     protocolLinks.insertMulti(protocol, link);
     //qDebug() << __FILE__ << __LINE__ << "ADDED LINK TO PROTOCOL" << link->getName() << protocol->getName() << "NEW SIZE OF LINK LIST:" << protocolLinks.size();
@@ -0,0 +1,77 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class LinkRate
+ */
+
+#include "LinkRate.h"
+
+LinkRate::LinkRate()
+{
+    reset();
+}
+
+void LinkRate::reset()
+{
+    newest = -1;
+    count = 0;
+    current = 0;
+    max = 0;
+}
+
+/**
+ * Samples closer than SAMPLE_INTERVAL to the newest one are dropped, so
+ * querying the rate often does not shrink the window.
+ *
+ * @param total Bits transferred since the link was created
+ * @param time Time of the sample in milliseconds
+ */
+void LinkRate::update(quint64 total, quint64 time)
+{
+    if (count > 0 && time < times[newest] + SAMPLE_INTERVAL) return;
+
+    newest = (newest + 1) % WINDOW_SAMPLES;
+    totals[newest] = total;
+    times[newest] = time;
+    if (count < WINDOW_SAMPLES) count++;
+
+    int oldest = (newest - count + 1 + WINDOW_SAMPLES) % WINDOW_SAMPLES;
+    quint64 span = times[newest] - times[oldest];
+    if (span > 0)
+    {
+        current = (qint64)((totals[newest] - totals[oldest]) * 1000 / span);
+        if (current > max) max = current;
+    }
+}
+
+qint64 LinkRate::getCurrent() const
+{
+    return current;
+}
+
+qint64 LinkRate::getMax() const
+{
+    return max;
+}
@@ -0,0 +1,73 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class LinkRate
+ */
+
+#ifndef LINKRATE_H_
+#define LINKRATE_H_
+
+#include <QtGlobal>
+
+/**
+ * @brief Sliding window data rate of a link
+ *
+ * Keeps the running total of transferred bits at up to eight points in
+ * time, at least 100 ms apart. The current rate is the slope over the
+ * window, the maximum is the highest current rate seen so far. The
+ * links sample their counters whenever a rate is queried, the rate is
+ * not synchronized, the caller has to hold the statistics lock of
+ * the link.
+ **/
+class LinkRate
+{
+public:
+    LinkRate();
+
+    /** @brief Record the total number of bits at the given time in milliseconds */
+    void update(quint64 total, quint64 time);
+    /** @brief Forget all samples, e.g. after reconnecting */
+    void reset();
+    /** @brief Get the rate over the window in bit per second */
+    qint64 getCurrent() const;
+    /** @brief Get the highest rate seen in bit per second */
+    qint64 getMax() const;
+
+    enum
+    {
+        WINDOW_SAMPLES = 8,
+        SAMPLE_INTERVAL = 100 ///< Minimum distance of two samples in milliseconds
+    };
+
+protected:
+    quint64 totals[WINDOW_SAMPLES];
+    quint64 times[WINDOW_SAMPLES];
+    int newest;    ///< Index of the newest sample
+    int count;     ///< Number of valid samples
+    qint64 current;
+    qint64 max;
+};
+
+#endif // LINKRATE_H_
@@ -0,0 +1,149 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class LinkRingBuffer
+ */
+
+#include <cstring>
+#include <QMetaObject>
+#include "LinkRingBuffer.h"
+
+LinkRingBuffer::LinkRingBuffer(int size) :
+        head(0),
+        tail(0),
+        notified(0),
+        highWaterMark(0),
+        overruns(0),
+        overrunBytes(0),
+        consumer(NULL),
+        member(NULL)
+{
+    // Round up to the next power of two, so that the free running
+    // head and tail counters can be masked into the buffer
+    this->size = 1;
+    while (this->size < static_cast<unsigned int>(size)) this->size <<= 1;
+    mask = this->size - 1;
+    buffer = new char[this->size];
+}
+
+LinkRingBuffer::~LinkRingBuffer()
+{
+    delete[] buffer;
+}
+
+/**
+ * The member is invoked through a queued connection, it has to call
+ * acknowledge() before draining the ring.
+ *
+ * @param consumer The object draining the ring
+ * @param member The name of the slot to invoke, without signature
+ */
+void LinkRingBuffer::setConsumer(QObject* consumer, const char* member)
+{
+    this->consumer = consumer;
+    this->member = member;
+}
+
+/**
+ * @param length The number of bytes written, has to be less or equal than
+ *               the length returned by the last call to writeSpan()
+ */
+void LinkRingBuffer::commit(int length)
+{
+    if (length <= 0) return;
+    int written = head.fetchAndAddRelease(length) + length;
+    int fill = static_cast<int>(static_cast<unsigned int>(written) - static_cast<unsigned int>(int(tail)));
+    if (fill > int(highWaterMark)) highWaterMark.fetchAndStoreRelaxed(fill);
+
+    // Only post a notification if the consumer has drained since the last one
+    if (consumer && notified.testAndSetOrdered(0, 1))
+    {
+        QMetaObject::invokeMethod(consumer, member, Qt::QueuedConnection);
+    }
+}
+
+/**
+ * Copies as many bytes as fit, wrapping around the end of the buffer. Bytes
+ * which do not fit are counted as overrun.
+ *
+ * @param data The bytes to copy
+ * @param length The number of bytes to copy
+ * @return The number of bytes copied
+ */
+int LinkRingBuffer::write(const char* data, int length)
+{
+    int copied = 0;
+    // At most two spans, before and after the wrap-around
+    for (int span = 0; span < 2 && copied < length; span++)
+    {
+        int available;
+        char* target = writeSpan(&available);
+        if (available <= 0) break;
+        int chunk = qMin(available, length - copied);
+        memcpy(target, data + copied, chunk);
+        commit(chunk);
+        copied += chunk;
+    }
+    if (copied < length) addOverrun(length - copied);
+    return copied;
+}
+
+void LinkRingBuffer::addOverrun(int length)
+{
+    overruns.fetchAndAddRelaxed(1);
+    overrunBytes.fetchAndAddRelaxed(length);
+}
+
+int LinkRingBuffer::getSize() const
+{
+    return static_cast<int>(size);
+}
+
+int LinkRingBuffer::getFill()
+{
+    return static_cast<int>(static_cast<unsigned int>(head.fetchAndAddAcquire(0)) - static_cast<unsigned int>(tail.fetchAndAddAcquire(0)));
+}
+
+int LinkRingBuffer::getHighWaterMark()
+{
+    return highWaterMark;
+}
+
+int LinkRingBuffer::getOverruns()
+{
+    return overruns;
+}
+
+int LinkRingBuffer::getOverrunBytes()
+{
+    return overrunBytes;
+}
+
+void LinkRingBuffer::resetStatistics()
+{
+    highWaterMark.fetchAndStoreRelaxed(0);
+    overruns.fetchAndStoreRelaxed(0);
+    overrunBytes.fetchAndStoreRelaxed(0);
+}
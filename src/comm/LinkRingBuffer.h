@@ -0,0 +1,140 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class LinkRingBuffer
+ */
+
+#ifndef LINKRINGBUFFER_H_
+#define LINKRINGBUFFER_H_
+
+#include <QObject>
+#include <QAtomicInt>
+
+/**
+ * @brief Lock-free byte ring between one link reader and one decoder
+ *
+ * The ring is a single producer, single consumer queue. The thread reading
+ * the link writes directly into the free span of the ring and commits it,
+ * the decoder drains whole spans of committed bytes. Neither side takes a
+ * lock or allocates memory.
+ *
+ * The consumer is notified through a queued call, which is only posted if
+ * the consumer has not yet been notified since its last drain. A burst of
+ * reads therefore results in a single notification.
+ **/
+class LinkRingBuffer
+{
+public:
+    /** @param size Capacity in bytes, rounded up to the next power of two */
+    LinkRingBuffer(int size = 65536);
+    ~LinkRingBuffer();
+
+    /** @brief Set the object and slot to invoke when new bytes were committed */
+    void setConsumer(QObject* consumer, const char* member);
+
+    /* Producer side, only to be called from the link reader thread */
+
+    /**
+     * @brief Get the contiguous free span
+     * @param length Returns the number of bytes which can be written
+     * @return Pointer to write to
+     */
+    inline char* writeSpan(int* length)
+    {
+        unsigned int written = static_cast<unsigned int>(int(head));
+        unsigned int used = written - static_cast<unsigned int>(tail.fetchAndAddAcquire(0));
+        unsigned int offset = written & mask;
+        unsigned int contiguous = size - offset;
+        unsigned int space = size - used;
+        *length = static_cast<int>((space < contiguous) ? space : contiguous);
+        return buffer + offset;
+    }
+    /** @brief Publish length bytes written to the span returned by writeSpan() */
+    void commit(int length);
+    /** @brief Copy bytes into the ring, returns the number of bytes actually written */
+    int write(const char* data, int length);
+    /** @brief Record bytes which had to be dropped since the ring was full */
+    void addOverrun(int length);
+
+    /* Consumer side, only to be called from the decoder thread */
+
+    /**
+     * @brief Get the contiguous span of committed bytes
+     * @param length Returns the number of bytes which can be read
+     * @return Pointer to read from
+     */
+    inline const char* readSpan(int* length)
+    {
+        unsigned int released = static_cast<unsigned int>(int(tail));
+        unsigned int used = static_cast<unsigned int>(head.fetchAndAddAcquire(0)) - released;
+        unsigned int offset = released & mask;
+        unsigned int contiguous = size - offset;
+        *length = static_cast<int>((used < contiguous) ? used : contiguous);
+        return buffer + offset;
+    }
+    /** @brief Give length bytes of the span returned by readSpan() back to the producer */
+    inline void release(int length)
+    {
+        tail.fetchAndAddRelease(length);
+    }
+    /** @brief Re-arm the notification, has to be called before draining */
+    inline void acknowledge()
+    {
+        notified.fetchAndStoreOrdered(0);
+    }
+
+    /* Statistics, can be called from any thread */
+
+    /** @brief Capacity of the ring in bytes */
+    int getSize() const;
+    /** @brief Number of committed bytes not yet drained */
+    int getFill();
+    /** @brief Maximum fill level observed since the last reset */
+    int getHighWaterMark();
+    /** @brief Number of reads of which bytes were dropped since the ring was full */
+    int getOverruns();
+    /** @brief Number of bytes dropped since the ring was full */
+    int getOverrunBytes();
+    /** @brief Reset high-water mark and overrun counters */
+    void resetStatistics();
+
+protected:
+    char* buffer;               ///< Storage of the ring
+    unsigned int size;          ///< Capacity, power of two
+    unsigned int mask;          ///< size - 1
+    QAtomicInt head;            ///< Bytes committed in total, written by the producer only
+    QAtomicInt tail;            ///< Bytes released in total, written by the consumer only
+    QAtomicInt notified;        ///< 1 if a notification is pending at the consumer
+    QAtomicInt highWaterMark;   ///< Maximum fill level, written by the producer only
+    QAtomicInt overruns;        ///< Number of overrun events
+    QAtomicInt overrunBytes;    ///< Number of bytes dropped since the ring was full
+    QObject* consumer;          ///< Object to notify
+    const char* member;         ///< Slot to invoke on the consumer
+
+private:
+    Q_DISABLE_COPY(LinkRingBuffer)
+};
+
+#endif // LINKRINGBUFFER_H_
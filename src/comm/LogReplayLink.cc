@@ -0,0 +1,429 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class LogReplayLink
+ */
+
+#include <cstring>
+#include <QTime>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include "LogReplayLink.h"
+#include "LinkRingBuffer.h"
+#include "LinkManager.h"
+
+/* Frames are collected into chunks of this size before they are handed
+ * to the protocol, in real time mode chunks are handed over when due */
+static const int REPLAY_CHUNK_SIZE = 16 * 1024;
+/* Longest sleep while waiting for the next packet, so controls stay responsive */
+static const int REPLAY_MAX_SLEEP = 20;
+
+/**
+ * @param fileName The packet log to replay
+ */
+LogReplayLink::LogReplayLink(QString fileName) :
+        id(getNextLinkId()),
+        fileName(fileName),
+        speed(1.0),
+        paused(false),
+        looping(false),
+        seekRequested(false),
+        seekTime(0),
+        controlChanged(false),
+        running(false),
+        connectState(false),
+        currentTime(0),
+        messageRate(0),
+        bitsReceived(0)
+{
+    name = tr("log replay ") + QFileInfo(fileName).fileName();
+    // Link is setup, register it with link manager
+    LinkManager::instance()->add(this);
+}
+
+LogReplayLink::~LogReplayLink()
+{
+    disconnect();
+}
+
+/**
+ * Reads the log packet by packet. Packets are delivered when their log time,
+ * scaled by the replay speed, is due. In max-speed mode they are delivered
+ * as soon as a chunk is full.
+ */
+void LogReplayLink::run()
+{
+    char frame[MAVLINK_MAX_PACKET_LEN];
+    QByteArray chunk;
+    chunk.reserve(REPLAY_CHUNK_SIZE + MAVLINK_MAX_PACKET_LEN);
+
+    QTime wallClock;
+    QTime rateClock;
+    quint64 logStart = 0;
+    bool resync = true;
+    int messages = 0;
+    rateClock.start();
+
+    while (running)
+    {
+        // Take over the controls
+        controlMutex.lock();
+        controlChanged = false;
+        if (seekRequested)
+        {
+            reader.seek(seekTime);
+            seekRequested = false;
+            resync = true;
+        }
+        double replaySpeed = speed;
+        bool replayPaused = paused;
+        bool replayLooping = looping;
+        controlMutex.unlock();
+
+        if (replayPaused)
+        {
+            deliver(chunk.constData(), chunk.size());
+            chunk.resize(0);
+            resync = true;
+            msleep(REPLAY_MAX_SLEEP);
+            continue;
+        }
+
+        quint64 time;
+        int length = reader.readPacket(&time, frame);
+        if (length == 0)
+        {
+            // End of the log
+            deliver(chunk.constData(), chunk.size());
+            chunk.resize(0);
+            reader.rewind();
+            if (!replayLooping)
+            {
+                // Resuming starts over
+                controlMutex.lock();
+                paused = true;
+                controlMutex.unlock();
+                emit replayFinished();
+            }
+            resync = true;
+            continue;
+        }
+
+        if (resync)
+        {
+            // Pace relative to the first packet after start, pause, seek or loop
+            logStart = time;
+            wallClock.start();
+            resync = false;
+        }
+        else if (replaySpeed > 0 && time > logStart)
+        {
+            int due = static_cast<int>((time - logStart) / (1000.0 * replaySpeed));
+            int wait = due - wallClock.elapsed();
+            if (wait > 0)
+            {
+                // Hand over everything which is due before sleeping
+                deliver(chunk.constData(), chunk.size());
+                chunk.resize(0);
+                while (wait > 0 && running && !controlChanged)
+                {
+                    msleep(qMin(wait, REPLAY_MAX_SLEEP));
+                    wait = due - wallClock.elapsed();
+                }
+            }
+        }
+
+        chunk.append(frame, length);
+        currentTime = time;
+        messages++;
+        if (chunk.size() >= REPLAY_CHUNK_SIZE)
+        {
+            deliver(chunk.constData(), chunk.size());
+            chunk.resize(0);
+        }
+
+        int elapsed = rateClock.elapsed();
+        if (elapsed >= 1000)
+        {
+            messageRate = messages * 1000.0 / elapsed;
+            messages = 0;
+            rateClock.restart();
+            emit messageRateChanged(messageRate);
+            emit timeChanged(currentTime);
+        }
+    }
+    deliver(chunk.constData(), chunk.size());
+}
+
+/**
+ * Waits for the decoder if the ring is full, so no replayed byte is lost.
+ *
+ * @param data The frames to deliver
+ * @param length The number of bytes
+ */
+void LogReplayLink::deliver(const char* data, int length)
+{
+    if (length <= 0) return;
+    bitsReceived += length * 8;
+
+    dataMutex.lock();
+    if (receiveBuffer == NULL)
+    {
+        dataMutex.unlock();
+        emit bytesReceived(this, QByteArray(data, length));
+        return;
+    }
+    int written = 0;
+    while (written < length && receiveBuffer != NULL && running)
+    {
+        int space;
+        char* span = receiveBuffer->writeSpan(&space);
+        if (space > 0)
+        {
+            int count = qMin(space, length - written);
+            memcpy(span, data + written, count);
+            receiveBuffer->commit(count);
+            written += count;
+        }
+        else
+        {
+            // Let the decoder drain, the ring might be detached meanwhile
+            dataMutex.unlock();
+            msleep(1);
+            dataMutex.lock();
+        }
+    }
+    dataMutex.unlock();
+    // Only copy the bytes if somebody else is listening
+    if (receivers(SIGNAL(bytesReceived(LinkInterface*, QByteArray))) > 0)
+    {
+        emit bytesReceived(this, QByteArray(data, length));
+    }
+}
+
+bool LogReplayLink::setReceiveBuffer(LinkRingBuffer* buffer)
+{
+    dataMutex.lock();
+    receiveBuffer = buffer;
+    dataMutex.unlock();
+    return true;
+}
+
+/**
+ * Opens the log and starts replaying it from the beginning.
+ *
+ * @return False if the log could not be opened
+ */
+bool LogReplayLink::connect()
+{
+    disconnect();
+    if (!reader.open(fileName))
+    {
+        emit connected(false);
+        return false;
+    }
+    controlMutex.lock();
+    paused = false;
+    seekRequested = false;
+    controlMutex.unlock();
+    currentTime = reader.getStartTime();
+    messageRate = 0;
+    running = true;
+    connectState = true;
+    emit connected(true);
+    emit connected();
+    // Low priority, so a max-speed replay does not starve the user interface
+    start(LowPriority);
+    return true;
+}
+
+bool LogReplayLink::disconnect()
+{
+    if (running)
+    {
+        running = false;
+        wait();
+    }
+    reader.close();
+    if (connectState)
+    {
+        connectState = false;
+        emit disconnected();
+        emit connected(false);
+    }
+    return true;
+}
+
+bool LogReplayLink::isConnected()
+{
+    return connectState;
+}
+
+void LogReplayLink::writeBytes(const char* data, qint64 size)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+}
+
+void LogReplayLink::readBytes()
+{
+    // The replay thread pushes the bytes
+}
+
+qint64 LogReplayLink::bytesAvailable()
+{
+    return 0;
+}
+
+void LogReplayLink::setFileName(QString fileName)
+{
+    this->fileName = fileName;
+    name = tr("log replay ") + QFileInfo(fileName).fileName();
+    emit nameChanged(name);
+}
+
+void LogReplayLink::setSpeed(double speed)
+{
+    QMutexLocker locker(&controlMutex);
+    this->speed = qMax(0.0, speed);
+    controlChanged = true;
+}
+
+void LogReplayLink::setPaused(bool paused)
+{
+    QMutexLocker locker(&controlMutex);
+    this->paused = paused;
+    controlChanged = true;
+}
+
+/**
+ * @param time Time in microseconds since epoch, between getStartTime() and getEndTime()
+ */
+void LogReplayLink::seek(quint64 time)
+{
+    QMutexLocker locker(&controlMutex);
+    seekTime = time;
+    seekRequested = true;
+    controlChanged = true;
+}
+
+void LogReplayLink::setLooping(bool loop)
+{
+    QMutexLocker locker(&controlMutex);
+    looping = loop;
+}
+
+QString LogReplayLink::getFileName()
+{
+    return fileName;
+}
+
+double LogReplayLink::getSpeed()
+{
+    QMutexLocker locker(&controlMutex);
+    return speed;
+}
+
+bool LogReplayLink::isPaused()
+{
+    QMutexLocker locker(&controlMutex);
+    return paused;
+}
+
+bool LogReplayLink::isLooping()
+{
+    QMutexLocker locker(&controlMutex);
+    return looping;
+}
+
+quint64 LogReplayLink::getStartTime()
+{
+    return reader.getStartTime();
+}
+
+quint64 LogReplayLink::getEndTime()
+{
+    return reader.getEndTime();
+}
+
+quint64 LogReplayLink::getCurrentTime()
+{
+    return currentTime;
+}
+
+double LogReplayLink::getMessageRate()
+{
+    return messageRate;
+}
+
+QString LogReplayLink::getName()
+{
+    return name;
+}
+
+int LogReplayLink::getId()
+{
+    return id;
+}
+
+qint64 LogReplayLink::getNominalDataRate()
+{
+    return 0;
+}
+
+qint64 LogReplayLink::getTotalUpstream()
+{
+    return 0;
+}
+
+qint64 LogReplayLink::getCurrentUpstream()
+{
+    return 0;
+}
+
+qint64 LogReplayLink::getMaxUpstream()
+{
+    return 0;
+}
+
+qint64 LogReplayLink::getBitsSent()
+{
+    return 0;
+}
+
+qint64 LogReplayLink::getBitsReceived()
+{
+    return bitsReceived;
+}
+
+int LogReplayLink::getLinkQuality()
+{
+    return -1;
+}
+
+bool LogReplayLink::isFullDuplex()
+{
+    return false;
+}
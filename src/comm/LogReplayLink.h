@@ -0,0 +1,144 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class LogReplayLink
+ */
+
+#ifndef LOGREPLAYLINK_H_
+#define LOGREPLAYLINK_H_
+
+#include <QString>
+#include <QMutex>
+#include <QByteArray>
+#include "LinkInterface.h"
+#include "MAVLinkLogReader.h"
+
+/**
+ * @brief Link replaying a binary packet log
+ *
+ * The link streams the frames of a log written by MAVLinkLogWriter into
+ * the protocol, which processes them like live traffic. Replay can run in
+ * real time, at a multiple of real time or as fast as possible. It can
+ * also be paused, positioned anywhere in the log and looped.
+ *
+ * Frames are handed to the protocol in chunks. If a receive ring is
+ * attached, the replay waits for free space instead of dropping bytes,
+ * so in max-speed mode the achieved message rate measures the throughput
+ * of the ground station.
+ **/
+class LogReplayLink : public LinkInterface
+{
+    Q_OBJECT
+
+public:
+    LogReplayLink(QString fileName = "");
+    ~LogReplayLink();
+
+    void run();
+
+    bool isConnected();
+    qint64 bytesAvailable();
+    QString getName();
+    int getId();
+
+    /* Extensive statistics for scientific purposes */
+    qint64 getNominalDataRate();
+    qint64 getTotalUpstream();
+    qint64 getCurrentUpstream();
+    qint64 getMaxUpstream();
+    qint64 getBitsSent();
+    qint64 getBitsReceived();
+
+    int getLinkQuality();
+    bool isFullDuplex();
+
+    bool connect();
+    bool disconnect();
+    bool setReceiveBuffer(LinkRingBuffer* buffer);
+
+    /** @brief Get the name of the replayed log */
+    QString getFileName();
+    /** @brief Get the replay speed, 0 for as fast as possible */
+    double getSpeed();
+    /** @brief Check if the replay is paused */
+    bool isPaused();
+    /** @brief Check if the replay restarts at the end of the log */
+    bool isLooping();
+    /** @brief Time of the first packet of the log in microseconds since epoch */
+    quint64 getStartTime();
+    /** @brief Time of the last packet of the log in microseconds since epoch */
+    quint64 getEndTime();
+    /** @brief Time of the last replayed packet in microseconds since epoch */
+    quint64 getCurrentTime();
+    /** @brief Replayed messages per second, measured over the last second */
+    double getMessageRate();
+
+public slots:
+    /** @brief Replayed vehicles can not receive, the bytes are discarded */
+    void writeBytes(const char* data, qint64 size);
+    void readBytes();
+    /** @brief Set the log to replay, takes effect on the next connect */
+    void setFileName(QString fileName);
+    /** @brief Set the replay speed, 1 for real time, 0 for as fast as possible */
+    void setSpeed(double speed);
+    /** @brief Pause or resume the replay */
+    void setPaused(bool paused);
+    /** @brief Continue the replay at the first packet logged at or after the time */
+    void seek(quint64 time);
+    /** @brief Restart the replay at the end of the log */
+    void setLooping(bool loop);
+
+signals:
+    /** @brief Emitted once per second with the replayed messages per second */
+    void messageRateChanged(double messagesPerSecond);
+    /** @brief Emitted once per second with the time of the last replayed packet */
+    void timeChanged(quint64 time);
+    /** @brief Emitted when the end of the log was reached and the replay is not looping */
+    void replayFinished();
+
+protected:
+    int id;
+    QString name;
+    QString fileName;
+    MAVLinkLogReader reader;   ///< Only accessed by the replay thread while connected
+    QMutex controlMutex;       ///< Protects the replay controls
+    double speed;
+    bool paused;
+    bool looping;
+    bool seekRequested;
+    quint64 seekTime;
+    volatile bool controlChanged; ///< Set by the controls to interrupt waiting
+    volatile bool running;     ///< Cleared to stop the replay thread
+    bool connectState;
+    QMutex dataMutex;          ///< Protects the receive ring
+    quint64 currentTime;
+    double messageRate;
+    qint64 bitsReceived;
+
+    /** @brief Hand replayed frames to the protocol */
+    void deliver(const char* data, int length);
+};
+
+#endif // LOGREPLAYLINK_H_
@@ -0,0 +1,149 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class MAVLinkDecoder
+ */
+
+#include "MAVLinkDecoder.h"
+#include "MAVLinkProtocol.h"
+
+/**
+ * The decoder moves itself into a newly created worker thread, all slots
+ * invoked through queued connections are executed there.
+ *
+ * @param protocol The protocol instance to hand the decoded messages to
+ * @param link The link to decode
+ */
+MAVLinkDecoder::MAVLinkDecoder(MAVLinkProtocol* protocol, LinkInterface* link) :
+        protocol(protocol),
+        link(link),
+        worker(new QThread()),
+        ring(),
+        attached(false),
+        statistics(protocol->getStatistics()->getLinkCounters(link))
+{
+    memset(&message, 0, sizeof(message));
+    ring.setConsumer(this, "readBuffer");
+    moveToThread(worker);
+    worker->start(QThread::LowPriority);
+}
+
+/**
+ * Stops the event loop of the worker thread and waits for it to return.
+ * Bytes still queued for this decoder are discarded.
+ */
+MAVLinkDecoder::~MAVLinkDecoder()
+{
+    if (attached) link->setReceiveBuffer(NULL);
+    worker->quit();
+    worker->wait();
+    delete worker;
+}
+
+LinkInterface* MAVLinkDecoder::getLink()
+{
+    return link;
+}
+
+LinkRingBuffer* MAVLinkDecoder::getReceiveBuffer()
+{
+    return &ring;
+}
+
+/**
+ * The counters of the scanner are only written by the decoder thread
+ * and can be read from other threads for statistics.
+ */
+const MAVLinkFrameScanner* MAVLinkDecoder::getScanner()
+{
+    return &scanner;
+}
+
+/**
+ * Has to be called before the link is connected, as the link
+ * reader thread is not synchronized with this call.
+ *
+ * @return True if the link writes in place into the ring
+ */
+bool MAVLinkDecoder::attach()
+{
+    attached = link->setReceiveBuffer(&ring);
+    return attached;
+}
+
+/**
+ * @param b The bytes as read from the link
+ */
+void MAVLinkDecoder::receiveBytes(QByteArray b)
+{
+    parse(b.constData(), b.size());
+}
+
+/**
+ * Invoked by the ring once per burst of writes. All bytes committed
+ * until now are parsed, further writes trigger a new invocation.
+ */
+void MAVLinkDecoder::readBuffer()
+{
+    // Re-arm the notification first, so bytes committed while
+    // draining are not missed
+    ring.acknowledge();
+    int length;
+    const char* data = ring.readSpan(&length);
+    while (length > 0)
+    {
+        parse(data, length);
+        ring.release(length);
+        data = ring.readSpan(&length);
+    }
+}
+
+void MAVLinkDecoder::parse(const char* data, int length)
+{
+    // Complete frames are decoded in bulk, frames split across
+    // reads are collected by the scanner until they are complete
+    scanner.setData(data, length);
+    while (scanner.next(&message))
+    {
+        int frameLength;
+        const char* frame = scanner.getFrame(&frameLength);
+
+        // Packets of vehicles heard over several links are only processed once
+        bool first = protocol->deduplicator.accept(link, message);
+        int lost = protocol->statistics->update(statistics, message, frameLength, !first);
+        if (!first)
+        {
+            protocol->handleDuplicate(link, message);
+            continue;
+        }
+
+        // Pass the frame on as received, before it is processed locally
+        if (!protocol->forwarder.isEmpty())
+        {
+            protocol->forwarder.forward(link, message, frame, frameLength);
+        }
+        protocol->handleMessage(link, message, lost);
+    }
+}
@@ -0,0 +1,94 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class MAVLinkDecoder
+ */
+
+#ifndef MAVLINKDECODER_H_
+#define MAVLINKDECODER_H_
+
+#include <QObject>
+#include <QThread>
+#include <QByteArray>
+#include "LinkInterface.h"
+#include "LinkRingBuffer.h"
+#include "MAVLinkFrameScanner.h"
+#include "MAVLinkStatistics.h"
+#include "protocol.h"
+#include "mavlink.h"
+
+class MAVLinkProtocol;
+
+/**
+ * @brief Parsing context of one link
+ *
+ * Every link connected to the MAVLink protocol gets its own decoder, which
+ * lives in its own worker thread. The decoder keeps the parser state of
+ * the link and hands complete messages to the protocol. Links do therefore
+ * not block each other while parsing, a burst on one link only delays
+ * this link.
+ *
+ * Links supporting it write their bytes in place into the receive ring of
+ * the decoder, which is drained span by span. Other links hand their bytes
+ * over with receiveBytes().
+ **/
+class MAVLinkDecoder : public QObject
+{
+    Q_OBJECT
+
+public:
+    MAVLinkDecoder(MAVLinkProtocol* protocol, LinkInterface* link);
+    ~MAVLinkDecoder();
+
+    /** @brief Get the link this decoder parses */
+    LinkInterface* getLink();
+    /** @brief Get the receive ring of this decoder */
+    LinkRingBuffer* getReceiveBuffer();
+    /** @brief Let the link write into the receive ring, returns false if not supported by the link */
+    bool attach();
+    /** @brief Get the frame scanner of this decoder */
+    const MAVLinkFrameScanner* getScanner();
+
+public slots:
+    /** @brief Parse the bytes, has to be called in the decoder thread */
+    void receiveBytes(QByteArray b);
+    /** @brief Drain and parse the receive ring, has to be called in the decoder thread */
+    void readBuffer();
+
+protected:
+    MAVLinkProtocol* protocol; ///< Protocol instance receiving the decoded messages
+    LinkInterface* link;       ///< Link parsed by this decoder
+    QThread* worker;           ///< Worker thread running the decoder event loop
+    LinkRingBuffer ring;       ///< Bytes written in place by the link reader
+    bool attached;             ///< True if the link writes into the ring
+    MAVLinkFrameScanner scanner; ///< Bulk decoder, keeps the state of frames split across reads
+    MAVLinkStatistics::Counters* statistics; ///< Receive counters of the link
+    mavlink_message_t message; ///< Last decoded message
+
+    /** @brief Parse a span of received bytes */
+    void parse(const char* data, int length);
+};
+
+#endif // MAVLINKDECODER_H_
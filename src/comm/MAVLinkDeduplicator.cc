@@ -0,0 +1,144 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the duplicate packet suppression
+ *
+ */
+
+#include <QMutexLocker>
+#include "MAVLinkDeduplicator.h"
+
+MAVLinkDeduplicator::MAVLinkDeduplicator()
+{
+    for (int i = 0; i < 256; i++)
+    {
+        systems[i] = NULL;
+    }
+    clock.start();
+}
+
+MAVLinkDeduplicator::~MAVLinkDeduplicator()
+{
+    for (int i = 0; i < 256; i++)
+    {
+        delete (System*)systems[i];
+    }
+}
+
+/**
+ * Two threads may receive the first packet of a system at the same time,
+ * only one of the created windows is kept.
+ */
+MAVLinkDeduplicator::System* MAVLinkDeduplicator::getSystem(int sysid)
+{
+    System* system = systems[sysid];
+    if (system == NULL)
+    {
+        System* created = new System();
+        for (int i = 0; i < WINDOW; i++)
+        {
+            created->entries[i].key = 0;
+            created->entries[i].time = -2 * TIMEOUT;
+            created->entries[i].linkId = -1;
+        }
+        created->next = 0;
+        if (systems[sysid].testAndSetOrdered(NULL, created))
+        {
+            system = created;
+        }
+        else
+        {
+            delete created;
+            system = systems[sysid];
+        }
+    }
+    return system;
+}
+
+/**
+ * The checksum covers the sequence number and the payload, together with
+ * the header fields it tells copies of a packet apart from a new packet
+ * with the same sequence number.
+ */
+bool MAVLinkDeduplicator::accept(LinkInterface* link, const mavlink_message_t& message)
+{
+    quint64 key = (quint64)message.compid
+                  | ((quint64)message.seq << 8)
+                  | ((quint64)message.msgid << 16)
+                  | ((quint64)message.len << 24)
+                  | ((quint64)message.ck_a << 32)
+                  | ((quint64)message.ck_b << 40);
+    System* system = getSystem(message.sysid);
+    int linkId = link->getId();
+    int now = clock.elapsed();
+
+    system->mutex.lock();
+    for (int i = 0; i < WINDOW; i++)
+    {
+        const Entry& entry = system->entries[i];
+        if (entry.key == key && now - entry.time < TIMEOUT)
+        {
+            int firstLinkId = entry.linkId;
+            int delay = now - entry.time;
+            system->mutex.unlock();
+            addDuplicate(firstLinkId, linkId, delay);
+            return false;
+        }
+    }
+    Entry& entry = system->entries[system->next];
+    entry.key = key;
+    entry.time = now;
+    entry.linkId = linkId;
+    system->next = (system->next + 1) % WINDOW;
+    system->mutex.unlock();
+    return true;
+}
+
+void MAVLinkDeduplicator::addDuplicate(int firstLinkId, int linkId, int delay)
+{
+    QMutexLocker locker(&linkMutex);
+    Statistics& late = links[linkId];
+    late.duplicates++;
+    if (firstLinkId != linkId)
+    {
+        late.lateArrivals++;
+        late.totalDelay += delay;
+        links[firstLinkId].wins++;
+    }
+}
+
+QList<int> MAVLinkDeduplicator::getLinks()
+{
+    QMutexLocker locker(&linkMutex);
+    return links.keys();
+}
+
+bool MAVLinkDeduplicator::getStatistics(int linkId, Statistics* statistics)
+{
+    QMutexLocker locker(&linkMutex);
+    if (!links.contains(linkId)) return false;
+    *statistics = links.value(linkId);
+    return true;
+}
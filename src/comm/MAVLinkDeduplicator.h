@@ -0,0 +1,121 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the duplicate packet suppression
+ *
+ */
+
+#ifndef MAVLINKDEDUPLICATOR_H_
+#define MAVLINKDEDUPLICATOR_H_
+
+#include <QMap>
+#include <QList>
+#include <QMutex>
+#include <QTime>
+#include <QAtomicPointer>
+#include "LinkInterface.h"
+#include "protocol.h"
+#include "mavlink.h"
+
+/**
+ * @brief Drops packets already received over another link
+ *
+ * A vehicle reachable over redundant links, e.g. a serial radio and a UDP
+ * relay, delivers every packet once per link. Each system keeps a sliding
+ * window of the last packets, identified by component id, sequence number,
+ * message id, length and checksum. Only the first arrival is processed,
+ * later copies within the window are duplicates.
+ *
+ * For every duplicate arriving on another link than the original, the
+ * first link wins the packet and the late link records the delay. The
+ * share of won packets shows which link is fresher.
+ *
+ * The decoder threads of all links call accept() concurrently, the window
+ * of a system is protected by its own mutex.
+ **/
+class MAVLinkDeduplicator
+{
+public:
+    MAVLinkDeduplicator();
+    ~MAVLinkDeduplicator();
+
+    enum
+    {
+        WINDOW = 128,            ///< Packets remembered per system
+        TIMEOUT = 500            ///< Milliseconds after which a packet is no longer a duplicate, e.g. after the sequence wrapped
+    };
+
+    /** @brief Arrival counters of one link */
+    struct Statistics
+    {
+        quint64 wins;            ///< Packets first received on this link, which arrived on another link later
+        quint64 lateArrivals;    ///< Packets received on this link after another link
+        quint64 duplicates;      ///< All dropped packets of this link, including repeats on the same link
+        quint64 totalDelay;      ///< Sum of the delays of the late arrivals in ms
+    };
+
+    /**
+     * @brief Check if a packet arrives for the first time, called from the decoder threads
+     * @param link The link the packet was received on
+     * @param message The decoded packet
+     * @return True for the first arrival, false for a duplicate
+     */
+    bool accept(LinkInterface* link, const mavlink_message_t& message);
+
+    /** @brief Get the ids of all links involved in duplicates */
+    QList<int> getLinks();
+    /** @brief Get the counters of a link, returns false if the link never saw a duplicate */
+    bool getStatistics(int linkId, Statistics* statistics);
+
+protected:
+    struct Entry
+    {
+        quint64 key;
+        int time;                ///< Arrival in ms since start
+        int linkId;
+    };
+
+    struct System
+    {
+        QMutex mutex;
+        Entry entries[WINDOW];
+        int next;                ///< Oldest entry, overwritten by the next packet
+    };
+
+    QAtomicPointer<System> systems[256];
+    QMap<int, Statistics> links;  ///< Counters by link id
+    QMutex linkMutex;             ///< Protects the counters
+    QTime clock;
+
+    /** @brief Get the window of a system, creating it without lock */
+    System* getSystem(int sysid);
+    /** @brief Account a duplicate */
+    void addDuplicate(int firstLinkId, int linkId, int delay);
+
+private:
+    Q_DISABLE_COPY(MAVLinkDeduplicator)
+};
+
+#endif // MAVLINKDEDUPLICATOR_H_
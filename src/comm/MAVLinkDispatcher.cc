@@ -0,0 +1,104 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class MAVLinkDispatcher
+ */
+
+#include <QMutexLocker>
+#include "MAVLinkDispatcher.h"
+
+MAVLinkDispatcher::MAVLinkDispatcher()
+{
+    for (int i = 0; i < 256; i++)
+    {
+        routes[i] = NULL;
+    }
+}
+
+MAVLinkDispatcher::~MAVLinkDispatcher()
+{
+    foreach (Route* route, allRoutes)
+    {
+        delete route->subscriber;
+        delete route;
+    }
+}
+
+/**
+ * The slot is resolved on the dynamic type of the receiver, so classes
+ * overriding the slot of their parent receive the messages in their
+ * own implementation.
+ */
+bool MAVLinkDispatcher::addRoute(int sysid, QObject* receiver, const char* member)
+{
+    if (sysid < 0 || sysid > 255 || receiver == NULL) return false;
+    int index = receiver->metaObject()->indexOfMethod(QMetaObject::normalizedSignature(member));
+    if (index < 0) return false;
+    QMetaMethod method = receiver->metaObject()->method(index);
+    if (!MAVLinkSubscriber::isSupported(method)) return false;
+
+    Route* route = new Route();
+    route->receiver = receiver;
+    route->subscriber = new MAVLinkSubscriber(receiver, method);
+
+    QMutexLocker locker(&routeMutex);
+    allRoutes.append(route);
+    // Publish the completely initialized route
+    routes[sysid].fetchAndStoreRelease(route);
+    return true;
+}
+
+void MAVLinkDispatcher::removeRoute(QObject* receiver)
+{
+    QMutexLocker locker(&routeMutex);
+    for (int i = 0; i < 256; i++)
+    {
+        Route* route = routes[i];
+        if (route != NULL && route->receiver == receiver)
+        {
+            routes[i].fetchAndStoreRelease(NULL);
+        }
+    }
+}
+
+QObject* MAVLinkDispatcher::getReceiver(int sysid)
+{
+    Route* route = routes[sysid & 0xFF].fetchAndAddAcquire(0);
+    return (route != NULL) ? route->receiver : NULL;
+}
+
+/**
+ * Can be called from any thread. Only the handle is queued, a burst of
+ * messages for the same receiver is delivered with a single event.
+ *
+ * @param handle The pooled message and the link it was received on
+ */
+bool MAVLinkDispatcher::dispatch(const MAVLinkMessageHandle& handle)
+{
+    Route* route = routes[handle.message().sysid].fetchAndAddAcquire(0);
+    if (route == NULL) return false;
+    route->subscriber->post(handle);
+    return true;
+}
@@ -0,0 +1,98 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class MAVLinkDispatcher
+ */
+
+#ifndef MAVLINKDISPATCHER_H_
+#define MAVLINKDISPATCHER_H_
+
+#include <QObject>
+#include <QMutex>
+#include <QList>
+#include <QMetaMethod>
+#include <QAtomicPointer>
+#include "LinkInterface.h"
+#include "MAVLinkMessagePool.h"
+#include "MAVLinkSubscriber.h"
+#include "protocol.h"
+#include "mavlink.h"
+
+/**
+ * @brief Routing table delivering messages to the object owning their system id
+ *
+ * The table has one entry per possible system id. Looking up the receiver
+ * of a message is a single array access and does not take a lock, so the
+ * decoder threads of all links can dispatch concurrently. Each message is
+ * only queued to the object owning its system id, instead of being
+ * broadcast to every system. Each route has a subscriber queue in the
+ * thread of its receiver, the message is passed as pooled handle and only
+ * copied when the slot is invoked.
+ *
+ * Routes are added and removed from the main thread only. A route is never
+ * modified once published, replaced routes are kept until the dispatcher is
+ * deleted, so a decoder thread can not read a route while it is freed.
+ **/
+class MAVLinkDispatcher
+{
+public:
+    MAVLinkDispatcher();
+    ~MAVLinkDispatcher();
+
+    /**
+     * @brief Route all messages of a system to a slot of the receiver
+     * @param sysid The system id
+     * @param receiver The object owning the system
+     * @param member Signature of a slot taking (LinkInterface*, mavlink_message_t) or (MAVLinkMessageHandle)
+     * @return False if the receiver has no such slot
+     */
+    bool addRoute(int sysid, QObject* receiver, const char* member);
+    /** @brief Remove all routes to the receiver */
+    void removeRoute(QObject* receiver);
+    /** @brief Get the object owning the system, NULL if the system is unknown */
+    QObject* getReceiver(int sysid);
+    /**
+     * @brief Queue the message to the owner of its system id
+     * @return False if no route exists for the system id
+     */
+    bool dispatch(const MAVLinkMessageHandle& handle);
+
+protected:
+    /** @brief Receiver and resolved slot of one system */
+    struct Route
+    {
+        QObject* receiver;
+        MAVLinkSubscriber* subscriber; ///< Queue in the thread of the receiver
+    };
+
+    QAtomicPointer<Route> routes[256]; ///< Routes indexed by system id, NULL if unknown
+    QList<Route*> allRoutes;           ///< All routes ever published, freed with their queues on deletion
+    QMutex routeMutex;                 ///< Serializes modifications of the table
+
+private:
+    Q_DISABLE_COPY(MAVLinkDispatcher)
+};
+
+#endif // MAVLINKDISPATCHER_H_
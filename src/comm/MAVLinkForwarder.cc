@@ -0,0 +1,171 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class MAVLinkForwarder
+ */
+
+#include <cstring>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include "MAVLinkForwarder.h"
+
+MAVLinkForwarder::MAVLinkForwarder() :
+        routeCount(0),
+        nextId(0)
+{
+}
+
+MAVLinkForwarder::~MAVLinkForwarder()
+{
+    QWriteLocker locker(&routeLock);
+    qDeleteAll(routes);
+    routes.clear();
+}
+
+/**
+ * Frames are never forwarded back to the link they were received on,
+ * so two routes in opposite directions bridge two links without loops.
+ */
+int MAVLinkForwarder::addRoute(LinkInterface* source, MAVLinkScheduler* destination, const Filter& filter)
+{
+    if (destination == NULL || source == destination->getLink()) return -1;
+
+    Route* route = new Route();
+    route->source = source;
+    route->destination = destination->getLink();
+    route->scheduler = destination;
+    route->sysid = filter.sysid;
+    route->compid = filter.compid;
+    route->allMessages = filter.msgids.isEmpty();
+    memset(route->msgids, 0, sizeof(route->msgids));
+    foreach (int msgid, filter.msgids)
+    {
+        if (msgid >= 0 && msgid < 256) route->msgids[msgid >> 3] |= (1 << (msgid & 7));
+    }
+    memset(&route->stats, 0, sizeof(route->stats));
+
+    QWriteLocker locker(&routeLock);
+    route->id = nextId++;
+    routes.append(route);
+    routeCount = routes.size();
+    return route->id;
+}
+
+void MAVLinkForwarder::removeRoute(int id)
+{
+    QWriteLocker locker(&routeLock);
+    for (int i = 0; i < routes.size(); i++)
+    {
+        if (routes[i]->id == id)
+        {
+            delete routes.takeAt(i);
+            break;
+        }
+    }
+    routeCount = routes.size();
+}
+
+void MAVLinkForwarder::removeLink(LinkInterface* link)
+{
+    QWriteLocker locker(&routeLock);
+    for (int i = routes.size() - 1; i >= 0; i--)
+    {
+        if (routes[i]->source == link || routes[i]->destination == link)
+        {
+            delete routes.takeAt(i);
+        }
+    }
+    routeCount = routes.size();
+}
+
+QList<int> MAVLinkForwarder::getRoutes()
+{
+    QReadLocker locker(&routeLock);
+    QList<int> ids;
+    foreach (Route* route, routes)
+    {
+        ids.append(route->id);
+    }
+    return ids;
+}
+
+bool MAVLinkForwarder::getStatistics(int id, Statistics* statistics)
+{
+    QReadLocker locker(&routeLock);
+    foreach (Route* route, routes)
+    {
+        if (route->id == id)
+        {
+            QMutexLocker statsLocker(&route->statsMutex);
+            *statistics = route->stats;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MAVLinkForwarder::isEmpty() const
+{
+    return (routeCount == 0);
+}
+
+/**
+ * Called by the decoder thread of the source link for every valid frame.
+ * Without routes this is a single integer comparison. The frame is sent
+ * to all systems on the destination, the scheduler writes it directly or
+ * queues it by the priority of its message id.
+ */
+void MAVLinkForwarder::forward(LinkInterface* source, const mavlink_message_t& message, const char* frame, int length)
+{
+    if (isEmpty() || frame == NULL || length <= 0) return;
+
+    QReadLocker locker(&routeLock);
+    foreach (Route* route, routes)
+    {
+        if (route->source != NULL && route->source != source) continue;
+        if (route->destination == source) continue;
+        if (route->sysid >= 0 && route->sysid != message.sysid) continue;
+        if (route->compid >= 0 && route->compid != message.compid) continue;
+        if (!route->allMessages && !(route->msgids[message.msgid >> 3] & (1 << (message.msgid & 7)))) continue;
+
+        bool connected = route->destination->isConnected();
+        if (connected)
+        {
+            route->scheduler->send(-1, message.msgid, frame, length);
+        }
+
+        QMutexLocker statsLocker(&route->statsMutex);
+        if (connected)
+        {
+            route->stats.frames++;
+            route->stats.bytes += length;
+        }
+        else
+        {
+            route->stats.drops++;
+        }
+    }
+}
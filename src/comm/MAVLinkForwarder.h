@@ -0,0 +1,132 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class MAVLinkForwarder
+ */
+
+#ifndef MAVLINKFORWARDER_H_
+#define MAVLINKFORWARDER_H_
+
+#include <QList>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QAtomicInt>
+#include "LinkInterface.h"
+#include "MAVLinkScheduler.h"
+#include "protocol.h"
+#include "mavlink.h"
+
+/**
+ * @brief Forwards received frames between links
+ *
+ * Turns the groundstation into a hub, e.g. packets received on the serial
+ * radio are passed on to UDP consumers and back. Each route connects a
+ * source link to a destination link and can be limited to a system,
+ * a component and a set of message ids.
+ *
+ * The raw bytes of the received frame are passed to the scheduler of the
+ * destination as they are, the message is neither re-packed nor
+ * checksummed again. Forwarded frames thereby share the priorities and
+ * the rate limit of the destination with the frames of the groundstation,
+ * and the decoder thread never blocks on a slow destination. The decoder
+ * threads of all links forward concurrently, the routes are only read
+ * locked while forwarding.
+ **/
+class MAVLinkForwarder
+{
+public:
+    MAVLinkForwarder();
+    ~MAVLinkForwarder();
+
+    /** @brief Selection of the frames passed on a route, -1 matches any id */
+    struct Filter
+    {
+        Filter() : sysid(-1), compid(-1) {}
+        int sysid;
+        int compid;
+        QList<int> msgids; ///< Empty to forward all messages
+    };
+
+    /** @brief Counters of one route */
+    struct Statistics
+    {
+        quint64 frames;  ///< Frames passed to the scheduler of the destination
+        quint64 bytes;   ///< Bytes passed to the scheduler of the destination
+        quint64 drops;   ///< Frames matching the route while the destination was disconnected
+    };
+
+    /**
+     * @brief Forward frames from one link to another
+     * @param source The link the frames are received on, NULL for all links
+     * @param destination The scheduler of the link to write the frames to
+     * @param filter Selection of the forwarded frames
+     * @return Id of the route, -1 if source and destination are the same link
+     */
+    int addRoute(LinkInterface* source, MAVLinkScheduler* destination, const Filter& filter = Filter());
+    /** @brief Stop forwarding on a route */
+    void removeRoute(int id);
+    /** @brief Remove all routes from or to the link */
+    void removeLink(LinkInterface* link);
+    /** @brief Get the ids of all routes */
+    QList<int> getRoutes();
+    /** @brief Get the counters of a route, returns false if the route does not exist */
+    bool getStatistics(int id, Statistics* statistics);
+    /** @brief Check if any route is configured, does not take a lock */
+    bool isEmpty() const;
+
+    /**
+     * @brief Queue the frame for the destinations of all matching routes
+     * @param source The link the frame was received on
+     * @param message The decoded message, used for filtering only
+     * @param frame Raw bytes of the frame as received
+     * @param length Length of the frame
+     */
+    void forward(LinkInterface* source, const mavlink_message_t& message, const char* frame, int length);
+
+protected:
+    struct Route
+    {
+        int id;
+        LinkInterface* source;
+        LinkInterface* destination;
+        MAVLinkScheduler* scheduler; ///< Scheduler of the destination
+        int sysid;
+        int compid;
+        bool allMessages;
+        quint8 msgids[32];  ///< Bitmap of the forwarded message ids
+        QMutex statsMutex;  ///< Routes can be fed by several decoder threads
+        Statistics stats;
+    };
+
+    QList<Route*> routes;
+    QReadWriteLock routeLock;  ///< Read locked by the decoder threads, write locked to modify the routes
+    QAtomicInt routeCount;     ///< Number of routes, checked before taking the lock
+    int nextId;
+
+private:
+    Q_DISABLE_COPY(MAVLinkForwarder)
+};
+
+#endif // MAVLINKFORWARDER_H_
@@ -0,0 +1,273 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class MAVLinkFrameScanner
+ */
+
+#include <cstring>
+#include "MAVLinkFrameScanner.h"
+
+quint16 MAVLinkFrameScanner::crcTable[256];
+bool MAVLinkFrameScanner::crcTableInitialized = false;
+
+/**
+ * The X.25 CRC of MAVLink is the reflected CCITT polynomial 0x8408,
+ * starting at 0xFFFF without final XOR. The table is equivalent to
+ * eight iterations of crc_accumulate() per byte.
+ */
+void MAVLinkFrameScanner::initCrcTable()
+{
+    for (int i = 0; i < 256; i++)
+    {
+        quint16 crc = i;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 1) ? ((crc >> 1) ^ 0x8408) : (crc >> 1);
+        }
+        crcTable[i] = crc;
+    }
+    crcTableInitialized = true;
+}
+
+MAVLinkFrameScanner::MAVLinkFrameScanner() :
+        data(NULL),
+        length(0),
+        position(0),
+        frame(NULL),
+        frameLength(0),
+        splitLength(0),
+        bulkFrames(0),
+        splitFrames(0),
+        checksumErrors(0)
+{
+    // The table only depends on the polynomial, concurrent
+    // initialization by two scanners writes the same values
+    if (!crcTableInitialized) initCrcTable();
+}
+
+/**
+ * @param data Start of the checksummed bytes, the length byte of the frame
+ * @param length Number of bytes to checksum
+ * @return The checksum, ck_a in the lower and ck_b in the upper byte
+ */
+quint16 MAVLinkFrameScanner::crc(const quint8* data, int length)
+{
+    if (!crcTableInitialized) initCrcTable();
+    quint16 crc = 0xFFFF;
+    for (int i = 0; i < length; i++)
+    {
+        crc = (crc >> 8) ^ crcTable[(crc ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+void MAVLinkFrameScanner::setData(const char* data, int length)
+{
+    this->data = reinterpret_cast<const quint8*>(data);
+    this->length = length;
+    this->position = 0;
+}
+
+bool MAVLinkFrameScanner::next(mavlink_message_t* message)
+{
+    // Finish a frame which started in the previous buffer first
+    if (splitLength > 0)
+    {
+        if (continueSplitFrame(message)) return true;
+        if (splitLength > 0) return false;
+    }
+
+    while (position < length)
+    {
+        const quint8* start = static_cast<const quint8*>(memchr(data + position, MAVLINK_STX, length - position));
+        if (start == NULL)
+        {
+            position = length;
+            return false;
+        }
+        int frameStart = start - data;
+        int available = length - frameStart;
+
+        // The length byte is required to know the extent of the frame
+        if (available < 2)
+        {
+            startSplitFrame(frameStart);
+            return false;
+        }
+        int payloadLength = start[1];
+        int frameLength = payloadLength + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+        if (available < frameLength)
+        {
+            startSplitFrame(frameStart);
+            return false;
+        }
+
+        if (!decodeFrame(start, message))
+        {
+            // Not a valid frame, resynchronize on the next start sign
+            checksumErrors++;
+            position = frameStart + 1;
+            continue;
+        }
+
+        frame = start;
+        this->frameLength = frameLength;
+        position = frameStart + frameLength;
+        bulkFrames++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @param start Start sign of a frame which is completely contained in memory
+ * @param message Returns the decoded message
+ * @return True if the checksum matched and the message was decoded
+ */
+bool MAVLinkFrameScanner::decodeFrame(const quint8* start, mavlink_message_t* message)
+{
+    int payloadLength = start[1];
+    // Checksum covers the core header and the payload, without the start sign
+    quint16 checksum = crc(start + 1, MAVLINK_CORE_HEADER_LEN + payloadLength);
+    const quint8* ck = start + 1 + MAVLINK_CORE_HEADER_LEN + payloadLength;
+    if (ck[0] != (checksum & 0xFF) || ck[1] != (checksum >> 8))
+    {
+        return false;
+    }
+
+    message->len = payloadLength;
+    message->seq = start[2];
+    message->sysid = start[3];
+    message->compid = start[4];
+    message->msgid = start[5];
+    memcpy(message->payload, start + 1 + MAVLINK_CORE_HEADER_LEN, payloadLength);
+    message->ck_a = ck[0];
+    message->ck_b = ck[1];
+    return true;
+}
+
+/**
+ * The bytes from the start sign to the end of the buffer are kept until
+ * the next buffer provides the rest of the frame.
+ *
+ * @param start Position of the start sign in the current buffer
+ */
+void MAVLinkFrameScanner::startSplitFrame(int start)
+{
+    splitLength = length - start;
+    memcpy(splitBuffer, data + start, splitLength);
+    position = length;
+}
+
+/**
+ * Only the first bytes of the split buffer came from earlier buffers, the
+ * others were taken from the current buffer and are scanned there again.
+ *
+ * @param start Number of bytes to drop, the next start sign is searched behind them
+ * @param kept Number of bytes of the split buffer which came from earlier buffers
+ */
+void MAVLinkFrameScanner::resyncSplitFrame(int start, int kept)
+{
+    const quint8* next = NULL;
+    if (start < kept)
+    {
+        next = static_cast<const quint8*>(memchr(splitBuffer + start, MAVLINK_STX, kept - start));
+    }
+    if (next == NULL)
+    {
+        splitLength = 0;
+        return;
+    }
+    splitLength = kept - (next - splitBuffer);
+    memmove(splitBuffer, next, splitLength);
+}
+
+/**
+ * Exactly the missing bytes of the split frame are taken from the current
+ * buffer. If the completed frame is invalid, the scan continues behind its
+ * start sign: a start sign among the bytes kept from earlier buffers begins
+ * a new split frame, else the scan position is reset to where the split
+ * frame was resumed and the bytes are scanned again by the bulk path.
+ *
+ * @param message Returns the decoded message if the split frame is valid
+ * @return True if a message was decoded
+ */
+bool MAVLinkFrameScanner::continueSplitFrame(mavlink_message_t* message)
+{
+    int resume = position;
+    while (splitLength > 0)
+    {
+        // The length byte is required to know the extent of the frame
+        while (position < length && (splitLength < 2 ||
+               splitLength < splitBuffer[1] + MAVLINK_NUM_NON_PAYLOAD_BYTES))
+        {
+            splitBuffer[splitLength++] = data[position++];
+        }
+        // Wait for the next buffer if the frame is still incomplete
+        if (splitLength < 2) return false;
+        int frameLength = splitBuffer[1] + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+        if (splitLength < frameLength) return false;
+
+        int kept = splitLength - (position - resume);
+        if (decodeFrame(splitBuffer, message))
+        {
+            memcpy(frameBuffer, splitBuffer, frameLength);
+            frame = frameBuffer;
+            this->frameLength = frameLength;
+            splitFrames++;
+            // A frame shorter than the one started first can end among the
+            // kept bytes, the bytes behind it are scanned with the next call
+            resyncSplitFrame(frameLength, kept);
+            return true;
+        }
+
+        // The start sign was noise or payload, resynchronize behind it
+        checksumErrors++;
+        position = resume;
+        resyncSplitFrame(1, kept);
+    }
+    return false;
+}
+
+const char* MAVLinkFrameScanner::getFrame(int* length) const
+{
+    *length = frameLength;
+    return reinterpret_cast<const char*>(frame);
+}
+
+quint64 MAVLinkFrameScanner::getBulkFrames() const
+{
+    return bulkFrames;
+}
+
+quint64 MAVLinkFrameScanner::getSplitFrames() const
+{
+    return splitFrames;
+}
+
+quint64 MAVLinkFrameScanner::getChecksumErrors() const
+{
+    return checksumErrors;
+}
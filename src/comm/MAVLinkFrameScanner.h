@@ -0,0 +1,114 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class MAVLinkFrameScanner
+ */
+
+#ifndef MAVLINKFRAMESCANNER_H_
+#define MAVLINKFRAMESCANNER_H_
+
+#include <QtGlobal>
+#include "protocol.h"
+#include "mavlink.h"
+
+/**
+ * @brief Bulk MAVLink decoder working on whole buffers
+ *
+ * Instead of running the byte-wise state machine of mavlink_parse_char(),
+ * the scanner searches the start sign with memchr(), checks the length of
+ * the frame against the remaining buffer and calculates the checksum over
+ * the complete frame with a table-driven X.25 CRC.
+ *
+ * Frames split across buffers are collected in a buffer of the scanner
+ * until the length byte says they are complete, exactly their bytes are
+ * taken from the next buffer and checked like a bulk frame. If the split
+ * frame turns out to be invalid, e.g. because its start sign was noise,
+ * the scan resumes at the byte behind that start sign, first among the
+ * bytes kept from earlier buffers, then in the current buffer, like the
+ * byte-wise parser resynchronizes.
+ **/
+class MAVLinkFrameScanner
+{
+public:
+    MAVLinkFrameScanner();
+
+    /** @brief Set the next buffer to scan, the buffer has to stay valid while calling next() */
+    void setData(const char* data, int length);
+    /**
+     * @brief Decode the next message of the current buffer
+     * @param message Returns the decoded message
+     * @return True if a message was decoded, false if the buffer is exhausted
+     */
+    bool next(mavlink_message_t* message);
+
+    /**
+     * @brief Get the raw bytes of the message last returned by next()
+     *
+     * Frames decoded in bulk point into the current buffer, split frames
+     * into a copy kept by the scanner. The bytes stay valid until the
+     * next call of next() or setData().
+     *
+     * @param length Returns the frame length including start sign and checksum
+     */
+    const char* getFrame(int* length) const;
+
+    /** @brief Calculate the X.25 checksum as used by MAVLink */
+    static quint16 crc(const quint8* data, int length);
+
+    /** @brief Number of frames decoded with the bulk path */
+    quint64 getBulkFrames() const;
+    /** @brief Number of frames split across buffers */
+    quint64 getSplitFrames() const;
+    /** @brief Number of frames dropped due to a checksum mismatch */
+    quint64 getChecksumErrors() const;
+
+protected:
+    const quint8* data;       ///< Current buffer
+    int length;               ///< Length of the current buffer
+    int position;             ///< Scan position in the current buffer
+    const quint8* frame;      ///< Raw bytes of the last decoded frame
+    int frameLength;          ///< Length of the last decoded frame
+    quint8 splitBuffer[255 + MAVLINK_NUM_NON_PAYLOAD_BYTES]; ///< Raw bytes of the split frame
+    int splitLength;          ///< Bytes collected in the split buffer, 0 if no frame is split
+    quint8 frameBuffer[255 + MAVLINK_NUM_NON_PAYLOAD_BYTES]; ///< Copy of the last decoded split frame
+    quint64 bulkFrames;
+    quint64 splitFrames;
+    quint64 checksumErrors;
+
+    /** @brief Check the checksum of a complete frame and decode it, returns false if it is invalid */
+    static bool decodeFrame(const quint8* start, mavlink_message_t* message);
+    /** @brief Complete the split frame from the current buffer, returns true if it decoded a message */
+    bool continueSplitFrame(mavlink_message_t* message);
+    /** @brief Keep the start of a frame reaching beyond the end of the buffer */
+    void startSplitFrame(int start);
+    /** @brief Drop the first bytes of the split buffer and keep the rest from the next start sign on */
+    void resyncSplitFrame(int start, int kept);
+
+    static quint16 crcTable[256]; ///< Lookup table of the X.25 CRC
+    static bool crcTableInitialized;
+    static void initCrcTable();
+};
+
+#endif // MAVLINKFRAMESCANNER_H_
@@ -0,0 +1,306 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class MAVLinkLogReader
+ */
+
+#include <cstring>
+#include <QtEndian>
+#include <QList>
+#include "MAVLinkLogReader.h"
+
+/* Packets are read in blocks of this size */
+static const int READ_BLOCK_SIZE = 64 * 1024;
+static const quint64 SCAN_CHECKPOINT_INTERVAL = 1000000;
+
+MAVLinkLogReader::MAVLinkLogReader() :
+        file(),
+        bufferPosition(0),
+        bufferOffset(0),
+        startTime(0),
+        endTime(0),
+        indexed(false)
+{
+}
+
+MAVLinkLogReader::~MAVLinkLogReader()
+{
+    close();
+}
+
+/**
+ * @param fileName The log to open
+ * @return False if the file can not be read or is not a packet log
+ */
+bool MAVLinkLogReader::open(const QString& fileName)
+{
+    close();
+    file.setFileName(fileName);
+    // Reads are done in blocks or exactly sized, no extra buffering needed
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) return false;
+    QByteArray header = file.read(MAVLinkLogWriter::FILE_HEADER_LENGTH);
+    if (header.size() != MAVLinkLogWriter::FILE_HEADER_LENGTH || !MAVLinkLogWriter::isLogHeader(header.constData()))
+    {
+        file.close();
+        return false;
+    }
+
+    indexed = loadIndex();
+    if (!indexed) scanIndex();
+
+    rewind();
+    quint64 time;
+    char frame[MAVLINK_MAX_PACKET_LEN];
+    if (readPacket(&time, frame) > 0) startTime = time;
+    if (endTime < startTime) endTime = startTime;
+    return rewind();
+}
+
+void MAVLinkLogReader::close()
+{
+    if (file.isOpen()) file.close();
+    buffer.clear();
+    bufferPosition = 0;
+    bufferOffset = 0;
+    index.clear();
+    startTime = 0;
+    endTime = 0;
+    indexed = false;
+}
+
+bool MAVLinkLogReader::isOpen() const
+{
+    return file.isOpen();
+}
+
+quint64 MAVLinkLogReader::getStartTime() const
+{
+    return startTime;
+}
+
+quint64 MAVLinkLogReader::getEndTime() const
+{
+    return endTime;
+}
+
+int MAVLinkLogReader::getIndexSize() const
+{
+    return index.size() / 2;
+}
+
+bool MAVLinkLogReader::isIndexed() const
+{
+    return indexed;
+}
+
+bool MAVLinkLogReader::setOffset(qint64 offset)
+{
+    buffer.resize(0);
+    bufferPosition = 0;
+    bufferOffset = offset;
+    return file.seek(offset);
+}
+
+bool MAVLinkLogReader::fill(int length)
+{
+    if (buffer.size() - bufferPosition >= length) return true;
+    // Move the unread bytes to the front and append the next block
+    buffer.remove(0, bufferPosition);
+    bufferOffset += bufferPosition;
+    bufferPosition = 0;
+    buffer.append(file.read(qMax(READ_BLOCK_SIZE, length - buffer.size())));
+    return buffer.size() >= length;
+}
+
+/**
+ * @param type Returns the record type
+ * @param time Returns the record time
+ * @param payload Returns the payload, valid until the next read
+ * @param length Returns the payload length
+ * @return False at the end of the file or if the last record is incomplete
+ */
+bool MAVLinkLogReader::readRecord(quint8* type, quint64* time, const char** payload, int* length)
+{
+    if (!fill(MAVLinkLogWriter::RECORD_HEADER_LENGTH)) return false;
+    const uchar* header = reinterpret_cast<const uchar*>(buffer.constData()) + bufferPosition;
+    int payloadLength = qFromLittleEndian<quint16>(header + 1);
+    if (!fill(MAVLinkLogWriter::RECORD_HEADER_LENGTH + payloadLength)) return false;
+    // The buffer might have been moved
+    header = reinterpret_cast<const uchar*>(buffer.constData()) + bufferPosition;
+    *type = header[0];
+    *time = qFromLittleEndian<quint64>(header + 3);
+    *payload = reinterpret_cast<const char*>(header) + MAVLinkLogWriter::RECORD_HEADER_LENGTH;
+    *length = payloadLength;
+    bufferPosition += MAVLinkLogWriter::RECORD_HEADER_LENGTH + payloadLength;
+    return true;
+}
+
+int MAVLinkLogReader::readPacket(quint64* time, char* frame)
+{
+    quint8 type;
+    const char* payload;
+    int length;
+    while (readRecord(&type, time, &payload, &length))
+    {
+        if (type == MAVLinkLogWriter::RECORD_PACKET && length > 0 && length <= MAVLINK_MAX_PACKET_LEN)
+        {
+            memcpy(frame, payload, length);
+            return length;
+        }
+    }
+    return 0;
+}
+
+/**
+ * The index records are read with exactly sized reads, so only a few
+ * bytes per index record are read from disk.
+ *
+ * @return False if the log has no valid end record or index chain
+ */
+bool MAVLinkLogReader::loadIndex()
+{
+    const qint64 size = file.size();
+    if (size < MAVLinkLogWriter::FILE_HEADER_LENGTH + MAVLinkLogWriter::END_RECORD_LENGTH) return false;
+    file.seek(size - MAVLinkLogWriter::END_RECORD_LENGTH);
+    QByteArray end = file.read(MAVLinkLogWriter::END_RECORD_LENGTH);
+    const uchar* data = reinterpret_cast<const uchar*>(end.constData());
+    if (end.size() != MAVLinkLogWriter::END_RECORD_LENGTH || data[0] != MAVLinkLogWriter::RECORD_END ||
+        qFromLittleEndian<quint16>(data + 1) != sizeof(quint64))
+    {
+        return false;
+    }
+    quint64 last = qFromLittleEndian<quint64>(data + 3);
+    quint64 offset = qFromLittleEndian<quint64>(data + MAVLinkLogWriter::RECORD_HEADER_LENGTH);
+
+    // Walk the chain backwards, the records are collected latest first
+    QList<QByteArray> records;
+    while (offset != 0)
+    {
+        if (offset < static_cast<quint64>(MAVLinkLogWriter::FILE_HEADER_LENGTH) || offset >= static_cast<quint64>(size)) return false;
+        file.seek(offset);
+        QByteArray header = file.read(MAVLinkLogWriter::RECORD_HEADER_LENGTH);
+        if (header.size() != MAVLinkLogWriter::RECORD_HEADER_LENGTH) return false;
+        data = reinterpret_cast<const uchar*>(header.constData());
+        int length = qFromLittleEndian<quint16>(data + 1);
+        if (data[0] != MAVLinkLogWriter::RECORD_INDEX || length < static_cast<int>(sizeof(quint64)) ||
+            (length - sizeof(quint64)) % (2 * sizeof(quint64)) != 0)
+        {
+            return false;
+        }
+        QByteArray payload = file.read(length);
+        if (payload.size() != length) return false;
+        quint64 previous = qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(payload.constData()));
+        // The chain only points backwards
+        if (previous >= offset) return false;
+        records.prepend(payload);
+        offset = previous;
+    }
+
+    index.clear();
+    foreach (const QByteArray& record, records)
+    {
+        const uchar* entry = reinterpret_cast<const uchar*>(record.constData()) + sizeof(quint64);
+        const uchar* recordEnd = reinterpret_cast<const uchar*>(record.constData()) + record.size();
+        for (; entry < recordEnd; entry += sizeof(quint64))
+        {
+            index.append(qFromLittleEndian<quint64>(entry));
+        }
+    }
+    endTime = last;
+    return true;
+}
+
+/**
+ * Fallback for logs which were not closed properly. All records are read
+ * once and a checkpoint is taken every second.
+ */
+void MAVLinkLogReader::scanIndex()
+{
+    index.clear();
+    setOffset(MAVLinkLogWriter::FILE_HEADER_LENGTH);
+    quint64 nextCheckpoint = 0;
+    quint8 type;
+    quint64 time;
+    const char* payload;
+    int length;
+    qint64 offset = bufferOffset + bufferPosition;
+    while (readRecord(&type, &time, &payload, &length))
+    {
+        if (type == MAVLinkLogWriter::RECORD_PACKET)
+        {
+            if (time >= nextCheckpoint)
+            {
+                index.append(time);
+                index.append(offset);
+                nextCheckpoint = time + SCAN_CHECKPOINT_INTERVAL;
+            }
+            endTime = time;
+        }
+        offset = bufferOffset + bufferPosition;
+    }
+}
+
+/**
+ * Starts reading at the last checkpoint before the time and skips the
+ * packets logged before it.
+ *
+ * @param time Time in microseconds since epoch
+ * @return False if no packet was logged at or after the time
+ */
+bool MAVLinkLogReader::seek(quint64 time)
+{
+    // Find the last checkpoint at or before the time
+    int low = 0;
+    int high = index.size() / 2;
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (index.at(2 * middle) <= time) low = middle + 1;
+        else high = middle;
+    }
+    qint64 offset = (low > 0) ? index.at(2 * (low - 1) + 1) : MAVLinkLogWriter::FILE_HEADER_LENGTH;
+    if (!setOffset(offset)) return false;
+
+    quint8 type;
+    quint64 recordTime;
+    const char* payload;
+    int length;
+    while (true)
+    {
+        offset = bufferOffset + bufferPosition;
+        if (!readRecord(&type, &recordTime, &payload, &length)) return false;
+        if (type == MAVLinkLogWriter::RECORD_PACKET && recordTime >= time)
+        {
+            // Step back to the start of this packet, it is still buffered
+            bufferPosition = offset - bufferOffset;
+            return true;
+        }
+    }
+}
+
+bool MAVLinkLogReader::rewind()
+{
+    return setOffset(MAVLinkLogWriter::FILE_HEADER_LENGTH);
+}
@@ -0,0 +1,105 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class MAVLinkLogReader
+ */
+
+#ifndef MAVLINKLOGREADER_H_
+#define MAVLINKLOGREADER_H_
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+#include "MAVLinkLogWriter.h"
+
+/**
+ * @brief Sequential reader for binary packet logs
+ *
+ * Reads logs in the format written by MAVLinkLogWriter. When the log is
+ * opened, its time index is loaded by following the index records back
+ * from the end record, without touching the packets. Logs without an end
+ * record are scanned once by their record lengths instead.
+ *
+ * The packets are read from the file in large blocks and returned as
+ * complete MAVLink frames.
+ **/
+class MAVLinkLogReader
+{
+public:
+    MAVLinkLogReader();
+    ~MAVLinkLogReader();
+
+    /** @brief Open a log and load its index */
+    bool open(const QString& fileName);
+    /** @brief Close the log */
+    void close();
+    /** @brief Check if a log is open */
+    bool isOpen() const;
+
+    /**
+     * @brief Read the next packet
+     * @param time Returns the time the packet was logged in microseconds since epoch
+     * @param frame Returns the MAVLink frame, has to hold MAVLINK_MAX_PACKET_LEN bytes
+     * @return Length of the frame, 0 at the end of the log
+     */
+    int readPacket(quint64* time, char* frame);
+    /** @brief Position the reader at the first packet logged at or after the time */
+    bool seek(quint64 time);
+    /** @brief Position the reader at the first packet */
+    bool rewind();
+
+    /** @brief Time of the first packet */
+    quint64 getStartTime() const;
+    /** @brief Time of the last indexed packet */
+    quint64 getEndTime() const;
+    /** @brief Number of checkpoints in the time index */
+    int getIndexSize() const;
+    /** @brief True if the index was loaded from the index records, false if it was scanned */
+    bool isIndexed() const;
+
+protected:
+    QFile file;               ///< The log
+    QByteArray buffer;        ///< Block read from the file
+    int bufferPosition;       ///< Read position in the block
+    qint64 bufferOffset;      ///< File offset of the start of the block
+    QVector<quint64> index;   ///< Pairs of time and file offset, sorted by time
+    quint64 startTime;        ///< Time of the first packet
+    quint64 endTime;          ///< Time of the last indexed packet
+    bool indexed;             ///< True if the index records were found
+
+    /** @brief Set the read position to a file offset */
+    bool setOffset(qint64 offset);
+    /** @brief Make sure length bytes are buffered, returns false at the end of the file */
+    bool fill(int length);
+    /** @brief Read the next record of any type, payload points into the buffer */
+    bool readRecord(quint8* type, quint64* time, const char** payload, int* length);
+    /** @brief Load the index by following the index records */
+    bool loadIndex();
+    /** @brief Build the index by scanning all records */
+    void scanIndex();
+};
+
+#endif // MAVLINKLOGREADER_H_
@@ -0,0 +1,304 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class MAVLinkLogWriter
+ */
+
+#include <cstring>
+#include <QDebug>
+#include <QMutexLocker>
+#include <QMetaObject>
+#include <QtEndian>
+#include "MAVLinkLogWriter.h"
+
+/* Records are written to disk in blocks of at least this size, or
+ * at the latest after FLUSH_INTERVAL milliseconds */
+static const int FLUSH_THRESHOLD = 256 * 1024;
+static const int FLUSH_INTERVAL = 200;
+static const quint64 CHECKPOINT_INTERVAL = 1000000;
+static const char LOG_MAGIC[] = "QGCTLOG";
+
+MAVLinkLogWriter::MAVLinkLogWriter() :
+        worker(new QThread()),
+        flushTimer(new QTimer(this)),
+        file(),
+        notified(0),
+        opened(false),
+        offset(0),
+        bytesWritten(0),
+        lastIndexOffset(0),
+        nextCheckpoint(0),
+        nextIndex(0),
+        lastTime(0),
+        indexInterval(10 * 1000000ULL)
+{
+    pending.reserve(2 * FLUSH_THRESHOLD);
+    writing.reserve(2 * FLUSH_THRESHOLD);
+    connect(flushTimer, SIGNAL(timeout()), this, SLOT(flush()));
+    // The timer is a child and moves with the writer
+    moveToThread(worker);
+    worker->start(QThread::LowPriority);
+}
+
+MAVLinkLogWriter::~MAVLinkLogWriter()
+{
+    close();
+    worker->quit();
+    worker->wait();
+    delete worker;
+}
+
+bool MAVLinkLogWriter::isLogHeader(const char* header)
+{
+    return memcmp(header, LOG_MAGIC, sizeof(LOG_MAGIC) - 1) == 0;
+}
+
+/**
+ * Blocks until the file has been opened by the writer thread. An existing
+ * file has to be a log of this format, its index chain is continued.
+ *
+ * @param fileName The name of the log file
+ * @return True if the file could be opened
+ */
+bool MAVLinkLogWriter::open(const QString& fileName)
+{
+    close();
+    bool success = false;
+    QMetaObject::invokeMethod(this, "openFile", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, success), Q_ARG(QString, fileName));
+    return success;
+}
+
+/**
+ * Blocks until all records have been written.
+ */
+void MAVLinkLogWriter::close()
+{
+    if (isOpen())
+    {
+        QMetaObject::invokeMethod(this, "closeFile", Qt::BlockingQueuedConnection);
+    }
+}
+
+bool MAVLinkLogWriter::isOpen()
+{
+    QMutexLocker locker(&bufferMutex);
+    return opened;
+}
+
+/**
+ * @param seconds Log time between two index records, the index gets
+ *                one checkpoint per second in between. Limited to one
+ *                hour, so an index record stays below the maximum
+ *                record length.
+ */
+void MAVLinkLogWriter::setIndexInterval(int seconds)
+{
+    QMutexLocker locker(&bufferMutex);
+    indexInterval = qBound(1, seconds, 3600) * 1000000ULL;
+}
+
+qint64 MAVLinkLogWriter::getBytesWritten()
+{
+    QMutexLocker locker(&bufferMutex);
+    return bytesWritten;
+}
+
+/**
+ * Only appends the frame to the buffer of the writer, the disk is never
+ * accessed from the calling thread.
+ *
+ * @param time Receive time in microseconds since epoch
+ * @param message The message to log
+ */
+void MAVLinkLogWriter::log(quint64 time, const mavlink_message_t& message)
+{
+    char frame[MAVLINK_MAX_PACKET_LEN];
+    int length = mavlink_msg_to_send_buffer(reinterpret_cast<uint8_t*>(frame), &message);
+
+    bufferMutex.lock();
+    if (!opened)
+    {
+        bufferMutex.unlock();
+        return;
+    }
+    if (nextIndex == 0)
+    {
+        nextIndex = time + indexInterval;
+    }
+    else if (time >= nextIndex)
+    {
+        appendIndex(time);
+        nextIndex = time + indexInterval;
+    }
+    if (time >= nextCheckpoint)
+    {
+        checkpoints.append(time);
+        checkpoints.append(offset);
+        nextCheckpoint = time + CHECKPOINT_INTERVAL;
+    }
+    appendRecord(RECORD_PACKET, time, frame, length);
+    lastTime = time;
+    bool full = pending.size() >= FLUSH_THRESHOLD;
+    bufferMutex.unlock();
+
+    // Request a write once per filled buffer
+    if (full && notified.testAndSetOrdered(0, 1))
+    {
+        QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+    }
+}
+
+void MAVLinkLogWriter::appendRecord(RecordType type, quint64 time, const char* data, int length)
+{
+    uchar header[RECORD_HEADER_LENGTH];
+    header[0] = static_cast<uchar>(type);
+    qToLittleEndian<quint16>(length, header + 1);
+    qToLittleEndian<quint64>(time, header + 3);
+    pending.append(reinterpret_cast<const char*>(header), RECORD_HEADER_LENGTH);
+    pending.append(data, length);
+    offset += RECORD_HEADER_LENGTH + length;
+}
+
+void MAVLinkLogWriter::appendIndex(quint64 time)
+{
+    if (checkpoints.isEmpty()) return;
+    QByteArray index(sizeof(quint64) * (1 + checkpoints.size()), 0);
+    uchar* data = reinterpret_cast<uchar*>(index.data());
+    qToLittleEndian<quint64>(lastIndexOffset, data);
+    for (int i = 0; i < checkpoints.size(); i++)
+    {
+        qToLittleEndian<quint64>(checkpoints.at(i), data + sizeof(quint64) * (i + 1));
+    }
+    lastIndexOffset = offset;
+    appendRecord(RECORD_INDEX, time, index.constData(), index.size());
+    checkpoints.clear();
+}
+
+bool MAVLinkLogWriter::openFile(const QString& fileName)
+{
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadWrite))
+    {
+        qDebug() << "Could not open packet log" << fileName << file.errorString();
+        return false;
+    }
+
+    qint64 previousIndex = 0;
+    if (file.size() == 0)
+    {
+        char header[FILE_HEADER_LENGTH];
+        memcpy(header, LOG_MAGIC, sizeof(LOG_MAGIC) - 1);
+        header[FILE_HEADER_LENGTH - 1] = FORMAT_VERSION;
+        file.write(header, FILE_HEADER_LENGTH);
+    }
+    else
+    {
+        // Never append to a file of another format
+        QByteArray header = file.read(FILE_HEADER_LENGTH);
+        if (header.size() != FILE_HEADER_LENGTH || !isLogHeader(header.constData()))
+        {
+            qDebug() << "Not appending to" << fileName << "as it is no packet log";
+            file.close();
+            return false;
+        }
+        // Continue the index chain of the previous session
+        if (file.size() >= FILE_HEADER_LENGTH + END_RECORD_LENGTH)
+        {
+            file.seek(file.size() - END_RECORD_LENGTH);
+            QByteArray end = file.read(END_RECORD_LENGTH);
+            const uchar* data = reinterpret_cast<const uchar*>(end.constData());
+            if (end.size() == END_RECORD_LENGTH && data[0] == RECORD_END &&
+                qFromLittleEndian<quint16>(data + 1) == sizeof(quint64))
+            {
+                previousIndex = qFromLittleEndian<quint64>(data + RECORD_HEADER_LENGTH);
+            }
+        }
+        file.seek(file.size());
+    }
+
+    QMutexLocker locker(&bufferMutex);
+    pending.resize(0);
+    checkpoints.clear();
+    offset = file.pos();
+    bytesWritten = 0;
+    lastIndexOffset = previousIndex;
+    nextCheckpoint = 0;
+    nextIndex = 0;
+    lastTime = 0;
+    opened = true;
+    flushTimer->start(FLUSH_INTERVAL);
+    return true;
+}
+
+void MAVLinkLogWriter::closeFile()
+{
+    bufferMutex.lock();
+    if (!opened)
+    {
+        bufferMutex.unlock();
+        return;
+    }
+    // Index the last checkpoints and point the end record to the index
+    appendIndex(lastTime);
+    uchar end[sizeof(quint64)];
+    qToLittleEndian<quint64>(lastIndexOffset, end);
+    appendRecord(RECORD_END, lastTime, reinterpret_cast<const char*>(end), sizeof(end));
+    opened = false;
+    bufferMutex.unlock();
+
+    flushTimer->stop();
+    flush();
+    file.close();
+}
+
+/**
+ * Executed in the writer thread. The buffers are swapped, so the
+ * decoders continue to log while the records are written.
+ */
+void MAVLinkLogWriter::flush()
+{
+    notified.fetchAndStoreOrdered(0);
+    bufferMutex.lock();
+    qSwap(pending, writing);
+    bufferMutex.unlock();
+
+    if (writing.isEmpty()) return;
+    qint64 written = 0;
+    if (file.isOpen())
+    {
+        written = file.write(writing);
+        file.flush();
+        if (written != writing.size())
+        {
+            qDebug() << "Packet log" << file.fileName() << "truncated:" << file.errorString();
+        }
+    }
+
+    bufferMutex.lock();
+    if (written > 0) bytesWritten += written;
+    bufferMutex.unlock();
+    // Keep the capacity for the next swap
+    writing.resize(0);
+}
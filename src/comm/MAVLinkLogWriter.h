@@ -0,0 +1,141 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class MAVLinkLogWriter
+ */
+
+#ifndef MAVLINKLOGWRITER_H_
+#define MAVLINKLOGWRITER_H_
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QFile>
+#include <QTimer>
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+#include <QAtomicInt>
+#include "protocol.h"
+#include "mavlink.h"
+
+/**
+ * @brief Binary telemetry log writer
+ *
+ * Packets are logged as complete MAVLink frames. Each frame goes into a
+ * length-framed and timestamped record. The calling thread only appends
+ * the record to an in-memory buffer. A background thread writes the
+ * buffer to disk in large blocks, either periodically or once the buffer
+ * reaches a threshold.
+ *
+ * All values are little endian. The file starts with an 8 byte header,
+ * the 7 byte magic "QGCTLOG" followed by the format version as one byte.
+ * Records follow, each with an 11 byte header:
+ *
+ * - quint8 type, see RecordType
+ * - quint16 payload length
+ * - quint64 time in microseconds since epoch
+ *
+ * The writer records a checkpoint (time, offset of the record) every
+ * second. Every index interval it writes the collected checkpoints as an
+ * index record. Each index record points back to the previous one, and
+ * closing the log appends an end record pointing to the last index. A
+ * reader can therefore load the complete time index from the end of the
+ * file without scanning the packets. If the end record is missing, e.g.
+ * after a crash, the records can still be scanned by their length.
+ **/
+class MAVLinkLogWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum RecordType {
+        RECORD_PACKET = 0, ///< Payload is one complete MAVLink frame
+        RECORD_INDEX = 1,  ///< Payload is the quint64 offset of the previous index record (0 if none), followed by (quint64 time, quint64 offset) checkpoints
+        RECORD_END = 2     ///< Payload is the quint64 offset of the last index record
+    };
+    enum {
+        FILE_HEADER_LENGTH = 8,    ///< Length of magic and version
+        RECORD_HEADER_LENGTH = 11, ///< Length of type, length and time of a record
+        END_RECORD_LENGTH = 19,    ///< Length of the complete end record
+        FORMAT_VERSION = 1
+    };
+
+    MAVLinkLogWriter();
+    ~MAVLinkLogWriter();
+
+    /** @brief Open the log, new packets are appended if it already exists */
+    bool open(const QString& fileName);
+    /** @brief Write the index and the end record, close the log */
+    void close();
+    /** @brief Check if the log is open */
+    bool isOpen();
+    /** @brief Set the interval between index records in seconds */
+    void setIndexInterval(int seconds);
+    /** @brief Number of bytes written to disk since the log was opened */
+    qint64 getBytesWritten();
+
+    /** @brief Check the magic of the file header */
+    static bool isLogHeader(const char* header);
+
+    /** @brief Log a message, can be called from any thread */
+    void log(quint64 time, const mavlink_message_t& message);
+
+protected slots:
+    /** @brief Open the file in the writer thread */
+    bool openFile(const QString& fileName);
+    /** @brief Close the file in the writer thread */
+    void closeFile();
+    /** @brief Write the buffered records to disk */
+    void flush();
+
+protected:
+    QThread* worker;            ///< Thread writing to disk
+    QTimer* flushTimer;         ///< Triggers periodic writes
+    QFile file;                 ///< Log file, only accessed by the writer thread
+    QMutex bufferMutex;         ///< Protects the buffer and the index state
+    QByteArray pending;         ///< Records not yet written to disk
+    QByteArray writing;         ///< Records being written to disk, swapped with pending
+    QAtomicInt notified;        ///< 1 if a flush has been requested and not yet executed
+    bool opened;                ///< True if records are accepted
+    qint64 offset;              ///< File offset at the end of the pending records
+    qint64 bytesWritten;        ///< Bytes written since opening
+    qint64 lastIndexOffset;     ///< Offset of the last index record, 0 if none
+    quint64 nextCheckpoint;     ///< Time of the next checkpoint
+    quint64 nextIndex;          ///< Time of the next index record, 0 if not yet set
+    quint64 lastTime;           ///< Time of the last logged packet
+    quint64 indexInterval;      ///< Time between index records in microseconds
+    QVector<quint64> checkpoints; ///< Pairs of time and offset since the last index record
+
+    /** @brief Append a record to the pending buffer, has to be called with the buffer locked */
+    void appendRecord(RecordType type, quint64 time, const char* data, int length);
+    /** @brief Append the collected checkpoints as index record, has to be called with the buffer locked */
+    void appendIndex(quint64 time);
+
+private:
+    Q_DISABLE_COPY(MAVLinkLogWriter)
+};
+
+#endif // MAVLINKLOGWRITER_H_
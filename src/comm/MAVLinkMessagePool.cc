@@ -0,0 +1,136 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the pool of received messages
+ *
+ */
+
+#include <QMutexLocker>
+#include "MAVLinkMessagePool.h"
+
+void MAVLinkMessageHandle::release()
+{
+    if (block != NULL && !block->ref.deref())
+    {
+        block->pool->free(block);
+    }
+    block = NULL;
+}
+
+MAVLinkMessagePool::MAVLinkMessagePool(int size) :
+        blocks(new MAVLinkMessageBlock[size]),
+        freeBlocks(new int[size]),
+        freeCount(size),
+        size(size),
+        used(0),
+        highWaterMark(0),
+        acquired(0),
+        heapAllocations(0)
+{
+    for (int i = 0; i < size; i++)
+    {
+        blocks[i].pool = this;
+        blocks[i].index = i;
+        // Hand out the low blocks first, the upper part of the arena
+        // is only touched under load
+        freeBlocks[i] = size - 1 - i;
+    }
+}
+
+/**
+ * All handles have to be destroyed before the pool.
+ */
+MAVLinkMessagePool::~MAVLinkMessagePool()
+{
+    delete[] blocks;
+    delete[] freeBlocks;
+}
+
+/**
+ * @param link The link the message was received on
+ * @param message The message to copy
+ * @return Handle holding the only reference to the copy
+ */
+MAVLinkMessageHandle MAVLinkMessagePool::acquire(LinkInterface* link, const mavlink_message_t& message)
+{
+    MAVLinkMessageBlock* block = NULL;
+    mutex.lock();
+    acquired++;
+    used++;
+    if (used > highWaterMark) highWaterMark = used;
+    if (freeCount > 0)
+    {
+        block = &blocks[freeBlocks[--freeCount]];
+    }
+    else
+    {
+        heapAllocations++;
+    }
+    mutex.unlock();
+
+    if (block == NULL)
+    {
+        block = new MAVLinkMessageBlock();
+        block->pool = this;
+        block->index = -1;
+    }
+    block->ref = 1;
+    block->link = link;
+    block->message = message;
+    return MAVLinkMessageHandle(block);
+}
+
+void MAVLinkMessagePool::free(MAVLinkMessageBlock* block)
+{
+    mutex.lock();
+    used--;
+    if (block->index >= 0)
+    {
+        freeBlocks[freeCount++] = block->index;
+        block = NULL;
+    }
+    mutex.unlock();
+    delete block;
+}
+
+MAVLinkMessagePool::Statistics MAVLinkMessagePool::getStatistics()
+{
+    QMutexLocker locker(&mutex);
+    Statistics s;
+    s.size = size;
+    s.used = used;
+    s.highWaterMark = highWaterMark;
+    s.acquired = acquired;
+    s.heapAllocations = heapAllocations;
+    return s;
+}
+
+void MAVLinkMessagePool::resetStatistics()
+{
+    QMutexLocker locker(&mutex);
+    highWaterMark = used;
+    acquired = 0;
+    heapAllocations = 0;
+}
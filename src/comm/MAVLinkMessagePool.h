@@ -0,0 +1,151 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the pool of received messages
+ *
+ */
+
+#ifndef MAVLINKMESSAGEPOOL_H_
+#define MAVLINKMESSAGEPOOL_H_
+
+#include <QMutex>
+#include <QAtomicInt>
+#include <QMetaType>
+#include "LinkInterface.h"
+#include "protocol.h"
+#include "mavlink.h"
+
+class MAVLinkMessagePool;
+
+/** @brief Storage of one pooled message */
+struct MAVLinkMessageBlock
+{
+    QAtomicInt ref;              ///< Number of handles to this block
+    MAVLinkMessagePool* pool;    ///< Pool to return the block to
+    int index;                   ///< Index in the arena, -1 if allocated on the heap
+    LinkInterface* link;         ///< Link the message was received on
+    mavlink_message_t message;
+};
+
+/**
+ * @brief Shared, immutable reference to a received message
+ *
+ * Copying a handle only increments the reference count of the message,
+ * the message itself is never copied. The message returns to its pool
+ * when the last handle is destroyed, in whichever thread that happens.
+ **/
+class MAVLinkMessageHandle
+{
+public:
+    MAVLinkMessageHandle() : block(NULL) {}
+    MAVLinkMessageHandle(const MAVLinkMessageHandle& other) : block(other.block)
+    {
+        if (block) block->ref.ref();
+    }
+    ~MAVLinkMessageHandle()
+    {
+        release();
+    }
+    MAVLinkMessageHandle& operator=(const MAVLinkMessageHandle& other)
+    {
+        if (other.block) other.block->ref.ref();
+        release();
+        block = other.block;
+        return *this;
+    }
+
+    bool isNull() const { return block == NULL; }
+    /** @brief The message, only valid if the handle is not null */
+    const mavlink_message_t& message() const { return block->message; }
+    /** @brief The link the message was received on */
+    LinkInterface* link() const { return block->link; }
+
+protected:
+    /** @brief Adopt a block holding one reference for this handle */
+    explicit MAVLinkMessageHandle(MAVLinkMessageBlock* block) : block(block) {}
+    /** @brief Drop the reference of this handle */
+    void release();
+
+    MAVLinkMessageBlock* block;
+
+    friend class MAVLinkMessagePool;
+};
+
+Q_DECLARE_METATYPE(MAVLinkMessageHandle)
+
+/**
+ * @brief Preallocated arena of received messages
+ *
+ * The decoders put every message which has to be delivered to other
+ * threads into a block of the arena once, and pass handles around
+ * instead of copies. Free blocks are kept on a stack, so taking and
+ * returning a block does not allocate. Only if all blocks are in use,
+ * further blocks are allocated on the heap and counted.
+ **/
+class MAVLinkMessagePool
+{
+public:
+    /** @param size Number of preallocated blocks */
+    MAVLinkMessagePool(int size = 4096);
+    ~MAVLinkMessagePool();
+
+    /** @brief Usage of the pool */
+    struct Statistics
+    {
+        int size;                ///< Preallocated blocks
+        int used;                ///< Blocks currently referenced
+        int highWaterMark;       ///< Most blocks referenced at once
+        quint64 acquired;        ///< Messages put into the pool in total
+        quint64 heapAllocations; ///< Messages which had to be allocated on the heap
+    };
+
+    /** @brief Copy a message into a free block, can be called from any thread */
+    MAVLinkMessageHandle acquire(LinkInterface* link, const mavlink_message_t& message);
+    /** @brief Get the usage of the pool */
+    Statistics getStatistics();
+    /** @brief Reset the high-water mark and the counters */
+    void resetStatistics();
+
+protected:
+    MAVLinkMessageBlock* blocks; ///< The arena
+    int* freeBlocks;             ///< Stack of the indices of the free blocks
+    int freeCount;               ///< Number of free blocks on the stack
+    int size;
+    QMutex mutex;                ///< Protects the stack and the counters
+    int used;
+    int highWaterMark;
+    quint64 acquired;
+    quint64 heapAllocations;
+
+    /** @brief Return a block no longer referenced */
+    void free(MAVLinkMessageBlock* block);
+
+    friend class MAVLinkMessageHandle;
+
+private:
+    Q_DISABLE_COPY(MAVLinkMessagePool)
+};
+
+#endif // MAVLINKMESSAGEPOOL_H_
@@ -31,11 +31,13 @@ This file is part of the QGROUNDCONTROL project
 #include <iostream>
 
 #include <QDebug>
+#include <QMutexLocker>
 #include <QTime>
-#include <QApplication>
+#include <QCoreApplication>
 
 #include "MG.h"
 #include "MAVLinkProtocol.h"
+#include "MAVLinkDecoder.h"
 #include "UASInterface.h"
 #include "UASManager.h"
 #include "UASInterface.h"
@@ -57,8 +59,15 @@ MAVLinkProtocol::MAVLinkProtocol() :
         heartbeatRate(MAVLINK_HEARTBEAT_DEFAULT_RATE),
         m_heartbeatsEnabled(false),
         m_loggingEnabled(false),
-        m_logfile(NULL)
+        m_streamRateControlEnabled(false),
+        streamRateTarget(80),
+        logWriter(new MAVLinkLogWriter()),
+        statistics(new MAVLinkStatistics(this))
 {
+    // Messages are emitted from the decoder threads of the links
+    qRegisterMetaType<mavlink_message_t>("mavlink_message_t");
+    qRegisterMetaType<LinkInterface*>("LinkInterface*");
+    qRegisterMetaType<MAVLinkMessageHandle>("MAVLinkMessageHandle");
     start(QThread::LowPriority);
     // Start heartbeat timer, emitting a heartbeat at the configured rate
     connect(heartbeatTimer, SIGNAL(timeout()), this, SLOT(sendHeartbeat()));
@@ -67,22 +76,30 @@ MAVLinkProtocol::MAVLinkProtocol() :
     totalLossCounter = 0;
     currReceiveCounter = 0;
     currLossCounter = 0;
-    for (int i = 0; i < 256; i++)
-    {
-        for (int j = 0; j < 256; j++)
-        {
-            lastIndex[i][j] = -1;
-        }
-    }
 }
 
 MAVLinkProtocol::~MAVLinkProtocol()
 {
-    if (m_logfile)
-    {
-        m_logfile->close();
-        delete m_logfile;
-    }
+    // Stop all decoder threads before the logfile is closed
+    decoderMutex.lock();
+    qDeleteAll(decoders);
+    decoders.clear();
+    decoderMutex.unlock();
+
+    // Frames still queued for sending are discarded
+    schedulerMutex.lock();
+    qDeleteAll(schedulers);
+    schedulers.clear();
+    schedulerMutex.unlock();
+
+    // Release the messages still queued before the pool is destroyed
+    subscriberLock.lockForWrite();
+    qDeleteAll(subscribers);
+    subscribers.clear();
+    subscriberLock.unlock();
+
+    // Writes the pending packets and the index
+    delete logWriter;
 }
 
 
@@ -94,190 +111,397 @@ void MAVLinkProtocol::run()
 
 QString MAVLinkProtocol::getLogfileName()
 {
-    return QCoreApplication::applicationDirPath()+"/mavlink.log";
+    return QCoreApplication::applicationDirPath()+"/mavlink.tlog";
 }
 
 /**
- * The bytes are copied by calling the LinkInterface::readBytes() method.
- * This method parses all incoming bytes and constructs a MAVLink packet.
- * It can handle multiple links in parallel, as each link has it's own buffer/
- * parsing state machine.
- * @param link The interface to read from
+ * The bytes are handed to the decoder of the link, which parses them in its
+ * own thread. This method is called directly from the thread of the link and
+ * does not parse itself, so links do not have to wait for each other.
+ * Each link has it's own buffer/parsing state machine.
+ * @param link The interface the bytes were read from
+ * @param b The received bytes
  * @see LinkInterface
  **/
 void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
 {
-    receiveMutex.lock();
-    mavlink_message_t message;
-    mavlink_status_t status;
-    for (int position = 0; position < b.size(); position++)
+    QMetaObject::invokeMethod(getDecoder(link), "receiveBytes", Qt::QueuedConnection, Q_ARG(QByteArray, b));
+}
+
+/**
+ * Links supporting it write their bytes directly into the receive ring
+ * of their decoder. No signal is emitted and no memory is allocated
+ * per read then.
+ *
+ * @param link The link to attach
+ * @return True if the link writes into the ring, false if it has to
+ *         be connected to receiveBytes()
+ **/
+bool MAVLinkProtocol::attachLink(LinkInterface* link)
+{
+    return getDecoder(link)->attach();
+}
+
+/**
+ * The ring reports its high-water mark and overruns, which can be used
+ * to size it for high-rate links.
+ *
+ * @param link The link to get the ring for
+ * @return The receive ring or NULL if no bytes were received on this link yet
+ **/
+LinkRingBuffer* MAVLinkProtocol::getReceiveBuffer(LinkInterface* link)
+{
+    QMutexLocker locker(&decoderMutex);
+    MAVLinkDecoder* decoder = decoders.value(link->getId(), NULL);
+    if (decoder == NULL) return NULL;
+    return decoder->getReceiveBuffer();
+}
+
+/**
+ * Routes are removed automatically when one of the links is deleted.
+ *
+ * @param source The link the frames are received on, NULL for all links
+ * @param destination The link to forward the frames to, they are sent through its scheduler
+ * @param filter Selection of the forwarded frames
+ * @return Id of the route in the forwarder, -1 if the route is invalid
+ */
+int MAVLinkProtocol::addForwardingRoute(LinkInterface* source, LinkInterface* destination, const MAVLinkForwarder::Filter& filter)
+{
+    if (destination == NULL) return -1;
+    int id = forwarder.addRoute(source, getScheduler(destination), filter);
+    if (id >= 0)
     {
-        unsigned int decodeState = mavlink_parse_char(link->getId(), (uint8_t)(b.at(position)), &message, &status);
+        if (source) connect(source, SIGNAL(destroyed(QObject*)), this, SLOT(removeForwardingRoutes(QObject*)));
+        connect(destination, SIGNAL(destroyed(QObject*)), this, SLOT(removeForwardingRoutes(QObject*)));
+    }
+    return id;
+}
+
+MAVLinkForwarder* MAVLinkProtocol::getForwarder()
+{
+    return &forwarder;
+}
+
+MAVLinkStatistics* MAVLinkProtocol::getStatistics()
+{
+    return statistics;
+}
+
+MAVLinkDeduplicator* MAVLinkProtocol::getDeduplicator()
+{
+    return &deduplicator;
+}
+
+MAVLinkMessagePool* MAVLinkProtocol::getMessagePool()
+{
+    return &pool;
+}
 
-        if (decodeState == 1)
+/**
+ * The receiver gets the messages of all systems the UAS objects exist for,
+ * in its own thread and in the order they were received. A slot taking a
+ * MAVLinkMessageHandle shares the pooled message with all other receivers,
+ * it must not keep the handle beyond the lifetime of the protocol.
+ *
+ * @param receiver The object to deliver the messages to
+ * @param member Signature of the slot, e.g. "receiveMessage(MAVLinkMessageHandle)"
+ */
+bool MAVLinkProtocol::subscribe(QObject* receiver, const char* member)
+{
+    if (receiver == NULL) return false;
+    int index = receiver->metaObject()->indexOfMethod(QMetaObject::normalizedSignature(member));
+    if (index < 0) return false;
+    QMetaMethod method = receiver->metaObject()->method(index);
+    if (!MAVLinkSubscriber::isSupported(method)) return false;
+
+    MAVLinkSubscriber* subscriber = new MAVLinkSubscriber(receiver, method);
+    subscriberLock.lockForWrite();
+    subscribers.append(subscriber);
+    subscriberCount.fetchAndStoreOrdered(subscribers.size());
+    subscriberLock.unlock();
+    connect(receiver, SIGNAL(destroyed(QObject*)), this, SLOT(unsubscribe(QObject*)), Qt::DirectConnection);
+    return true;
+}
+
+/**
+ * Messages still queued for the receiver are dropped.
+ *
+ * @param receiver The subscribed object
+ */
+void MAVLinkProtocol::unsubscribe(QObject* receiver)
+{
+    subscriberLock.lockForWrite();
+    for (int i = subscribers.size() - 1; i >= 0; i--)
+    {
+        // A deleted receiver already reads as NULL, it is removed as well
+        QObject* current = subscribers[i]->getReceiver();
+        if (current == receiver || current == NULL)
         {
-            // Log data
-            if (m_loggingEnabled)
-            {
-                uint8_t buf[MAVLINK_MAX_PACKET_LEN];
-                quint64 time = MG::TIME::getGroundTimeNowUsecs();
-                memcpy(buf, (void*)&time, sizeof(quint64));
-                mavlink_msg_to_send_buffer(buf+sizeof(quint64), &message);
-                m_logfile->write((const char*) buf);
-                qDebug() << "WROTE LOGFILE";
-            }
-
-            // ORDER MATTERS HERE!
-            // If the matching UAS object does not yet exist, it has to be created
-            // before emitting the packetReceived signal
-            UASInterface* uas = UASManager::instance()->getUASForId(message.sysid);
-
-            // Check and (if necessary) create UAS object
-            if (uas == NULL && message.msgid == MAVLINK_MSG_ID_HEARTBEAT)
-            {
-                // ORDER MATTERS HERE!
-                // The UAS object has first to be created and connected,
-                // only then the rest of the application can be made aware
-                // of its existence, as it only then can send and receive
-                // it's first messages.
-
-                // FIXME Current debugging
-                // check if the UAS has the same id like this system
-                if (message.sysid == getSystemId())
-                {
-                    qDebug() << "WARNING\nWARNING\nWARNING\nWARNING\nWARNING\nWARNING\nWARNING\n\n RECEIVED MESSAGE FROM THIS SYSTEM WITH ID" << message.msgid << "FROM COMPONENT" << message.compid;
-                }
-
-                // Create a new UAS based on the heartbeat received
-                // Todo dynamically load plugin at run-time for MAV
-                // WIKISEARCH:AUTOPILOT_TYPE_INSTANTIATION
-
-                // First create new UAS object
-                // Decode heartbeat message
-                mavlink_heartbeat_t heartbeat;
-                mavlink_msg_heartbeat_decode(&message, &heartbeat);
-                switch (heartbeat.autopilot)
-                {
-                case MAV_AUTOPILOT_GENERIC:
-                    uas = new UAS(this, message.sysid);
-                    // Connect this robot to the UAS object
-                    connect(this, SIGNAL(messageReceived(LinkInterface*, mavlink_message_t)), uas, SLOT(receiveMessage(LinkInterface*, mavlink_message_t)));
-                    break;
-                case MAV_AUTOPILOT_PIXHAWK:
-                    {
-                    // Fixme differentiate between quadrotor and coaxial here
-                    PxQuadMAV* mav = new PxQuadMAV(this, message.sysid);
-                    // Connect this robot to the UAS object
-                    // it is IMPORTANT here to use the right object type,
-                    // else the slot of the parent object is called (and thus the special
-                    // packets never reach their goal)
-                    connect(this, SIGNAL(messageReceived(LinkInterface*, mavlink_message_t)), mav, SLOT(receiveMessage(LinkInterface*, mavlink_message_t)));
-                    uas = mav;
-                }
-                    break;
-                case MAV_AUTOPILOT_SLUGS:
-                    {
-                    SlugsMAV* mav = new SlugsMAV(this, message.sysid);
-                    // Connect this robot to the UAS object
-                    // it is IMPORTANT here to use the right object type,
-                    // else the slot of the parent object is called (and thus the special
-                    // packets never reach their goal)
-                    connect(this, SIGNAL(messageReceived(LinkInterface*, mavlink_message_t)), mav, SLOT(receiveMessage(LinkInterface*, mavlink_message_t)));
-                    uas = mav;
-                }
-                    break;
-                case MAV_AUTOPILOT_ARDUPILOT:
-                    {
-                    ArduPilotMAV* mav = new ArduPilotMAV(this, message.sysid);
-                    // Connect this robot to the UAS object
-                    // it is IMPORTANT here to use the right object type,
-                    // else the slot of the parent object is called (and thus the special
-                    // packets never reach their goal)
-                    connect(this, SIGNAL(messageReceived(LinkInterface*, mavlink_message_t)), mav, SLOT(receiveMessage(LinkInterface*, mavlink_message_t)));
-                    uas = mav;
-                }
-                    break;
-                default:
-                    uas = new UAS(this, message.sysid);
-                    break;
-                }
-
-
-                // Make UAS aware that this link can be used to communicate with the actual robot
-                uas->addLink(link);
-                // Now add UAS to "official" list, which makes the whole application aware of it
-                UASManager::instance()->addUAS(uas);
-            }
-
-            // Only count message if UAS exists for this message
-            if (uas != NULL)
-            {
-                // Increase receive counter
-                totalReceiveCounter++;
-                currReceiveCounter++;
-                qint64 lastLoss = totalLossCounter;
-                // Update last packet index
-                if (lastIndex[message.sysid][message.compid] == -1)
-                {
-                    lastIndex[message.sysid][message.compid] = message.seq;
-                }
-                else
-                {
-                    if (lastIndex[message.sysid][message.compid] == 255)
-                    {
-                        lastIndex[message.sysid][message.compid] = 0;
-                    }
-                    else
-                    {
-                        lastIndex[message.sysid][message.compid]++;
-                    }
-
-                    int safeguard = 0;
-                    //qDebug() << "SYSID" << message.sysid << "COMPID" << message.compid << "MSGID" << message.msgid << "LASTINDEX" << lastIndex[message.sysid][message.compid] << "SEQ" << message.seq;
-                    while(lastIndex[message.sysid][message.compid] != message.seq && safeguard < 255)
-                    {
-                        if (lastIndex[message.sysid][message.compid] == 255)
-                        {
-                            lastIndex[message.sysid][message.compid] = 0;
-                        }
-                        else
-                        {
-                            lastIndex[message.sysid][message.compid]++;
-                        }
-                        totalLossCounter++;
-                        currLossCounter++;
-                        safeguard++;
-                    }
-                }
-                //            if (lastIndex.contains(message.sysid))
-                //            {
-                //                QMap<int, int>* lastCompIndex = lastIndex.value(message.sysid);
-                //                if (lastCompIndex->contains(message.compid))
-                //                while (lastCompIndex->value(message.compid, 0)+1 )
-                //            }
-                //if ()
-
-                // If a new loss was detected or we just hit one 128th packet step
-                if (lastLoss != totalLossCounter || (totalReceiveCounter == 128))
-                {
-                    // Calculate new loss ratio
-                    // Receive loss
-                    float receiveLoss = (double)currLossCounter/(double)(currReceiveCounter+currLossCounter);
-                    receiveLoss *= 100.0f;
-                    // qDebug() << "LOSSCHANGED" << receiveLoss;
-                    currLossCounter = 0;
-                    currReceiveCounter = 0;
-                    emit receiveLossChanged(message.sysid, receiveLoss);
-                }
-
-                // The packet is emitted as a whole, as it is only 255 - 261 bytes short
-                // kind of inefficient, but no issue for a groundstation pc.
-                // It buys as reentrancy for the whole code over all threads
-                emit messageReceived(link, message);
-            }
+            // A delivery might be pending in the thread of the receiver
+            subscribers.takeAt(i)->deleteLater();
         }
     }
-    receiveMutex.unlock();
+    subscriberCount.fetchAndStoreOrdered(subscribers.size());
+    subscriberLock.unlock();
+}
+
+QList<MAVLinkSubscriber*> MAVLinkProtocol::getSubscribers()
+{
+    QReadLocker locker(&subscriberLock);
+    return subscribers;
+}
+
+void MAVLinkProtocol::removeForwardingRoutes(QObject* link)
+{
+    // Only the address is compared, the link is already destroyed
+    forwarder.removeLink(static_cast<LinkInterface*>(link));
+}
+
+/**
+ * All messages sent by the protocol and the UAS objects pass the scheduler
+ * of their link, which orders them by priority and limits them to the
+ * capacity of the link.
+ *
+ * @param link The link to send on
+ * @return The scheduler of the link
+ */
+MAVLinkScheduler* MAVLinkProtocol::getScheduler(LinkInterface* link)
+{
+    QMutexLocker locker(&schedulerMutex);
+    MAVLinkScheduler* scheduler = schedulers.value(link, NULL);
+    if (scheduler == NULL)
+    {
+        scheduler = new MAVLinkScheduler(link, statistics);
+        schedulers.insert(link, scheduler);
+        connect(link, SIGNAL(destroyed(QObject*)), this, SLOT(removeScheduler(QObject*)), Qt::DirectConnection);
+    }
+    return scheduler;
+}
+
+QList<MAVLinkScheduler*> MAVLinkProtocol::getSchedulers()
+{
+    QMutexLocker locker(&schedulerMutex);
+    return schedulers.values();
+}
+
+void MAVLinkProtocol::removeScheduler(QObject* link)
+{
+    // Only the address is compared, the link is already destroyed. The
+    // routes to the link are removed first, so no decoder thread forwards
+    // to the deleted scheduler.
+    forwarder.removeLink(static_cast<LinkInterface*>(link));
+    schedulerMutex.lock();
+    MAVLinkScheduler* scheduler = schedulers.take(static_cast<LinkInterface*>(link));
+    schedulerMutex.unlock();
+    delete scheduler;
+}
+
+MAVLinkDecoder* MAVLinkProtocol::getDecoder(LinkInterface* link)
+{
+    QMutexLocker locker(&decoderMutex);
+    MAVLinkDecoder* decoder = decoders.value(link->getId(), NULL);
+    if (decoder == NULL)
+    {
+        decoder = new MAVLinkDecoder(this, link);
+        decoders.insert(link->getId(), decoder);
+    }
+    return decoder;
+}
+
+/**
+ * This method is called from the decoder thread of the link the message
+ * arrived on. All state shared between links is protected.
+ *
+ * @param link The link the message was received on
+ * @param message The decoded message
+ **/
+void MAVLinkProtocol::handleMessage(LinkInterface* link, const mavlink_message_t& message, int lost)
+{
+    // Log data, the writer only buffers the packet
+    if (m_loggingEnabled)
+    {
+        logWriter->log(MG::TIME::getGroundTimeNowUsecs(), message);
+    }
+
+    // ORDER MATTERS HERE!
+    // If the matching UAS object does not yet exist, it has to be created
+    // before emitting the packetReceived signal
+    QObject* uas = dispatcher.getReceiver(message.sysid);
+
+    // Check and (if necessary) create UAS object
+    if (uas == NULL && message.msgid == MAVLINK_MSG_ID_HEARTBEAT)
+    {
+        // The UAS object has to live in the main thread, the
+        // heartbeat is delivered once it has been created there
+        QMetaObject::invokeMethod(this, "createUAS", Qt::QueuedConnection, Q_ARG(LinkInterface*, link), Q_ARG(mavlink_message_t, message));
+    }
+
+    // Only count message if UAS exists for this message
+    if (uas != NULL)
+    {
+        updateLoss(message, lost);
+
+        // The packet is copied once into the pool and only queued to
+        // the UAS owning the system id and the subscribers, other
+        // systems never see it. The handle is immutable, which buys
+        // reentrancy for the whole code over all threads
+        MAVLinkMessageHandle handle = pool.acquire(link, message);
+        dispatcher.dispatch(handle);
+        publish(handle);
+    }
+}
+
+/**
+ * Called from the decoder threads and on the creation of a system.
+ *
+ * @param handle The pooled message
+ */
+void MAVLinkProtocol::publish(const MAVLinkMessageHandle& handle)
+{
+    if (subscriberCount > 0)
+    {
+        QReadLocker locker(&subscriberLock);
+        foreach (MAVLinkSubscriber* subscriber, subscribers)
+        {
+            subscriber->post(handle);
+        }
+    }
+    if (receivers(SIGNAL(messageReceived(LinkInterface*, mavlink_message_t))) > 0)
+    {
+        emit messageReceived(handle.link(), handle.message());
+    }
+}
+
+/**
+ * Duplicates are not processed, but the UAS has to know every link it is
+ * heard on to send over all of them. It is told once per link.
+ *
+ * @param link The link the duplicate was received on
+ * @param message The duplicate
+ */
+void MAVLinkProtocol::handleDuplicate(LinkInterface* link, const mavlink_message_t& message)
+{
+    QObject* uas = dispatcher.getReceiver(message.sysid);
+    if (uas == NULL) return;
+
+    qint64 key = ((qint64)message.sysid << 32) | (quint32)link->getId();
+    QMutexLocker locker(&redundantMutex);
+    if (redundantLinks.contains(key)) return;
+    redundantLinks.insert(key);
+    QMetaObject::invokeMethod(uas, "addLink", Qt::QueuedConnection, Q_ARG(LinkInterface*, link));
+}
+
+/**
+ * The sequence numbers are tracked per system and component by the
+ * statistics, independent of the link the message arrived on.
+ *
+ * @param message The decoded message
+ * @param lost Number of packets of the component missing before this one
+ **/
+void MAVLinkProtocol::updateLoss(const mavlink_message_t& message, int lost)
+{
+    QMutexLocker locker(&lossMutex);
+    // Increase receive counter
+    totalReceiveCounter++;
+    currReceiveCounter++;
+    totalLossCounter += lost;
+    currLossCounter += lost;
+
+    // If a new loss was detected or we just hit one 128th packet step
+    if (lost > 0 || (totalReceiveCounter == 128))
+    {
+        // Calculate new loss ratio
+        // Receive loss
+        float receiveLoss = (double)currLossCounter/(double)(currReceiveCounter+currLossCounter);
+        receiveLoss *= 100.0f;
+        currLossCounter = 0;
+        currReceiveCounter = 0;
+        emit receiveLossChanged(message.sysid, receiveLoss);
+    }
+}
+
+/**
+ * Executed in the main thread, as the UAS objects and their timers
+ * have to live there. Several decoders might have requested the same
+ * system in the meantime, so the existence is checked again.
+ *
+ * @param link The link the heartbeat arrived on
+ * @param message The heartbeat message
+ **/
+void MAVLinkProtocol::createUAS(LinkInterface* link, mavlink_message_t message)
+{
+    UASInterface* uas = UASManager::instance()->getUASForId(message.sysid);
+    if (uas != NULL) return;
+
+    // ORDER MATTERS HERE!
+    // The UAS object has first to be created and connected,
+    // only then the rest of the application can be made aware
+    // of its existence, as it only then can send and receive
+    // it's first messages.
+
+    // FIXME Current debugging
+    // check if the UAS has the same id like this system
+    if (message.sysid == getSystemId())
+    {
+        qDebug() << "WARNING\nWARNING\nWARNING\nWARNING\nWARNING\nWARNING\nWARNING\n\n RECEIVED MESSAGE FROM THIS SYSTEM WITH ID" << message.msgid << "FROM COMPONENT" << message.compid;
+    }
+
+    // Create a new UAS based on the heartbeat received
+    // Todo dynamically load plugin at run-time for MAV
+    // WIKISEARCH:AUTOPILOT_TYPE_INSTANTIATION
+
+    // First create new UAS object
+    // Decode heartbeat message
+    mavlink_heartbeat_t heartbeat;
+    mavlink_msg_heartbeat_decode(&message, &heartbeat);
+    switch (heartbeat.autopilot)
+    {
+    case MAV_AUTOPILOT_GENERIC:
+        uas = new UAS(this, message.sysid);
+        break;
+    case MAV_AUTOPILOT_PIXHAWK:
+        // Fixme differentiate between quadrotor and coaxial here
+        uas = new PxQuadMAV(this, message.sysid);
+        break;
+    case MAV_AUTOPILOT_SLUGS:
+        uas = new SlugsMAV(this, message.sysid);
+        break;
+    case MAV_AUTOPILOT_ARDUPILOT:
+        uas = new ArduPilotMAV(this, message.sysid);
+        break;
+    default:
+        uas = new UAS(this, message.sysid);
+        break;
+    }
+
+    // Make UAS aware that this link can be used to communicate with the actual robot
+    uas->addLink(link);
+
+    // Hand the UAS to a worker thread before it is routed, its
+    // subscriber queue and timers have to live in the same thread
+    UASManager::instance()->getWorkerPool()->assign(uas);
+
+    // Route the messages of this system to the UAS object. The slot
+    // is resolved on the actual object type, so the special packets
+    // reach the overridden receiveMessage() of the subclasses
+    dispatcher.addRoute(message.sysid, uas, "receiveMessage(LinkInterface*,mavlink_message_t)");
+    connect(uas, SIGNAL(destroyed(QObject*)), this, SLOT(removeRoute(QObject*)));
+    // Now add UAS to "official" list, which makes the whole application aware of it
+    UASManager::instance()->addUAS(uas);
+
+    // Deliver the heartbeat which triggered the creation
+    updateLoss(message, 0);
+    MAVLinkMessageHandle handle = pool.acquire(link, message);
+    dispatcher.dispatch(handle);
+    publish(handle);
+}
+
+/**
+ * @param uas The UAS object being deleted
+ **/
+void MAVLinkProtocol::removeRoute(QObject* uas)
+{
+    dispatcher.removeRoute(uas);
 }
 
 /**
@@ -308,12 +532,18 @@ void MAVLinkProtocol::sendMessage(mavlink_message_t message)
     // Get all links connected to this unit
     QList<LinkInterface*> links = LinkManager::instance()->getLinksForProtocol(this);
 
+    // Pack the message once, the same frame is written to every link
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    int len = mavlink_msg_to_send_buffer(buffer, &message);
+
     // Emit message on all links that are currently connected
     QList<LinkInterface*>::iterator i;
     for (i = links.begin(); i != links.end(); ++i)
     {
-        sendMessage(*i, message);
-        //qDebug() << __FILE__ << __LINE__ << "SENT MESSAGE OVER" << ((LinkInterface*)*i)->getName() << "LIST SIZE:" << links.size();
+        if ((*i)->isConnected())
+        {
+            getScheduler(*i)->send(-1, message.msgid, (const char*)buffer, len);
+        }
     }
 }
 
@@ -331,7 +561,7 @@ void MAVLinkProtocol::sendMessage(LinkInterface* link, mavlink_message_t message
     if (link->isConnected())
     {
         // Send the portion of the buffer now occupied by the message
-        link->writeBytes((const char*)buffer, len);
+        getScheduler(link)->send(-1, message.msgid, (const char*)buffer, len);
     }
 }
 
@@ -357,20 +587,30 @@ void MAVLinkProtocol::enableHeartbeats(bool enabled)
     emit heartbeatChanged(enabled);
 }
 
+/**
+ * Packets are written to getLogfileName(), appending to a previous log.
+ * If the log can not be opened, logging stays disabled.
+ *
+ * @param enabled true to start binary packet logging, false to stop it
+ */
 void MAVLinkProtocol::enableLogging(bool enabled)
 {
-    if (enabled && !m_loggingEnabled)
+    if (enabled == m_loggingEnabled) return;
+    if (enabled)
     {
-       m_logfile = new QFile(getLogfileName());
-       m_logfile->open(QIODevice::WriteOnly | QIODevice::Append);
+        if (!logWriter->open(getLogfileName()))
+        {
+            emit loggingChanged(false);
+            return;
+        }
+        m_loggingEnabled = true;
     }
     else
     {
-       m_logfile->close();
-       delete m_logfile;
-       m_logfile = NULL;
+        m_loggingEnabled = false;
+        logWriter->close();
     }
-    m_loggingEnabled = enabled;
+    emit loggingChanged(m_loggingEnabled);
 }
 
 bool MAVLinkProtocol::heartbeatsEnabled(void)
@@ -383,6 +623,43 @@ bool MAVLinkProtocol::loggingEnabled(void)
     return m_loggingEnabled;
 }
 
+/**
+ * Each UAS object runs its own controller, this switch applies to all of them.
+ * Disabling the control requests the maximum rate of all streams again.
+ *
+ * @param enabled true to adapt the stream rates to the link capacity
+ */
+void MAVLinkProtocol::enableStreamRateControl(bool enabled)
+{
+    if (enabled == m_streamRateControlEnabled) return;
+    m_streamRateControlEnabled = enabled;
+    emit streamRateControlChanged(enabled);
+}
+
+bool MAVLinkProtocol::streamRateControlEnabled(void)
+{
+    return m_streamRateControlEnabled;
+}
+
+/**
+ * The default target is 80% of the nominal data rate of the link, which
+ * leaves headroom for bursts like parameter and waypoint transfers.
+ *
+ * @param percent target utilization of the link, 10 to 100 percent
+ */
+void MAVLinkProtocol::setStreamRateTarget(int percent)
+{
+    percent = qBound(10, percent, 100);
+    if (percent == streamRateTarget) return;
+    streamRateTarget = percent;
+    emit streamRateTargetChanged(percent);
+}
+
+int MAVLinkProtocol::getStreamRateTarget()
+{
+    return streamRateTarget;
+}
+
 /**
  * The default rate is 1 Hertz.
  *
@@ -32,16 +32,30 @@ This file is part of the QGROUNDCONTROL project
 
 #include <QObject>
 #include <QMutex>
+#include <QReadWriteLock>
+#include <QAtomicInt>
+#include <QList>
 #include <QString>
 #include <QTimer>
-#include <QFile>
 #include <QMap>
+#include <QSet>
 #include <QByteArray>
 #include "ProtocolInterface.h"
 #include "LinkInterface.h"
+#include "MAVLinkMessagePool.h"
+#include "MAVLinkSubscriber.h"
+#include "MAVLinkDispatcher.h"
+#include "MAVLinkForwarder.h"
+#include "MAVLinkStatistics.h"
+#include "MAVLinkScheduler.h"
+#include "MAVLinkDeduplicator.h"
+#include "MAVLinkLogWriter.h"
 #include "protocol.h"
 #include "mavlink.h"
 
+class MAVLinkDecoder;
+class LinkRingBuffer;
+
 /**
  * @brief MAVLink micro air vehicle protocol reference implementation.
  *
@@ -69,12 +83,45 @@ public:
     bool heartbeatsEnabled(void);
     /** @brief Get logging state */
     bool loggingEnabled(void);
+    /** @brief Get the state of the adaptive stream rates */
+    bool streamRateControlEnabled(void);
+    /** @brief Get the link utilization the stream rates are adapted to, in percent */
+    int getStreamRateTarget();
     /** @brief Get the name of the packet log file */
     static QString getLogfileName();
+    /** @brief Let the link write in place into the receive ring of its decoder */
+    bool attachLink(LinkInterface* link);
+    /** @brief Get the receive ring of the link, NULL if the link has no decoder yet */
+    LinkRingBuffer* getReceiveBuffer(LinkInterface* link);
+    /** @brief Forward the raw frames received on one link to another link */
+    int addForwardingRoute(LinkInterface* source, LinkInterface* destination, const MAVLinkForwarder::Filter& filter = MAVLinkForwarder::Filter());
+    /** @brief Get the forwarding engine, e.g. to read the route counters */
+    MAVLinkForwarder* getForwarder();
+    /** @brief Get the receive statistics of all links and components */
+    MAVLinkStatistics* getStatistics();
+    /** @brief Get the duplicate suppression, e.g. to see which of redundant links is fresher */
+    MAVLinkDeduplicator* getDeduplicator();
+    /** @brief Get the pool of the received messages, e.g. to read its usage */
+    MAVLinkMessagePool* getMessagePool();
+    /**
+     * @brief Deliver all received messages of known systems to a slot of the receiver
+     * @param receiver The object to deliver the messages to, in its own thread
+     * @param member Signature of a slot taking (LinkInterface*, mavlink_message_t) or (MAVLinkMessageHandle)
+     * @return False if the receiver has no such slot
+     */
+    bool subscribe(QObject* receiver, const char* member);
+    /** @brief Get the queues of all subscribers */
+    QList<MAVLinkSubscriber*> getSubscribers();
+    /** @brief Get the outbound scheduler of the link, create it if necessary */
+    MAVLinkScheduler* getScheduler(LinkInterface* link);
+    /** @brief Get the outbound schedulers of all links which sent messages */
+    QList<MAVLinkScheduler*> getSchedulers();
 
 public slots:
     /** @brief Receive bytes from a communication interface */
     void receiveBytes(LinkInterface* link, QByteArray b);
+    /** @brief Create the UAS object for a heartbeat of an unknown system */
+    void createUAS(LinkInterface* link, mavlink_message_t message);
     /** @brief Send MAVLink message through serial interface */
     void sendMessage(mavlink_message_t message);
     /** @brief Send MAVLink message through serial interface */
@@ -91,26 +138,73 @@ public slots:
     /** @brief Send an extra heartbeat to all connected units */
     void sendHeartbeat();
 
+    /** @brief Enable/disable adapting the stream rates of all systems to their links */
+    void enableStreamRateControl(bool enabled);
+    /** @brief Set the link utilization the stream rates are adapted to, in percent */
+    void setStreamRateTarget(int percent);
+    /** @brief Stop delivering messages to the receiver, called automatically on its deletion */
+    void unsubscribe(QObject* receiver);
+
 protected:
     QTimer* heartbeatTimer;    ///< Timer to emit heartbeats
     int heartbeatRate;         ///< Heartbeat rate, controls the timer interval
     bool m_heartbeatsEnabled;  ///< Enabled/disable heartbeat emission
     bool m_loggingEnabled;     ///< Enable/disable packet logging
-    QFile* m_logfile;           ///< Logfile
-    QMutex receiveMutex;       ///< Mutex to protect receiveBytes function
-    int lastIndex[256][256];
+    bool m_streamRateControlEnabled; ///< Enable/disable adaptive stream rates
+    int streamRateTarget;      ///< Target link utilization of the adaptive stream rates in percent
+    MAVLinkLogWriter* logWriter; ///< Binary packet log, written by all decoders
+    QMap<int, MAVLinkDecoder*> decoders; ///< One parsing context and thread per link, indexed by link id
+    QMutex decoderMutex;       ///< Mutex to protect the decoder map
+    QMap<LinkInterface*, MAVLinkScheduler*> schedulers; ///< One outbound queue and thread per link
+    QMutex schedulerMutex;     ///< Mutex to protect the scheduler map
+    QMutex lossMutex;          ///< Mutex to protect the loss accounting shared by all links
+    MAVLinkMessagePool pool;   ///< Received messages shared by the UAS and the subscribers, outlives their queues
+    MAVLinkDispatcher dispatcher; ///< Routes each message to the UAS owning its system id
+    QList<MAVLinkSubscriber*> subscribers; ///< Queues of the objects receiving all messages
+    QReadWriteLock subscriberLock; ///< Protects the subscribers, read by all decoders
+    QAtomicInt subscriberCount; ///< Number of subscribers, checked without taking the lock
+    MAVLinkForwarder forwarder;   ///< Passes raw frames on to other links
+    MAVLinkStatistics* statistics; ///< Rates, loss and jitter per link and component
+    MAVLinkDeduplicator deduplicator; ///< Drops packets already received on another link
+    QSet<qint64> redundantLinks; ///< Pairs of system id and link id the UAS was told about
+    QMutex redundantMutex;     ///< Protects the redundant links
     int totalReceiveCounter;
     int totalLossCounter;
     int currReceiveCounter;
     int currLossCounter;
 
+    /** @brief Get the decoder of the link, create it if necessary */
+    MAVLinkDecoder* getDecoder(LinkInterface* link);
+    /** @brief Process one decoded message, called from the decoder thread of the link */
+    void handleMessage(LinkInterface* link, const mavlink_message_t& message, int lost);
+    /** @brief Queue a message to all subscribers */
+    void publish(const MAVLinkMessageHandle& handle);
+    /** @brief Make the UAS aware of a redundant link, called from the decoder thread of the link */
+    void handleDuplicate(LinkInterface* link, const mavlink_message_t& message);
+    /** @brief Update the loss accounting, called from the decoder thread of the link */
+    void updateLoss(const mavlink_message_t& message, int lost);
+
+    friend class MAVLinkDecoder;
+
+protected slots:
+    /** @brief Stop routing messages to a deleted system */
+    void removeRoute(QObject* uas);
+    /** @brief Stop forwarding from or to a deleted link */
+    void removeForwardingRoutes(QObject* link);
+    /** @brief Stop the outbound scheduler of a deleted link */
+    void removeScheduler(QObject* link);
+
 signals:
-    /** @brief Message received and directly copied via signal */
+    /** @brief Message received and directly copied via signal, prefer subscribe() which does not copy per receiver */
     void messageReceived(LinkInterface* link, mavlink_message_t message);
     /** @brief Emitted if heartbeat emission mode is changed */
     void heartbeatChanged(bool heartbeats);
     /** @brief Emitted if logging is started / stopped */
     void loggingChanged(bool enabled);
+    /** @brief Emitted if the adaptive stream rates are enabled / disabled */
+    void streamRateControlChanged(bool enabled);
+    /** @brief Emitted if the target link utilization changed */
+    void streamRateTargetChanged(int percent);
 };
 
 #endif // MAVLINKPROTOCOL_H_
@@ -0,0 +1,275 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the outbound scheduler of a link
+ *
+ */
+
+#include <cmath>
+#include <cstring>
+#include <QMutexLocker>
+#include "MAVLinkScheduler.h"
+#include "protocol.h"
+#include "mavlink.h"
+
+/**
+ * Like the decoders, the scheduler moves itself into its own worker
+ * thread. The bucket starts full enough for two frames.
+ *
+ * @param link The link to write to
+ * @param statistics Accounts the written frames per message id
+ */
+MAVLinkScheduler::MAVLinkScheduler(LinkInterface* link, MAVLinkStatistics* statistics) :
+        link(link),
+        statistics(statistics),
+        worker(new QThread()),
+        timer(new QTimer(this)),
+        queued(0),
+        drainPending(false),
+        rateLimit(0),
+        rate(0),
+        tokens(2 * MAVLINK_MAX_PACKET_LEN),
+        lastRefill(0)
+{
+    memset(counters, 0, sizeof(counters));
+    memset(totalLatency, 0, sizeof(totalLatency));
+    clock.start();
+    timer->setSingleShot(true);
+    connect(timer, SIGNAL(timeout()), this, SLOT(drain()));
+    moveToThread(worker);
+    worker->start(QThread::HighPriority);
+}
+
+/**
+ * Stops the worker thread, frames still queued are discarded.
+ */
+MAVLinkScheduler::~MAVLinkScheduler()
+{
+    worker->quit();
+    worker->wait();
+    delete worker;
+}
+
+MAVLinkScheduler::Priority MAVLinkScheduler::getPriority(int msgid)
+{
+    switch (msgid)
+    {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+    case MAVLINK_MSG_ID_ACTION:
+    case MAVLINK_MSG_ID_SET_MODE:
+        return PRIORITY_SAFETY;
+    case MAVLINK_MSG_ID_LOCAL_POSITION_SETPOINT_SET:
+#ifdef MAVLINK_ENABLED_PIXHAWK_MESSAGES
+    case MAVLINK_MSG_ID_MANUAL_CONTROL:
+    case MAVLINK_MSG_ID_POSITION_CONTROL_SETPOINT_SET:
+#endif
+        return PRIORITY_CONTROL;
+    case MAVLINK_MSG_ID_WAYPOINT:
+    case MAVLINK_MSG_ID_WAYPOINT_ACK:
+    case MAVLINK_MSG_ID_WAYPOINT_COUNT:
+    case MAVLINK_MSG_ID_WAYPOINT_REQUEST:
+    case MAVLINK_MSG_ID_WAYPOINT_REQUEST_LIST:
+    case MAVLINK_MSG_ID_WAYPOINT_SET_CURRENT:
+    case MAVLINK_MSG_ID_WAYPOINT_CLEAR_ALL:
+        return PRIORITY_MISSION;
+    case MAVLINK_MSG_ID_PARAM_SET:
+    case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
+        return PRIORITY_PARAMETERS;
+    default:
+        return PRIORITY_BULK;
+    }
+}
+
+QString MAVLinkScheduler::getPriorityName(int priority)
+{
+    switch (priority)
+    {
+    case PRIORITY_SAFETY:
+        return tr("Safety");
+    case PRIORITY_CONTROL:
+        return tr("Control");
+    case PRIORITY_MISSION:
+        return tr("Mission");
+    case PRIORITY_PARAMETERS:
+        return tr("Parameters");
+    default:
+        return tr("Bulk");
+    }
+}
+
+/**
+ * The frame is copied if it has to be queued, the caller can reuse
+ * its buffer right away.
+ */
+void MAVLinkScheduler::send(int systemId, int msgid, const char* frame, int length)
+{
+    int priority = getPriority(msgid);
+    QMutexLocker locker(&mutex);
+    int now = clock.elapsed();
+    refill(now);
+
+    // Nothing waiting and enough capacity, no need to involve the worker
+    if (queued == 0 && (rate <= 0 || tokens >= length))
+    {
+        if (rate > 0) tokens -= length;
+        write(priority, systemId, msgid, frame, length, 0);
+        return;
+    }
+
+    Statistics& c = counters[priority];
+    if (priority != PRIORITY_SAFETY && queues[priority].size() >= QUEUE_LIMIT)
+    {
+        c.drops++;
+        return;
+    }
+
+    Frame f;
+    f.data = QByteArray(frame, length);
+    f.systemId = systemId;
+    f.msgid = msgid;
+    f.queued = now;
+    queues[priority].enqueue(f);
+    queued++;
+    c.maxDepth = qMax(c.maxDepth, queues[priority].size());
+
+    if (!drainPending)
+    {
+        drainPending = true;
+        QMetaObject::invokeMethod(this, "drain", Qt::QueuedConnection);
+    }
+}
+
+void MAVLinkScheduler::drain()
+{
+    QMutexLocker locker(&mutex);
+    drainPending = false;
+    int wait = writeQueued(clock.elapsed());
+    if (wait > 0)
+    {
+        timer->start(wait);
+    }
+    else
+    {
+        timer->stop();
+    }
+}
+
+/**
+ * The fill rate follows the nominal rate of the link, which may change
+ * e.g. with the baud rate of a serial link. The bucket holds BURST_TIME
+ * of capacity, but at least two frames of maximum length.
+ */
+void MAVLinkScheduler::refill(int now)
+{
+    rate = (rateLimit > 0) ? rateLimit : MAVLinkStatistics::getCapacity(link);
+    if (rate > 0)
+    {
+        double burst = qMax(2.0 * MAVLINK_MAX_PACKET_LEN, rate * BURST_TIME / 1000.0);
+        tokens = qMin(burst, tokens + (now - lastRefill) * rate / 1000.0);
+    }
+    lastRefill = now;
+}
+
+int MAVLinkScheduler::writeQueued(int now)
+{
+    refill(now);
+    while (queued > 0)
+    {
+        int priority = 0;
+        while (queues[priority].isEmpty()) priority++;
+
+        int length = queues[priority].head().data.size();
+        if (rate > 0 && tokens < length)
+        {
+            return qMax(1, (int)ceil((length - tokens) * 1000.0 / rate));
+        }
+
+        Frame f = queues[priority].dequeue();
+        queued--;
+        if (rate > 0) tokens -= length;
+        write(priority, f.systemId, f.msgid, f.data.constData(), length, now - f.queued);
+    }
+    return 0;
+}
+
+void MAVLinkScheduler::write(int priority, int systemId, int msgid, const char* data, int length, int latency)
+{
+    // Frames queued before a disconnect are dropped silently
+    if (link->isConnected())
+    {
+        if (systemId < 0)
+        {
+            link->writeBytes(data, length);
+        }
+        else
+        {
+            link->writeBytesToSystem(systemId, data, length);
+        }
+        statistics->messageSent(link, msgid, length);
+    }
+
+    Statistics& c = counters[priority];
+    c.frames++;
+    c.bytes += length;
+    c.maxLatency = qMax(c.maxLatency, latency);
+    totalLatency[priority] += latency;
+}
+
+LinkInterface* MAVLinkScheduler::getLink()
+{
+    return link;
+}
+
+MAVLinkScheduler::Statistics MAVLinkScheduler::getStatistics(int priority)
+{
+    QMutexLocker locker(&mutex);
+    Statistics s = counters[priority];
+    s.depth = queues[priority].size();
+    s.meanLatency = (s.frames > 0) ? (double)totalLatency[priority] / s.frames : 0;
+    return s;
+}
+
+void MAVLinkScheduler::resetStatistics()
+{
+    QMutexLocker locker(&mutex);
+    for (int i = 0; i < PRIORITY_COUNT; i++)
+    {
+        memset(&counters[i], 0, sizeof(Statistics));
+        counters[i].maxDepth = queues[i].size();
+        totalLatency[i] = 0;
+    }
+}
+
+void MAVLinkScheduler::setRateLimit(double bytesPerSecond)
+{
+    QMutexLocker locker(&mutex);
+    rateLimit = bytesPerSecond;
+}
+
+double MAVLinkScheduler::getRate()
+{
+    QMutexLocker locker(&mutex);
+    return rate;
+}
@@ -0,0 +1,160 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the outbound scheduler of a link
+ *
+ */
+
+#ifndef MAVLINKSCHEDULER_H_
+#define MAVLINKSCHEDULER_H_
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QMutex>
+#include <QQueue>
+#include <QTime>
+#include <QByteArray>
+#include "LinkInterface.h"
+#include "MAVLinkStatistics.h"
+
+/**
+ * @brief Prioritized, rate limited transmission on one link
+ *
+ * Every outgoing frame is assigned a priority class by its message id.
+ * A token bucket filled at the capacity of the link decides when the
+ * next frame may be written. As long as the bucket holds enough bytes
+ * and nothing is queued, a frame is written directly in the thread of
+ * the caller. Otherwise it is queued in its class, and the worker thread
+ * of the scheduler writes the queued frames highest class first as soon
+ * as the bucket allows.
+ *
+ * A safety frame therefore never waits behind other frames, its latency
+ * is bounded by the time the bucket needs to refill for its own length.
+ * Queue depth, drops and latency are recorded per class.
+ **/
+class MAVLinkScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    MAVLinkScheduler(LinkInterface* link, MAVLinkStatistics* statistics);
+    ~MAVLinkScheduler();
+
+    enum Priority
+    {
+        PRIORITY_SAFETY = 0,     ///< Actions, mode changes, heartbeats
+        PRIORITY_CONTROL,        ///< Manual control and setpoints
+        PRIORITY_MISSION,        ///< Waypoint protocol
+        PRIORITY_PARAMETERS,     ///< Parameter protocol
+        PRIORITY_BULK,           ///< Everything else, e.g. stream requests
+        PRIORITY_COUNT
+    };
+
+    enum
+    {
+        QUEUE_LIMIT = 512,       ///< Frames per class before new frames are dropped, safety frames are never dropped
+        BURST_TIME = 20          ///< Milliseconds of link capacity the bucket holds
+    };
+
+    /** @brief Queue statistics of one priority class */
+    struct Statistics
+    {
+        int depth;               ///< Frames currently queued
+        int maxDepth;            ///< Most frames queued at once
+        quint64 frames;          ///< Frames written
+        quint64 bytes;           ///< Bytes written
+        quint64 drops;           ///< Frames dropped because the queue was full
+        int maxLatency;          ///< Longest time a frame was queued, in ms
+        double meanLatency;      ///< Average time a frame was queued, in ms
+    };
+
+    /** @brief Get the priority class of a message id */
+    static Priority getPriority(int msgid);
+    /** @brief Get the name of a priority class */
+    static QString getPriorityName(int priority);
+
+    /**
+     * @brief Write or queue a frame, can be called from any thread
+     * @param systemId The system the frame is addressed to, -1 for all systems on the link
+     * @param msgid The message id of the frame
+     * @param frame The packed frame
+     * @param length The length of the frame
+     */
+    void send(int systemId, int msgid, const char* frame, int length);
+
+    /** @brief Get the link of this scheduler */
+    LinkInterface* getLink();
+    /** @brief Get the queue statistics of a priority class */
+    Statistics getStatistics(int priority);
+    /** @brief Reset the maxima and counters of all classes */
+    void resetStatistics();
+    /** @brief Limit the rate in bytes per second, 0 follows the nominal rate of the link */
+    void setRateLimit(double bytesPerSecond);
+    /** @brief Get the rate the bucket is currently filled at in bytes per second, 0 if unlimited */
+    double getRate();
+
+protected slots:
+    /** @brief Write the queued frames the bucket allows, has to be called in the worker thread */
+    void drain();
+
+protected:
+    /** @brief A queued frame */
+    struct Frame
+    {
+        QByteArray data;
+        int systemId;
+        int msgid;
+        int queued;              ///< Time the frame was queued, ms since start of the scheduler
+    };
+
+    LinkInterface* link;         ///< Link written by this scheduler
+    MAVLinkStatistics* statistics; ///< Accounts the written frames per message id
+    QThread* worker;             ///< Worker thread writing the queued frames
+    QTimer* timer;               ///< Wakes the worker when the bucket has refilled
+    QMutex mutex;                ///< Protects queues, bucket and counters, and orders the writes
+    QQueue<Frame> queues[PRIORITY_COUNT];
+    Statistics counters[PRIORITY_COUNT];
+    quint64 totalLatency[PRIORITY_COUNT];
+    int queued;                  ///< Frames queued in all classes
+    bool drainPending;           ///< A drain() is already queued for the worker
+    double rateLimit;            ///< Configured rate, 0 to follow the link
+    double rate;                 ///< Current fill rate in bytes per second, 0 if unlimited
+    double tokens;               ///< Bytes which may be written now
+    int lastRefill;              ///< Time of the last refill
+    QTime clock;                 ///< Time base of the bucket and the latencies
+
+    /** @brief Add the tokens accumulated since the last refill */
+    void refill(int now);
+    /** @brief Write the queued frames, returns the ms until the next frame may be written or 0 if empty */
+    int writeQueued(int now);
+    /** @brief Write a frame to the link and account it */
+    void write(int priority, int systemId, int msgid, const char* data, int length, int latency);
+
+private:
+    Q_DISABLE_COPY(MAVLinkScheduler)
+};
+
+#endif // MAVLINKSCHEDULER_H_
@@ -57,11 +57,23 @@ This file is part of the QGROUNDCONTROL project
  **/
 MAVLinkSimulationLink::MAVLinkSimulationLink(QString readFile, QString writeFile, int rate) :
         readyBytes(0),
+        maxDataRate(0),
+        sendBudget(0),
+        lastBudgetTime(0),
+        swarmSize(0),
+        swarmPhase(0),
+        swarmHeartbeatPhase(0),
         timeOffset(0)
 {
     this->rate = rate;
     _isConnected = false;
 
+    for (int i = 0; i < STREAM_COUNT; i++)
+    {
+        streamRates[i] = 0;
+        streamPhase[i] = 0;
+    }
+
     onboardParams = QMap<QString, float>();
     onboardParams.insert("PID_ROLL_K_P", 0.5f);
     onboardParams.insert("PID_PITCH_K_P", 0.5f);
@@ -623,6 +635,23 @@ void MAVLinkSimulationLink::mainloop()
         rate1hzCounter = 1;
     }
 
+    // REQUESTED DATA STREAMS
+    // Each stream requested by the groundstation is simulated by raw IMU messages at its rate
+    for (int i = 1; i < STREAM_COUNT; i++)
+    {
+        streamPhase[i] += streamRates[i] * (int)rate;
+        while (streamPhase[i] >= 1000 && streampointer + MAVLINK_MAX_PACKET_LEN < streamlength)
+        {
+            streamPhase[i] -= 1000;
+            mavlink_msg_raw_imu_encode(systemId, componentId, &msg, &rawImuValues);
+            bufferlength = mavlink_msg_to_send_buffer(buffer, &msg);
+            memcpy(stream+streampointer, buffer, bufferlength);
+            streampointer += bufferlength;
+        }
+        // Stream buffer full, skip the missed messages
+        if (streamPhase[i] >= 1000) streamPhase[i] = 0;
+    }
+
     // FULL RATE TASKS
     // Default is 50 Hz
 
@@ -653,6 +682,8 @@ void MAVLinkSimulationLink::mainloop()
     }
     readyBufferMutex.unlock();
 
+    simulateSwarm();
+
     // Increment counters after full main loop
     rate1hzCounter++;
     rate10hzCounter++;
@@ -660,6 +691,68 @@ void MAVLinkSimulationLink::mainloop()
 }
 
 
+/**
+ * The additional vehicles use the system ids following the id of the
+ * simulated MAV and the generic autopilot. Each sends a heartbeat at 1 Hz
+ * and attitude and local position at SWARM_RATE, which loads the vehicle
+ * processing of the groundstation with the traffic of a whole swarm. The
+ * vehicles and the latency of each vehicle thread and of the GUI thread
+ * are shown in the link statistics view.
+ */
+void MAVLinkSimulationLink::simulateSwarm()
+{
+    if (swarmSize == 0) return;
+
+    // Enough room for one heartbeat and one update of every vehicle
+    QByteArray swarm;
+    swarm.reserve(swarmSize * 3 * MAVLINK_MAX_PACKET_LEN);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    mavlink_message_t msg;
+
+    bool heartbeat = false;
+    swarmHeartbeatPhase += (int)rate;
+    if (swarmHeartbeatPhase >= 1000)
+    {
+        swarmHeartbeatPhase = 0;
+        heartbeat = true;
+    }
+    // Updates missed while the main loop was late are skipped
+    bool update = false;
+    swarmPhase += SWARM_RATE * (int)rate;
+    if (swarmPhase >= 1000)
+    {
+        swarmPhase %= 1000;
+        update = true;
+    }
+    if (!heartbeat && !update) return;
+
+    for (int v = 1; v <= swarmSize; v++)
+    {
+        uint8_t sysid = 1 + (systemId - 1 + v) % 254;
+        if (heartbeat)
+        {
+            mavlink_msg_heartbeat_pack(sysid, componentId, &msg, MAV_QUADROTOR, MAV_AUTOPILOT_GENERIC);
+            swarm.append((const char*)buffer, mavlink_msg_to_send_buffer(buffer, &msg));
+        }
+        if (update)
+        {
+            // Every vehicle flies its own circle
+            float phase = MG::TIME::getGroundTimeNow() / 1000.0f + v;
+            mavlink_msg_attitude_pack(sysid, componentId, &msg, 0, 0.1f * sin(phase), 0.1f * cos(phase), phase, 0, 0, 0);
+            swarm.append((const char*)buffer, mavlink_msg_to_send_buffer(buffer, &msg));
+            mavlink_msg_local_position_pack(sysid, componentId, &msg, 0, 10.0f * cos(phase), 10.0f * sin(phase), -5.0f, 0, 0, 0);
+            swarm.append((const char*)buffer, mavlink_msg_to_send_buffer(buffer, &msg));
+        }
+    }
+
+    readyBufferMutex.lock();
+    for (int i = 0; i < swarm.size(); i++)
+    {
+        readyBuffer.enqueue((uint8_t)swarm.at(i));
+    }
+    readyBufferMutex.unlock();
+}
+
 qint64 MAVLinkSimulationLink::bytesAvailable()
 {
     readyBufferMutex.lock();
@@ -767,6 +860,20 @@ void MAVLinkSimulationLink::writeBytes(const char* data, qint64 size)
                   #endif
                 }
                 break;
+            case MAVLINK_MSG_ID_REQUEST_DATA_STREAM:
+                {
+                    mavlink_request_data_stream_t request;
+                    mavlink_msg_request_data_stream_decode(&msg, &request);
+                    // A start request without rate keeps the default rates of the simulated log
+                    if (request.target_system != systemId || request.req_stream_id >= STREAM_COUNT) break;
+                    if (request.start_stop && request.req_message_rate == 0) break;
+                    int streamRate = (request.start_stop) ? request.req_message_rate : 0;
+                    for (int j = 0; j < STREAM_COUNT; j++)
+                    {
+                        if (request.req_stream_id == 0 || request.req_stream_id == j) streamRates[j] = streamRate;
+                    }
+                }
+                break;
 #endif
             case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
                 {
@@ -875,6 +982,23 @@ void MAVLinkSimulationLink::readBytes() {
     qint64 len = maxLength;
     if (maxLength > readyBuffer.size()) len = readyBuffer.size();
 
+    if (maxDataRate > 0)
+    {
+        // Refill the send budget, allowing bursts of at most 100 ms
+        quint64 now = MG::TIME::getGroundTimeNow();
+        double bytesPerMs = maxDataRate / 8.0 / 1000.0;
+        if (lastBudgetTime == 0) lastBudgetTime = now;
+        sendBudget = qMin(sendBudget + (now - lastBudgetTime) * bytesPerMs, bytesPerMs * 100);
+        lastBudgetTime = now;
+
+        // The radio buffers one second of data, newer bytes are lost
+        qint64 bufferSize = maxDataRate / 8;
+        while (readyBuffer.size() > bufferSize) readyBuffer.removeLast();
+
+        if (len > (qint64)sendBudget) len = (qint64)sendBudget;
+        sendBudget -= len;
+    }
+
     for (unsigned int i = 0; i < len; i++)
     {
         *(data + i) = readyBuffer.takeFirst();
@@ -977,7 +1101,32 @@ QString MAVLinkSimulationLink::getName()
     return name;
 }
 
+/**
+ * A throttled simulation behaves like a narrow radio link: data beyond the
+ * rate is queued, and lost once one second of data is waiting.
+ *
+ * @param bitsPerSecond The capacity of the simulated link, 0 to remove the limit
+ */
+void MAVLinkSimulationLink::setMaxDataRate(int bitsPerSecond)
+{
+    readyBufferMutex.lock();
+    maxDataRate = bitsPerSecond;
+    sendBudget = 0;
+    lastBudgetTime = 0;
+    readyBufferMutex.unlock();
+}
+
+/**
+ * @param vehicles Number of vehicles simulated in addition to the MAV of
+ *        this link, limited to SWARM_MAX
+ */
+void MAVLinkSimulationLink::setSwarmSize(int vehicles)
+{
+    swarmSize = qBound(0, vehicles, (int)SWARM_MAX);
+}
+
 qint64 MAVLinkSimulationLink::getNominalDataRate() {
+    if (maxDataRate > 0) return maxDataRate;
     /* 100 Mbit is reasonable fast and sufficient for all embedded applications */
     return 100000000;
 }
@@ -87,6 +87,10 @@ public slots:
     void readBytes();
     void mainloop();
     bool connectLink(bool connect);
+    /** @brief Limit the simulated link to a data rate in bits per second, 0 for no limit */
+    void setMaxDataRate(int bitsPerSecond);
+    /** @brief Simulate additional vehicles on this link, 0 to SWARM_MAX */
+    void setSwarmSize(int vehicles);
 
 
 protected:
@@ -117,6 +121,26 @@ protected:
     int readyBytes;
     QQueue<uint8_t> readyBuffer;
 
+    qint64 maxDataRate;        ///< Simulated capacity in bits per second, 0 if unlimited
+    double sendBudget;         ///< Bytes which may be sent to the groundstation right now
+    quint64 lastBudgetTime;    ///< Time the send budget was last refilled
+
+    enum { STREAM_COUNT = 10 };
+    int streamRates[STREAM_COUNT];  ///< Rates in Hertz requested by the groundstation per stream id
+    int streamPhase[STREAM_COUNT];  ///< Accumulated time per stream until the next message
+
+    enum
+    {
+        SWARM_MAX = 100,     ///< Most additional vehicles
+        SWARM_RATE = 20      ///< Attitude and position rate of each additional vehicle, in Hertz
+    };
+    int swarmSize;             ///< Number of additional vehicles simulated
+    int swarmPhase;            ///< Accumulated time until the next swarm update
+    int swarmHeartbeatPhase;   ///< Accumulated time until the next swarm heartbeat
+
+    /** @brief Generate the messages of the additional vehicles for one main loop */
+    void simulateSwarm();
+
     int id;
     QString name;
     qint64 timeOffset;
@@ -0,0 +1,419 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class MAVLinkStatistics
+ */
+
+#include <cstring>
+#include <QMutexLocker>
+#include "MAVLinkStatistics.h"
+#include "SerialLinkInterface.h"
+
+MAVLinkStatistics::Entry::Entry() :
+        received(NULL),
+        sent(NULL),
+        packets(0),
+        bytes(0),
+        lost(0),
+        lastPackets(0),
+        lastBytes(0),
+        lastLost(0),
+        newest(-1),
+        count(0)
+{
+    counters.lastSeq = -1;
+}
+
+MAVLinkStatistics::Entry::~Entry()
+{
+    delete[] counters.received;
+    delete[] counters.sent;
+    delete[] received;
+    delete[] sent;
+}
+
+void MAVLinkStatistics::Entry::enableMessages()
+{
+    counters.received = new MessageCounters[256];
+    counters.sent = new MessageCounters[256];
+    received = new MessageWindow[256];
+    sent = new MessageWindow[256];
+    memset(received, 0, 256 * sizeof(MessageWindow));
+    memset(sent, 0, 256 * sizeof(MessageWindow));
+}
+
+MAVLinkStatistics::MAVLinkStatistics(QObject* parent) : QObject(parent),
+        lastSample(0),
+        sampleTimer(this)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        systems[i] = NULL;
+    }
+    clock.start();
+    connect(&sampleTimer, SIGNAL(timeout()), this, SLOT(sample()));
+    sampleTimer.start(SAMPLE_INTERVAL);
+}
+
+MAVLinkStatistics::~MAVLinkStatistics()
+{
+    for (int i = 0; i < 256; i++)
+    {
+        System* system = systems[i];
+        if (system == NULL) continue;
+        for (int j = 0; j < 256; j++)
+        {
+            delete (Entry*)system->components[j];
+        }
+        delete system;
+    }
+    qDeleteAll(links);
+}
+
+MAVLinkStatistics::Entry* MAVLinkStatistics::getLinkEntry(LinkInterface* link)
+{
+    QMutexLocker locker(&linkMutex);
+    Entry* entry = links.value(link->getId(), NULL);
+    if (entry == NULL)
+    {
+        entry = new Entry();
+        entry->enableMessages();
+        links.insert(link->getId(), entry);
+    }
+    return entry;
+}
+
+/**
+ * The counters stay valid until the statistics are deleted.
+ */
+MAVLinkStatistics::Counters* MAVLinkStatistics::getLinkCounters(LinkInterface* link)
+{
+    return &getLinkEntry(link)->counters;
+}
+
+/**
+ * Two threads receiving the first packet of a component at the same
+ * time both allocate an entry, only one of them is published.
+ */
+MAVLinkStatistics::Entry* MAVLinkStatistics::getComponent(int sysid, int compid)
+{
+    System* system = systems[sysid];
+    if (system == NULL)
+    {
+        System* created = new System();
+        for (int i = 0; i < 256; i++)
+        {
+            created->components[i] = NULL;
+        }
+        if (systems[sysid].testAndSetOrdered(NULL, created))
+        {
+            system = created;
+        }
+        else
+        {
+            delete created;
+            system = systems[sysid];
+        }
+    }
+
+    Entry* entry = system->components[compid];
+    if (entry == NULL)
+    {
+        Entry* created = new Entry();
+        if (system->components[compid].testAndSetOrdered(NULL, created))
+        {
+            entry = created;
+        }
+        else
+        {
+            delete created;
+            entry = system->components[compid];
+        }
+    }
+    return entry;
+}
+
+void MAVLinkStatistics::updateJitter(Counters* counters, int now)
+{
+    int last = counters->lastArrival.fetchAndStoreRelaxed(now + 1);
+    if (last == 0) return;
+
+    int gap = now + 1 - last;
+    int bin = 0;
+    while (gap > 0 && bin < JITTER_BINS - 1)
+    {
+        gap >>= 1;
+        bin++;
+    }
+    counters->jitter[bin].fetchAndAddRelaxed(1);
+}
+
+/**
+ * The loss is the distance of the sequence number to the one of the
+ * previous packet of the component, minus one, modulo 256. A reordered
+ * packet therefore counts as the loss of almost a full sequence, as it
+ * did before. Duplicates only count as traffic of the link.
+ */
+int MAVLinkStatistics::update(Counters* link, const mavlink_message_t& message, int length, bool duplicate)
+{
+    int now = clock.elapsed();
+    link->packets.fetchAndAddRelaxed(1);
+    link->bytes.fetchAndAddRelaxed(length);
+    link->received[message.msgid].messages.fetchAndAddRelaxed(1);
+    link->received[message.msgid].bytes.fetchAndAddRelaxed(length);
+
+    // A copy would count as a wrap of the whole sequence of the component
+    if (duplicate)
+    {
+        updateJitter(link, now);
+        return 0;
+    }
+
+    Entry* component = getComponent(message.sysid, message.compid);
+    Counters* counters = &component->counters;
+    counters->packets.fetchAndAddRelaxed(1);
+    counters->bytes.fetchAndAddRelaxed(length);
+
+    int lastSeq = counters->lastSeq.fetchAndStoreRelaxed(message.seq);
+    int lost = 0;
+    if (lastSeq >= 0)
+    {
+        lost = (message.seq - lastSeq - 1) & 0xFF;
+    }
+    if (lost > 0)
+    {
+        counters->lost.fetchAndAddRelaxed(lost);
+        link->lost.fetchAndAddRelaxed(lost);
+    }
+
+    updateJitter(link, now);
+    updateJitter(counters, now);
+    return lost;
+}
+
+/**
+ * Sending is rare compared to receiving, the link is looked up under
+ * the lock of the link map.
+ *
+ * @param link The link the message was written to
+ * @param msgid The message id
+ * @param length Length of the frame in bytes
+ */
+void MAVLinkStatistics::messageSent(LinkInterface* link, int msgid, int length)
+{
+    if (msgid < 0 || msgid > 255) return;
+    Counters* counters = getLinkCounters(link);
+    counters->sent[msgid].messages.fetchAndAddRelaxed(1);
+    counters->sent[msgid].bytes.fetchAndAddRelaxed(length);
+}
+
+/**
+ * The rates are smoothed exponentially over about one second, a
+ * window per message id would cost too much memory.
+ */
+void MAVLinkStatistics::sampleMessages(MessageCounters* counters, MessageWindow* window, int interval)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        quint32 messages = (quint32)(int)counters[i].messages;
+        quint32 bytes = (quint32)(int)counters[i].bytes;
+        MessageWindow& w = window[i];
+        quint32 newMessages = messages - w.lastMessages;
+        quint32 newBytes = bytes - w.lastBytes;
+        w.messages += newMessages;
+        w.bytes += newBytes;
+        w.lastMessages = messages;
+        w.lastBytes = bytes;
+        if (interval > 0)
+        {
+            w.messageRate = 0.75 * w.messageRate + 0.25 * (newMessages * 1000.0 / interval);
+            w.byteRate = 0.75 * w.byteRate + 0.25 * (newBytes * 1000.0 / interval);
+        }
+    }
+}
+
+/**
+ * The counters are 32 bit wide and wrap around, only the difference to
+ * the previous sample is added to the totals.
+ */
+void MAVLinkStatistics::sample(Entry* entry, int now, int interval)
+{
+    if (entry->received) sampleMessages(entry->counters.received, entry->received, interval);
+    if (entry->sent) sampleMessages(entry->counters.sent, entry->sent, interval);
+
+    quint32 packets = (quint32)(int)entry->counters.packets;
+    quint32 bytes = (quint32)(int)entry->counters.bytes;
+    quint32 lost = (quint32)(int)entry->counters.lost;
+    entry->packets += (quint32)(packets - entry->lastPackets);
+    entry->bytes += (quint32)(bytes - entry->lastBytes);
+    entry->lost += (quint32)(lost - entry->lastLost);
+    entry->lastPackets = packets;
+    entry->lastBytes = bytes;
+    entry->lastLost = lost;
+
+    entry->newest = (entry->newest + 1) % WINDOW_SAMPLES;
+    entry->windowPackets[entry->newest] = entry->packets;
+    entry->windowBytes[entry->newest] = entry->bytes;
+    entry->windowLost[entry->newest] = entry->lost;
+    entry->windowTime[entry->newest] = now;
+    if (entry->count < WINDOW_SAMPLES) entry->count++;
+}
+
+void MAVLinkStatistics::sample()
+{
+    int now = clock.elapsed();
+    int interval = now - lastSample;
+    lastSample = now;
+    QList<Entry*> entries;
+    linkMutex.lock();
+    entries = links.values();
+    linkMutex.unlock();
+    for (int i = 0; i < 256; i++)
+    {
+        System* system = systems[i];
+        if (system == NULL) continue;
+        for (int j = 0; j < 256; j++)
+        {
+            Entry* entry = system->components[j];
+            if (entry != NULL) entries.append(entry);
+        }
+    }
+
+    sampleMutex.lock();
+    foreach (Entry* entry, entries)
+    {
+        sample(entry, now, interval);
+    }
+    sampleMutex.unlock();
+
+    if (receivers(SIGNAL(statisticsChanged())) > 0) emit statisticsChanged();
+}
+
+void MAVLinkStatistics::fillReport(Entry* entry, Report* report)
+{
+    QMutexLocker locker(&sampleMutex);
+    memset(report, 0, sizeof(Report));
+    report->packets = entry->packets;
+    report->bytes = entry->bytes;
+    report->lost = entry->lost;
+    for (int i = 0; i < JITTER_BINS; i++)
+    {
+        report->jitter[i] = (quint32)(int)entry->counters.jitter[i];
+    }
+    if (entry->count < 2) return;
+
+    int newest = entry->newest;
+    int oldest = (newest - entry->count + 1 + WINDOW_SAMPLES) % WINDOW_SAMPLES;
+    double seconds = (entry->windowTime[newest] - entry->windowTime[oldest]) / 1000.0;
+    if (seconds <= 0) return;
+    quint64 packets = entry->windowPackets[newest] - entry->windowPackets[oldest];
+    quint64 lost = entry->windowLost[newest] - entry->windowLost[oldest];
+    report->packetRate = packets / seconds;
+    report->byteRate = (entry->windowBytes[newest] - entry->windowBytes[oldest]) / seconds;
+    if (packets + lost > 0) report->loss = 100.0 * lost / (double)(packets + lost);
+}
+
+QList<int> MAVLinkStatistics::getLinks()
+{
+    QMutexLocker locker(&linkMutex);
+    return links.keys();
+}
+
+bool MAVLinkStatistics::getLinkReport(int linkId, Report* report)
+{
+    linkMutex.lock();
+    Entry* entry = links.value(linkId, NULL);
+    linkMutex.unlock();
+    if (entry == NULL) return false;
+    fillReport(entry, report);
+    return true;
+}
+
+QList<MAVLinkStatistics::MessageReport> MAVLinkStatistics::getMessageReports(int linkId, bool sent)
+{
+    QList<MessageReport> reports;
+    linkMutex.lock();
+    Entry* entry = links.value(linkId, NULL);
+    linkMutex.unlock();
+    if (entry == NULL) return reports;
+
+    QMutexLocker locker(&sampleMutex);
+    MessageWindow* window = sent ? entry->sent : entry->received;
+    for (int i = 0; i < 256; i++)
+    {
+        if (window[i].messages == 0) continue;
+        MessageReport report;
+        report.msgid = i;
+        report.messages = window[i].messages;
+        report.bytes = window[i].bytes;
+        report.messageRate = window[i].messageRate;
+        report.byteRate = window[i].byteRate;
+        reports.append(report);
+    }
+    return reports;
+}
+
+QList<int> MAVLinkStatistics::getComponents()
+{
+    QList<int> components;
+    for (int i = 0; i < 256; i++)
+    {
+        System* system = systems[i];
+        if (system == NULL) continue;
+        for (int j = 0; j < 256; j++)
+        {
+            if (system->components[j] != NULL) components.append(i * 256 + j);
+        }
+    }
+    return components;
+}
+
+bool MAVLinkStatistics::getComponentReport(int sysid, int compid, Report* report)
+{
+    if (sysid < 0 || sysid > 255 || compid < 0 || compid > 255) return false;
+    System* system = systems[sysid];
+    if (system == NULL) return false;
+    Entry* entry = system->components[compid];
+    if (entry == NULL) return false;
+    fillReport(entry, report);
+    return true;
+}
+
+int MAVLinkStatistics::getJitterBinLimit(int bin)
+{
+    return (1 << bin);
+}
+
+/**
+ * Serial links transfer ten bits per byte with start and stop bit,
+ * the capacity of other links is the nominal rate divided by eight.
+ */
+double MAVLinkStatistics::getCapacity(LinkInterface* link)
+{
+    if (link == NULL) return 0;
+    double bits = link->getNominalDataRate();
+    if (dynamic_cast<SerialLinkInterface*>(link)) return bits / 10.0;
+    return bits / 8.0;
+}
@@ -0,0 +1,223 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class MAVLinkStatistics
+ */
+
+#ifndef MAVLINKSTATISTICS_H_
+#define MAVLINKSTATISTICS_H_
+
+#include <QObject>
+#include <QMap>
+#include <QList>
+#include <QMutex>
+#include <QTime>
+#include <QTimer>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include "LinkInterface.h"
+#include "protocol.h"
+#include "mavlink.h"
+
+/**
+ * @brief Receive statistics per link and per sending component
+ *
+ * The decoder threads only increment counters: packets, bytes, lost
+ * packets and one bin of the inter-arrival histogram, both for the link
+ * and for the (system id, component id) pair of the message. The gap in
+ * the sequence numbers is calculated in one step, modulo 256.
+ *
+ * Links additionally count messages and bytes per message id, in both
+ * directions, in arrays indexed by the message id.
+ *
+ * A timer in the thread of this object samples the counters four times
+ * per second and derives the packet rate, the byte rate and the loss
+ * ratio over the last two seconds. Reports can be read from any thread.
+ **/
+class MAVLinkStatistics : public QObject
+{
+    Q_OBJECT
+
+public:
+    MAVLinkStatistics(QObject* parent = NULL);
+    ~MAVLinkStatistics();
+
+    enum
+    {
+        JITTER_BINS = 16,        ///< Bin 0 counts gaps below 1 ms, bin n gaps of 2^(n-1) to 2^n ms
+        WINDOW_SAMPLES = 8,      ///< Number of samples the rates are calculated over
+        SAMPLE_INTERVAL = 250    ///< Milliseconds between two samples
+    };
+
+    /** @brief Traffic of one message id */
+    struct MessageCounters
+    {
+        QAtomicInt messages;
+        QAtomicInt bytes;
+    };
+
+    /** @brief Counters written by the decoder threads */
+    struct Counters
+    {
+        Counters() : received(NULL), sent(NULL) {}
+        MessageCounters* received; ///< Per message id, links only
+        MessageCounters* sent;     ///< Per message id, links only
+        QAtomicInt packets;
+        QAtomicInt bytes;
+        QAtomicInt lost;
+        QAtomicInt lastSeq;      ///< Sequence number of the last packet, -1 if none yet
+        QAtomicInt lastArrival;  ///< Arrival of the last packet in ms since start + 1, 0 if none yet
+        QAtomicInt jitter[JITTER_BINS];
+    };
+
+    /** @brief Snapshot of the statistics of a link or a component */
+    struct Report
+    {
+        quint64 packets;      ///< Packets received in total
+        quint64 bytes;        ///< Bytes of all received frames
+        quint64 lost;         ///< Packets missing in the sequence in total
+        double packetRate;    ///< Packets per second over the window
+        double byteRate;      ///< Bytes per second over the window
+        double loss;          ///< Percentage of lost packets over the window
+        quint64 jitter[JITTER_BINS]; ///< Histogram of the time between two packets
+    };
+
+    /** @brief Traffic of one message id on a link */
+    struct MessageReport
+    {
+        int msgid;
+        quint64 messages;     ///< Messages in total
+        quint64 bytes;        ///< Bytes of all frames in total
+        double messageRate;   ///< Messages per second, smoothed
+        double byteRate;      ///< Bytes per second, smoothed
+    };
+
+    /** @brief Get the counters of a link, called once by its decoder */
+    Counters* getLinkCounters(LinkInterface* link);
+    /**
+     * @brief Account a received packet, called from the decoder threads
+     * @param link The counters of the link the packet arrived on
+     * @param message The decoded packet
+     * @param length Length of the frame in bytes
+     * @param duplicate True if the packet was already received, e.g. on another link
+     * @return Number of packets missing in the sequence before this one
+     */
+    int update(Counters* link, const mavlink_message_t& message, int length, bool duplicate = false);
+    /** @brief Account a sent message, called from any thread */
+    void messageSent(LinkInterface* link, int msgid, int length);
+
+    /** @brief Get the ids of all links which received packets */
+    QList<int> getLinks();
+    /** @brief Get the statistics of a link, returns false if the link is unknown */
+    bool getLinkReport(int linkId, Report* report);
+    /** @brief Get the traffic of all message ids seen on a link, in one direction */
+    QList<MessageReport> getMessageReports(int linkId, bool sent);
+    /** @brief Get all components which sent packets, as sysid * 256 + compid */
+    QList<int> getComponents();
+    /** @brief Get the statistics of a component, returns false if it is unknown */
+    bool getComponentReport(int sysid, int compid, Report* report);
+
+    /** @brief Get the upper bound of a jitter bin in milliseconds */
+    static int getJitterBinLimit(int bin);
+    /** @brief Get the capacity of a link in bytes per second, 0 if unknown */
+    static double getCapacity(LinkInterface* link);
+
+signals:
+    /** @brief Emitted after each sample of the counters */
+    void statisticsChanged();
+
+protected slots:
+    /** @brief Sample all counters and update the rates */
+    void sample();
+
+protected:
+    /** @brief Sampled totals and rates of one message id */
+    struct MessageWindow
+    {
+        quint64 messages;
+        quint64 bytes;
+        quint32 lastMessages;
+        quint32 lastBytes;
+        double messageRate;
+        double byteRate;
+    };
+
+    /** @brief Counters of one source and the sampled window */
+    struct Entry
+    {
+        Entry();
+        ~Entry();
+        /** @brief Allocate the per message id counters, for links */
+        void enableMessages();
+        Counters counters;
+        MessageWindow* received;  ///< Per message id, NULL for components
+        MessageWindow* sent;      ///< Per message id, NULL for components
+        // Written by the sampling timer only, protected by sampleMutex
+        quint64 packets;
+        quint64 bytes;
+        quint64 lost;
+        quint32 lastPackets;
+        quint32 lastBytes;
+        quint32 lastLost;
+        quint64 windowPackets[WINDOW_SAMPLES];
+        quint64 windowBytes[WINDOW_SAMPLES];
+        quint64 windowLost[WINDOW_SAMPLES];
+        int windowTime[WINDOW_SAMPLES];
+        int newest;
+        int count;
+    };
+
+    /** @brief Components of one system, created on the first packet */
+    struct System
+    {
+        QAtomicPointer<Entry> components[256];
+    };
+
+    QAtomicPointer<System> systems[256];
+    QMap<int, Entry*> links;  ///< Entries of all links by link id
+    QMutex linkMutex;         ///< Protects the link map
+    QMutex sampleMutex;       ///< Protects the sampled windows
+    QTime clock;              ///< Time base of the arrival times and samples
+    int lastSample;           ///< Time of the previous sample
+    QTimer sampleTimer;
+
+    /** @brief Get the entry of a component, creating it without lock */
+    Entry* getComponent(int sysid, int compid);
+    /** @brief Account the arrival time in the jitter histogram */
+    static void updateJitter(Counters* counters, int now);
+    /** @brief Get the entry of a link, creating it if necessary */
+    Entry* getLinkEntry(LinkInterface* link);
+    /** @brief Take a sample of the counters of one entry */
+    void sample(Entry* entry, int now, int interval);
+    /** @brief Take a sample of the per message id counters */
+    static void sampleMessages(MessageCounters* counters, MessageWindow* window, int interval);
+    /** @brief Fill the report from the sampled window of the entry */
+    void fillReport(Entry* entry, Report* report);
+
+private:
+    Q_DISABLE_COPY(MAVLinkStatistics)
+};
+
+#endif // MAVLINKSTATISTICS_H_
@@ -0,0 +1,134 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the message queue of one receiver
+ *
+ */
+
+#include <QMutexLocker>
+#include <QList>
+#include <QByteArray>
+#include "MAVLinkSubscriber.h"
+
+/**
+ * The subscriber moves into the thread of the receiver, deliver() is
+ * therefore executed there.
+ */
+MAVLinkSubscriber::MAVLinkSubscriber(QObject* receiver, const QMetaMethod& method) :
+        receiver(receiver),
+        method(method),
+        passHandle(method.parameterTypes().size() == 1),
+        fifo(64),
+        head(0),
+        count(0),
+        highWaterMark(0),
+        notified(0)
+{
+    moveToThread(receiver->thread());
+}
+
+bool MAVLinkSubscriber::isSupported(const QMetaMethod& method)
+{
+    QList<QByteArray> types = method.parameterTypes();
+    if (types.size() == 1) return types[0] == "MAVLinkMessageHandle";
+    return types.size() == 2 && types[0] == "LinkInterface*" && types[1] == "mavlink_message_t";
+}
+
+QObject* MAVLinkSubscriber::getReceiver()
+{
+    return receiver;
+}
+
+void MAVLinkSubscriber::post(const MAVLinkMessageHandle& handle)
+{
+    mutex.lock();
+    if (count == fifo.size())
+    {
+        // Unroll the ring into a twice as large one
+        QVector<MAVLinkMessageHandle> larger(fifo.size() * 2);
+        for (int i = 0; i < count; i++)
+        {
+            larger[i] = fifo[(head + i) % fifo.size()];
+        }
+        fifo = larger;
+        head = 0;
+    }
+    fifo[(head + count) % fifo.size()] = handle;
+    count++;
+    if (count > highWaterMark) highWaterMark = count;
+    mutex.unlock();
+
+    if (notified.testAndSetOrdered(0, 1))
+    {
+        QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection);
+    }
+}
+
+/**
+ * The notification is re-armed before the FIFO is drained, a message
+ * posted meanwhile either is drained here or queues the next call.
+ */
+void MAVLinkSubscriber::deliver()
+{
+    notified.fetchAndStoreOrdered(0);
+    forever
+    {
+        mutex.lock();
+        if (count == 0)
+        {
+            mutex.unlock();
+            return;
+        }
+        MAVLinkMessageHandle handle = fifo[head];
+        fifo[head] = MAVLinkMessageHandle();
+        head = (head + 1) % fifo.size();
+        count--;
+        mutex.unlock();
+
+        // The receiver may have been deleted, the messages are dropped then
+        QObject* target = receiver;
+        if (target == NULL) continue;
+        if (passHandle)
+        {
+            method.invoke(target, Qt::DirectConnection, Q_ARG(MAVLinkMessageHandle, handle));
+        }
+        else
+        {
+            method.invoke(target, Qt::DirectConnection, Q_ARG(LinkInterface*, handle.link()), Q_ARG(mavlink_message_t, handle.message()));
+        }
+    }
+}
+
+int MAVLinkSubscriber::getQueued()
+{
+    QMutexLocker locker(&mutex);
+    return count;
+}
+
+int MAVLinkSubscriber::getHighWaterMark()
+{
+    QMutexLocker locker(&mutex);
+    return highWaterMark;
+}
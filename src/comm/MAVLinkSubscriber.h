@@ -0,0 +1,97 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the message queue of one receiver
+ *
+ */
+
+#ifndef MAVLINKSUBSCRIBER_H_
+#define MAVLINKSUBSCRIBER_H_
+
+#include <QObject>
+#include <QPointer>
+#include <QMutex>
+#include <QVector>
+#include <QAtomicInt>
+#include <QMetaMethod>
+#include "MAVLinkMessagePool.h"
+
+/**
+ * @brief Delivers message handles to a slot in the thread of the receiver
+ *
+ * Messages are posted from the decoder threads into a FIFO of handles.
+ * The first message posted after a drain queues one call of deliver() in
+ * the thread of the receiver, which then invokes the slot directly for
+ * every message waiting. A burst of messages costs a single event instead
+ * of one queued call with a copy of the message each.
+ *
+ * The slot either takes (LinkInterface*, mavlink_message_t), which gets a
+ * copy on the stack, or (MAVLinkMessageHandle), which shares the pooled
+ * message. The FIFO grows if needed and never shrinks, so it does not
+ * allocate once it has reached the size of the largest burst.
+ **/
+class MAVLinkSubscriber : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param receiver The object to deliver the messages to
+     * @param method A slot of the receiver with one of the supported signatures
+     */
+    MAVLinkSubscriber(QObject* receiver, const QMetaMethod& method);
+
+    /** @brief Check if a slot can receive messages through a subscriber */
+    static bool isSupported(const QMetaMethod& method);
+
+    /** @brief Get the receiver, NULL once it has been deleted */
+    QObject* getReceiver();
+    /** @brief Queue a message for the receiver, can be called from any thread */
+    void post(const MAVLinkMessageHandle& handle);
+    /** @brief Get the number of messages waiting */
+    int getQueued();
+    /** @brief Get the most messages waiting at once */
+    int getHighWaterMark();
+
+public slots:
+    /** @brief Invoke the slot for all waiting messages, runs in the thread of the receiver */
+    void deliver();
+
+protected:
+    QPointer<QObject> receiver;
+    QMetaMethod method;
+    bool passHandle;             ///< True if the slot takes a handle instead of a copy
+    QVector<MAVLinkMessageHandle> fifo;
+    int head;                    ///< Index of the oldest message
+    int count;                   ///< Number of waiting messages
+    int highWaterMark;
+    QMutex mutex;                ///< Protects the FIFO
+    QAtomicInt notified;         ///< 1 if a call of deliver() is pending
+
+private:
+    Q_DISABLE_COPY(MAVLinkSubscriber)
+};
+
+#endif // MAVLINKSUBSCRIBER_H_
@@ -52,8 +52,23 @@ class ProtocolInterface : public QThread
 public:
     //virtual ~ProtocolInterface() {};
     virtual QString getName() = 0;
+    /**
+     * @brief Attach the protocol to the receive ring of the link
+     *
+     * Protocols which drain the ring of a link in place do not need to be
+     * connected to the bytesReceived() signal of that link.
+     *
+     * @return True if the protocol reads from the ring of the link
+     */
+    virtual bool attachLink(LinkInterface* link) { Q_UNUSED(link); return false; }
 
 public slots:
+    /**
+     * @brief Receive bytes from a link
+     *
+     * This slot is called directly in the thread of the link which received
+     * the bytes, implementations have to be reentrant for different links.
+     */
     virtual void receiveBytes(LinkInterface *link, QByteArray b) = 0;
 
 signals:
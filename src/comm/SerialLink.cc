@@ -33,11 +33,18 @@ This file is part of the QGROUNDCONTROL project
 #include <QMutexLocker>
 #include "SerialLink.h"
 #include "LinkManager.h"
+#include "LinkRingBuffer.h"
 #include <MG.h>
 #ifdef _WIN32
 #include "windows.h"
 #endif
 
+#ifdef _TTY_POSIX_
+// The reader thread blocks until bytes arrive
+#define SERIAL_QUERY_MODE QextSerialPort::EventDriven
+#else
+#define SERIAL_QUERY_MODE QextSerialPort::Polling
+#endif
 
 SerialLink::SerialLink(QString portname, BaudRateType baudrate, FlowType flow, ParityType parity, DataBitsType dataBits, StopBitsType stopBits)
 {
@@ -59,6 +66,11 @@ SerialLink::SerialLink(QString portname, BaudRateType baudrate, FlowType flow, P
     this->parity = parity;
     this->dataBits = dataBits;
     this->stopBits = stopBits;
+    this->bitsSentTotal = 0;
+    this->bitsReceivedTotal = 0;
+    this->writeBlocked = false;
+    this->trace = false;
+    this->connectionStartTime = MG::TIME::getGroundTimeNow();
     this->timeout = 1; ///< The timeout controls how long the program flow should wait for new serial bytes. As we're polling, we don't want to wait at all.
 
     // Set the port name
@@ -88,7 +100,7 @@ SerialLink::SerialLink(QString portname, BaudRateType baudrate, FlowType flow, P
     }
 #else
     // *nix (Linux, MacOS tested) serial port support
-    port = new QextSerialPort(porthandle, QextSerialPort::Polling);
+    port = new QextSerialPort(porthandle, SERIAL_QUERY_MODE);
     port->setTimeout(timeout); // Timeout of 0 ms, we don't want to wait for data, we just poll again next time
     port->setBaudRate(baudrate);
     port->setFlowControl(flow);
@@ -121,6 +133,19 @@ void SerialLink::run()
     // Qt way to make clear what a while(1) loop does
     forever
     {
+#ifdef _TTY_POSIX_
+        // Sleep in poll() until bytes arrive, the timeout only bounds the
+        // time to notice a port closed meanwhile. Closing the port wakes
+        // the thread up immediately.
+        if (port->isOpen())
+        {
+            // writeBytes() interrupts the wait, so queued bytes go out right away
+            writeQueued();
+            if (port->waitForReadyRead(SerialLink::wait_timeout)) readBytes();
+            continue;
+        }
+#endif
+        writeQueued();
         // Check if new bytes have arrived, if yes, emit the notification signal
         checkForBytes();
         /* Serial data isn't arriving that fast normally, this saves the thread
@@ -157,20 +182,70 @@ void SerialLink::writeBytes(const char* data, qint64 size)
 {
     if(port->isOpen())
     {
-        int b = port->write(data, size);
-        qDebug() << "Transmitted " << b << "bytes:";
-
-        // Increase write counter
-        bitsSentTotal += size * 8;
+        writeMutex.lock();
+        writeBuffer.append(data, size);
+        bool full = !writeBlocked && writeBuffer.size() > write_high_water;
+        if (full) writeBlocked = true;
+        writeMutex.unlock();
+
+        if (full) emit writeBufferFull(true);
+#ifdef _TTY_POSIX_
+        // Return the link thread from its wait for received bytes
+        port->wakeUp();
+#endif
+    }
+}
 
-        int i;
-        for (i=0; i<size; i++)
-        {
-            unsigned char v=data[i];
+/**
+ * All bytes queued since the last call are written with one call to
+ * the port. Bytes the port did not accept are written next time.
+ */
+void SerialLink::writeQueued()
+{
+    writeMutex.lock();
+    QByteArray data = writeBuffer;
+    writeBuffer.clear();
+    writeMutex.unlock();
+    if (data.isEmpty()) return;
 
-            fprintf(stderr,"%02x ", v);
-        }
+    qint64 written = 0;
+    if (port->isOpen())
+    {
+        written = port->write(data.constData(), data.size());
+        if (written < 0) written = 0;
+        bitsSentTotal += written * 8;
+        if (trace) qDebug() << "SerialLink" << getName() << "sent" << written << "bytes:" << data.left(written).toHex();
     }
+
+    writeMutex.lock();
+    if (written < data.size() && port->isOpen()) writeBuffer.prepend(data.mid(written));
+    bool released = writeBlocked && writeBuffer.size() <= write_high_water / 2;
+    if (released) writeBlocked = false;
+    writeMutex.unlock();
+
+    if (released) emit writeBufferFull(false);
+}
+
+qint64 SerialLink::bytesToWrite()
+{
+    QMutexLocker locker(&writeMutex);
+    return writeBuffer.size();
+}
+
+/**
+ * Tracing writes every sent byte to the debug output, which is slow at
+ * high rates. It is therefore off by default.
+ *
+ * @param enabled true to dump the sent bytes as hex
+ */
+void SerialLink::setTraceEnabled(bool enabled)
+{
+    trace = enabled;
+}
+
+bool SerialLink::isTraceEnabled()
+{
+    return trace;
 }
 
 /**
@@ -184,32 +259,72 @@ void SerialLink::readBytes()
     dataMutex.lock();
     if(port->isOpen())
     {
-        const qint64 maxLength = 2048;
-        char data[maxLength];
         qint64 numBytes = port->bytesAvailable();
         if(numBytes > 0)
         {
-            /* Read as much data in buffer as possible without overflow */
-            if(maxLength < numBytes) numBytes = maxLength;
-
-            port->read(data, numBytes);
-            QByteArray b(data, numBytes);
-            emit bytesReceived(this, b);
-
-            //qDebug() << "SerialLink::readBytes()" << std::hex << data;
-            //            int i;
-            //            for (i=0; i<numBytes; i++){
-            //                unsigned int v=data[i];
-            //
-            //                fprintf(stderr,"%02x ", v);
-            //            }
-            //            fprintf(stderr,"\n");
-            bitsReceivedTotal += numBytes * 8;
+            if (receiveBuffer)
+            {
+                // Read in place into the ring of the decoder,
+                // at most two spans before and after the wrap-around
+                bool forward = receivers(SIGNAL(bytesReceived(LinkInterface*, QByteArray))) > 0;
+                qint64 remaining = numBytes;
+                for (int span = 0; span < 2 && remaining > 0; span++)
+                {
+                    int length;
+                    char* data = receiveBuffer->writeSpan(&length);
+                    if (length <= 0) break;
+                    if (length > remaining) length = remaining;
+                    length = port->read(data, length);
+                    if (length <= 0) break;
+                    // Only copy the bytes if e.g. a debug console listens
+                    if (forward) emit bytesReceived(this, QByteArray(data, length));
+                    receiveBuffer->commit(length);
+                    remaining -= length;
+                }
+                // Bytes not fitting into the ring stay in the port buffer and
+                // are read with the next poll, they are no overrun
+                bitsReceivedTotal += (numBytes - remaining) * 8;
+            }
+            else
+            {
+                const qint64 maxLength = 2048;
+                char data[maxLength];
+                /* Read as much data in buffer as possible without overflow */
+                if(maxLength < numBytes) numBytes = maxLength;
+
+                port->read(data, numBytes);
+                QByteArray b(data, numBytes);
+                emit bytesReceived(this, b);
+
+                //qDebug() << "SerialLink::readBytes()" << std::hex << data;
+                //            int i;
+                //            for (i=0; i<numBytes; i++){
+                //                unsigned int v=data[i];
+                //
+                //                fprintf(stderr,"%02x ", v);
+                //            }
+                //            fprintf(stderr,"\n");
+                bitsReceivedTotal += numBytes * 8;
+            }
         }
     }
     dataMutex.unlock();
 }
 
+/**
+ * The ring has to be set before the link is connected.
+ *
+ * @param buffer The ring to read received bytes into, NULL to emit them
+ * @return Always true, the serial link supports in place reads
+ */
+bool SerialLink::setReceiveBuffer(LinkRingBuffer* buffer)
+{
+    dataMutex.lock();
+    receiveBuffer = buffer;
+    dataMutex.unlock();
+    return true;
+}
+
 
 /**
  * @brief Get the number of bytes to read.
@@ -236,6 +351,14 @@ bool SerialLink::disconnect()
     port->close();
     dataMutex.unlock();
 
+    // Bytes not yet written are discarded with the connection
+    writeMutex.lock();
+    writeBuffer.clear();
+    bool released = writeBlocked;
+    writeBlocked = false;
+    writeMutex.unlock();
+    if (released) emit writeBufferFull(false);
+
     bool closed = true;
     //port->isOpen();
 
@@ -404,19 +527,24 @@ qint64 SerialLink::getNominalDataRate()
 
 qint64 SerialLink::getTotalUpstream()
 {
-    statisticsMutex.lock();
-    return bitsSentTotal / ((MG::TIME::getGroundTimeNow() - connectionStartTime) / 1000);
-    statisticsMutex.unlock();
+    QMutexLocker locker(&statisticsMutex);
+    quint64 seconds = (MG::TIME::getGroundTimeNow() - connectionStartTime) / 1000;
+    if (seconds == 0) return 0;
+    return bitsSentTotal / seconds;
 }
 
 qint64 SerialLink::getCurrentUpstream()
 {
-    return 0; // TODO
+    QMutexLocker locker(&statisticsMutex);
+    upstream.update(bitsSentTotal, MG::TIME::getGroundTimeNow());
+    return upstream.getCurrent();
 }
 
 qint64 SerialLink::getMaxUpstream()
 {
-    return 0; // TODO
+    QMutexLocker locker(&statisticsMutex);
+    upstream.update(bitsSentTotal, MG::TIME::getGroundTimeNow());
+    return upstream.getMax();
 }
 
 qint64 SerialLink::getBitsSent()
@@ -431,19 +559,24 @@ qint64 SerialLink::getBitsReceived()
 
 qint64 SerialLink::getTotalDownstream()
 {
-    statisticsMutex.lock();
-    return bitsReceivedTotal / ((MG::TIME::getGroundTimeNow() - connectionStartTime) / 1000);
-    statisticsMutex.unlock();
+    QMutexLocker locker(&statisticsMutex);
+    quint64 seconds = (MG::TIME::getGroundTimeNow() - connectionStartTime) / 1000;
+    if (seconds == 0) return 0;
+    return bitsReceivedTotal / seconds;
 }
 
 qint64 SerialLink::getCurrentDownstream()
 {
-    return 0; // TODO
+    QMutexLocker locker(&statisticsMutex);
+    downstream.update(bitsReceivedTotal, MG::TIME::getGroundTimeNow());
+    return downstream.getCurrent();
 }
 
 qint64 SerialLink::getMaxDownstream()
 {
-    return 0; // TODO
+    QMutexLocker locker(&statisticsMutex);
+    downstream.update(bitsReceivedTotal, MG::TIME::getGroundTimeNow());
+    return downstream.getMax();
 }
 
 bool SerialLink::isFullDuplex()
@@ -514,7 +647,7 @@ bool SerialLink::setPortName(QString portName)
         }
 #endif
         delete port;
-        port = new QextSerialPort(porthandle, QextSerialPort::Polling);
+        port = new QextSerialPort(porthandle, SERIAL_QUERY_MODE);
 
         port->setBaudRate(baudrate);
         port->setFlowControl(flow);
@@ -36,9 +36,11 @@ This file is part of the PIXHAWK project
 #include <QThread>
 #include <QMutex>
 #include <QString>
+#include <QByteArray>
 #include <qextserialport.h>
 #include <configuration.h>
 #include "SerialLinkInterface.h"
+#include "LinkRate.h"
 #ifdef _WIN32
 #include "windows.h"
 #endif
@@ -61,6 +63,8 @@ public:
     ~SerialLink();
 
     static const int poll_interval = SERIAL_POLL_INTERVAL; ///< Polling interval, defined in configuration.h
+    static const int wait_timeout = SERIAL_WAIT_TIMEOUT; ///< Maximum wait for bytes in event driven mode, defined in configuration.h
+    static const int write_high_water = SERIAL_WRITE_HIGH_WATER; ///< Queued bytes signalling backpressure, defined in configuration.h
 
     bool isConnected();
     qint64 bytesAvailable();
@@ -96,6 +100,11 @@ public:
     int getLinkQuality();
     bool isFullDuplex();
     int getId();
+    bool setReceiveBuffer(LinkRingBuffer* buffer);
+    /** @brief Get the number of bytes queued and not yet written to the port */
+    qint64 bytesToWrite();
+    /** @brief Check if the sent bytes are dumped as hex to the debug output */
+    bool isTraceEnabled();
 
 public slots:
     bool setPortName(QString portName);
@@ -108,12 +117,17 @@ public slots:
 
     void readBytes();
     /**
-     * @brief Write a number of bytes to the interface.
+     * @brief Queue a number of bytes for the interface.
+     *
+     * The bytes are copied and written by the link thread, the caller
+     * does not wait for the port.
      *
      * @param data Pointer to the data byte array
      * @param size The size of the bytes array
      **/
     void writeBytes(const char* data, qint64 length);
+    /** @brief Dump all sent bytes as hex to the debug output, for debugging only */
+    void setTraceEnabled(bool enabled);
     bool connect();
     bool disconnect();
 
@@ -137,22 +151,30 @@ protected:
     int id;
 
     quint64 bitsSentTotal;
-    quint64 bitsSentShortTerm;
-    quint64 bitsSentCurrent;
-    quint64 bitsSentMax;
+    LinkRate upstream;          ///< Sliding window rate of bitsSentTotal
     quint64 bitsReceivedTotal;
-    quint64 bitsReceivedShortTerm;
-    quint64 bitsReceivedCurrent;
-    quint64 bitsReceivedMax;
+    LinkRate downstream;        ///< Sliding window rate of bitsReceivedTotal
     quint64 connectionStartTime;
     QMutex statisticsMutex;
     QMutex dataMutex;
+    QByteArray writeBuffer;     ///< Bytes queued by writeBytes(), coalesced into one write
+    QMutex writeMutex;          ///< Protects the write buffer and the backpressure state
+    bool writeBlocked;          ///< Backpressure was signalled and not yet released
+    bool trace;                 ///< Dump sent bytes as hex
+
+    /** @brief Write the queued bytes to the port, called by the link thread */
+    void writeQueued();
 
     void setName(QString name);
     bool hardwareConnect();
 
 signals:
-    // Signals are defined by LinkInterface
+    // Signals are defined by LinkInterface, except the backpressure signal
+    /**
+     * @brief Emitted with true if more than write_high_water bytes are queued,
+     *        and with false once the queue has drained to half of it
+     */
+    void writeBufferFull(bool full);
 
 };
 
@@ -35,16 +35,24 @@ This file is part of the QGROUNDCONTROL project
 #include <iostream>
 #include "UDPLink.h"
 #include "LinkManager.h"
+#include "LinkRingBuffer.h"
+#include "MAVLinkFrameScanner.h"
 #include "MG.h"
+#include "protocol.h"
 
 UDPLink::UDPLink(QHostAddress host, quint16 port)
 {
     this->host = host;
     this->port = port;
     this->connectState = false;
-    this->hosts = new QList<QHostAddress>();
-    //this->ports = new QMap<QHostAddress, quint16>();
-    this->ports = new QList<quint16>();
+    this->bitsSentTotal = 0;
+    this->bitsReceivedTotal = 0;
+    this->connectionStartTime = MG::TIME::getGroundTimeNow();
+    this->lastExpiry = connectionStartTime;
+    for (int i = 0; i < 256; i++)
+    {
+        systemPeers[i] = -1;
+    }
 
     // Set unique ID and add link to the list of links
     this->id = getNextLinkId();
@@ -78,49 +86,70 @@ void UDPLink::setPort(quint16 port)
 }
 
 
+/**
+ * Bytes not addressed to a particular system are sent to all peers
+ * heard within UDP_PEER_TIMEOUT.
+ *
+ * @param data The bytes to send
+ * @param size The number of bytes
+ */
 void UDPLink::writeBytes(const char* data, qint64 size)
 {
+    QMutexLocker locker(&dataMutex);
+    expirePeers(MG::TIME::getGroundTimeNow());
     // Broadcast to all connected systems
-    //QList<QHostAddress>::iterator h;
-    // for (h = hosts->begin(); h != hosts->end(); ++h)
-
-    for (int h = 0; h < hosts->size(); h++)
+    for (int h = 0; h < peers.size(); h++)
     {
-        QHostAddress currentHost = hosts->at(h);
-        quint16 currentPort = ports->at(h);
-        //        QList<quint16> currentPorts = ports->values(currentHost);
-        //        for (int p = 0; p < currentPorts.size(); p++)
-        //        {
-        //            quint16 currentPort = currentPorts.at(p);
-        //qDebug() << "Sent message to " << currentHost << ":" << currentPort << "at" << __FILE__ << ":" << __LINE__;
-        socket->writeDatagram(data, size, currentHost, currentPort);
-        //        }
+        socket->writeDatagram(data, size, peers.at(h).address, peers.at(h).port);
     }
+    statisticsMutex.lock();
+    bitsSentTotal += size * 8 * peers.size();
+    statisticsMutex.unlock();
+}
 
-
-    //if(socket->write(data, size) > 0) {
-
-//    qDebug() << "Transmitted " << size << "bytes:";
-//
-//    /* Increase write counter */
-//    bitsSentTotal += size * 8;
-//
-//    int i;
-//    for (i=0; i<size; i++){
-//        unsigned int v=data[i];
-//
-//        fprintf(stderr,"%02x ", v);
-//    }
-    //}
+/**
+ * The bytes are only sent to the peer the system was last heard from.
+ * With many vehicles on one port this avoids sending each command to
+ * every vehicle. If the system was not heard on this link yet or its peer
+ * expired, the bytes are sent to all peers.
+ *
+ * @param systemId The system the bytes are addressed to
+ * @param data The bytes to send
+ * @param size The number of bytes
+ */
+void UDPLink::writeBytesToSystem(int systemId, const char* data, qint64 size)
+{
+    dataMutex.lock();
+    expirePeers(MG::TIME::getGroundTimeNow());
+    int peer = (systemId >= 0 && systemId < 256) ? systemPeers[systemId] : -1;
+    if (peer >= 0)
+    {
+        socket->writeDatagram(data, size, peers.at(peer).address, peers.at(peer).port);
+        dataMutex.unlock();
+        statisticsMutex.lock();
+        bitsSentTotal += size * 8;
+        statisticsMutex.unlock();
+        return;
+    }
+    dataMutex.unlock();
+    writeBytes(data, size);
 }
 
 /**
- * @brief Read a number of bytes from the interface.
+ * @brief Read all pending datagrams from the interface.
  *
- * @param data Pointer to the data byte array to write the bytes to
- * @param maxLength The maximum number of bytes to write
+ * A single notification is emitted for any number of datagrams, all of
+ * them are read at once.
  **/
 void UDPLink::readBytes()
+{
+    while (socket->hasPendingDatagrams())
+    {
+        readDatagram();
+    }
+}
+
+void UDPLink::readDatagram()
 {
     const qint64 maxLength = 2048;
     char data[maxLength];
@@ -129,38 +158,159 @@ void UDPLink::readBytes()
 
     unsigned int s = socket->pendingDatagramSize();
     if (s > maxLength) std::cerr << __FILE__ << __LINE__ << " UDP datagram overflow, allowed to read less bytes than datagram size" << std::endl;
-    socket->readDatagram(data, maxLength, &sender, &senderPort);
 
-    // FIXME TODO Check if this method is better than retrieving the data by individual processes
-    QByteArray b(data, s);
-    emit bytesReceived(this, b);
+    int length = 0;
+    char* span = NULL;
+    if (receiveBuffer) span = receiveBuffer->writeSpan(&length);
 
-//    // Echo data for debugging purposes
-//    std::cerr << __FILE__ << __LINE__ << "Received datagram:" << std::endl;
-//    int i;
-//    for (i=0; i<s; i++)
-//    {
-//        unsigned int v=data[i];
-//        fprintf(stderr,"%02x ", v);
-//    }
-//    std::cerr << std::endl;
+    if (span && (unsigned int)length >= s)
+    {
+        // Read the datagram in place into the ring of the decoder
+        qint64 read = socket->readDatagram(span, s, &sender, &senderPort);
+        if (read <= 0) return;
+        updateRoutes(span, read, sender, senderPort);
+        if (receivers(SIGNAL(bytesReceived(LinkInterface*, QByteArray))) > 0) emit bytesReceived(this, QByteArray(span, read));
+        receiveBuffer->commit(read);
+    }
+    else
+    {
+        qint64 read = socket->readDatagram(data, maxLength, &sender, &senderPort);
+        if (read < 0) return;
+        s = read;
+        updateRoutes(data, s, sender, senderPort);
+        if (receiveBuffer)
+        {
+            // Datagram wraps around the end of the ring or does not fit at all
+            receiveBuffer->write(data, s);
+            if (receivers(SIGNAL(bytesReceived(LinkInterface*, QByteArray))) > 0) emit bytesReceived(this, QByteArray(data, s));
+        }
+        else
+        {
+            // FIXME TODO Check if this method is better than retrieving the data by individual processes
+            QByteArray b(data, s);
+            emit bytesReceived(this, b);
+        }
+    }
+}
 
+/**
+ * IPv4 peers are keyed by address and port directly, other addresses
+ * by the hash of their string representation.
+ */
+quint64 UDPLink::peerKey(const QHostAddress& address, quint16 port)
+{
+    if (address.protocol() == QAbstractSocket::IPv4Protocol)
+    {
+        return (static_cast<quint64>(address.toIPv4Address()) << 16) | port;
+    }
+    return (Q_UINT64_C(1) << 63) | (static_cast<quint64>(qHash(address.toString())) << 16) | port;
+}
 
-    // Add host to broadcast list if not yet present
-    if (!hosts->contains(sender))
+/**
+ * Adds the sender to the broadcast peers if not yet present and remembers
+ * it as the peer of all systems sending in this datagram. Only frames with
+ * a valid checksum are routed, so noise or a corrupted header can not
+ * misdirect the commands to a system.
+ *
+ * @param data The datagram
+ * @param length The length of the datagram
+ * @param sender The address the datagram was sent from
+ * @param senderPort The port the datagram was sent from
+ */
+void UDPLink::updateRoutes(const char* data, qint64 length, const QHostAddress& sender, quint16 senderPort)
+{
+    statisticsMutex.lock();
+    bitsReceivedTotal += length * 8;
+    statisticsMutex.unlock();
+
+    QMutexLocker locker(&dataMutex);
+    quint64 now = MG::TIME::getGroundTimeNow();
+    expirePeers(now);
+    quint64 key = peerKey(sender, senderPort);
+    int peer = peerIndex.value(key, -1);
+    if (peer < 0)
     {
-        hosts->append(sender);
-        ports->append(senderPort);
-        //        ports->insert(sender, senderPort);
+        Peer newPeer;
+        newPeer.address = sender;
+        newPeer.port = senderPort;
+        peer = peers.size();
+        peers.append(newPeer);
+        peerIndex.insert(key, peer);
     }
-    else
+    peers[peer].lastHeard = now;
+
+    const quint8* frame = reinterpret_cast<const quint8*>(data);
+    qint64 position = 0;
+    while (position + MAVLINK_NUM_NON_PAYLOAD_BYTES <= length)
+    {
+        if (frame[position] != MAVLINK_STX)
+        {
+            position++;
+            continue;
+        }
+        // Frames do not span datagrams, a truncated frame ends the datagram
+        int payloadLength = frame[position + 1];
+        if (position + payloadLength + MAVLINK_NUM_NON_PAYLOAD_BYTES > length) break;
+        // Checksum covers the core header and the payload, without the start sign
+        quint16 checksum = MAVLinkFrameScanner::crc(frame + position + 1, MAVLINK_CORE_HEADER_LEN + payloadLength);
+        const quint8* ck = frame + position + 1 + MAVLINK_CORE_HEADER_LEN + payloadLength;
+        if (ck[0] != (checksum & 0xFF) || ck[1] != (checksum >> 8))
+        {
+            // Not a valid frame, resynchronize on the next start sign
+            position++;
+            continue;
+        }
+        // Byte order: STX, length, sequence, system id
+        systemPeers[frame[position + 3]] = peer;
+        position += payloadLength + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    }
+}
+
+/**
+ * Peers are checked at most once per second. The routes of the systems
+ * last heard from an expired peer are forgotten, the indices of the
+ * remaining peers are compacted.
+ *
+ * @param now Current ground time in ms
+ */
+void UDPLink::expirePeers(quint64 now)
+{
+    if (now - lastExpiry < 1000) return;
+    lastExpiry = now;
+
+    QVector<int> moved(peers.size(), -1);
+    QVector<Peer> alive;
+    for (int i = 0; i < peers.size(); i++)
     {
-        int index = hosts->indexOf(sender);
-        ports->replace(index, senderPort);
+        if (now - peers.at(i).lastHeard > UDP_PEER_TIMEOUT) continue;
+        moved[i] = alive.size();
+        alive.append(peers.at(i));
     }
+    if (alive.size() == peers.size()) return;
 
+    peers = alive;
+    peerIndex.clear();
+    for (int i = 0; i < peers.size(); i++)
+    {
+        peerIndex.insert(peerKey(peers.at(i).address, peers.at(i).port), i);
+    }
+    for (int i = 0; i < 256; i++)
+    {
+        if (systemPeers[i] >= 0) systemPeers[i] = moved.at(systemPeers[i]);
+    }
 }
 
+/**
+ * The ring has to be set before the link is connected.
+ *
+ * @param buffer The ring to read received datagrams into, NULL to emit them
+ * @return Always true, the UDP link supports in place reads
+ */
+bool UDPLink::setReceiveBuffer(LinkRingBuffer* buffer)
+{
+    receiveBuffer = buffer;
+    return true;
+}
 
 /**
  * @brief Get the number of bytes to read.
@@ -244,18 +394,22 @@ qint64 UDPLink::getNominalDataRate() {
 }
 
 qint64 UDPLink::getTotalUpstream() {
-    statisticsMutex.lock();
-    qint64 totalUpstream = bitsSentTotal / ((MG::TIME::getGroundTimeNow() - connectionStartTime) / 1000);
-    statisticsMutex.unlock();
-    return totalUpstream;
+    QMutexLocker locker(&statisticsMutex);
+    quint64 seconds = (MG::TIME::getGroundTimeNow() - connectionStartTime) / 1000;
+    if (seconds == 0) return 0;
+    return bitsSentTotal / seconds;
 }
 
 qint64 UDPLink::getCurrentUpstream() {
-    return 0; // TODO
+    QMutexLocker locker(&statisticsMutex);
+    upstream.update(bitsSentTotal, MG::TIME::getGroundTimeNow());
+    return upstream.getCurrent();
 }
 
 qint64 UDPLink::getMaxUpstream() {
-    return 0; // TODO
+    QMutexLocker locker(&statisticsMutex);
+    upstream.update(bitsSentTotal, MG::TIME::getGroundTimeNow());
+    return upstream.getMax();
 }
 
 qint64 UDPLink::getBitsSent() {
@@ -267,18 +421,22 @@ qint64 UDPLink::getBitsReceived() {
 }
 
 qint64 UDPLink::getTotalDownstream() {
-    statisticsMutex.lock();
-    qint64 totalDownstream = bitsReceivedTotal / ((MG::TIME::getGroundTimeNow() - connectionStartTime) / 1000);
-    statisticsMutex.unlock();
-    return totalDownstream;
+    QMutexLocker locker(&statisticsMutex);
+    quint64 seconds = (MG::TIME::getGroundTimeNow() - connectionStartTime) / 1000;
+    if (seconds == 0) return 0;
+    return bitsReceivedTotal / seconds;
 }
 
 qint64 UDPLink::getCurrentDownstream() {
-    return 0; // TODO
+    QMutexLocker locker(&statisticsMutex);
+    downstream.update(bitsReceivedTotal, MG::TIME::getGroundTimeNow());
+    return downstream.getCurrent();
 }
 
 qint64 UDPLink::getMaxDownstream() {
-    return 0; // TODO
+    QMutexLocker locker(&statisticsMutex);
+    downstream.update(bitsReceivedTotal, MG::TIME::getGroundTimeNow());
+    return downstream.getMax();
 }
 
 bool UDPLink::isFullDuplex() {
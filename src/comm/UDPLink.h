@@ -34,9 +34,12 @@ This file is part of the PIXHAWK project
 #include <QString>
 #include <QList>
 #include <QMap>
+#include <QHash>
+#include <QVector>
 #include <QMutex>
 #include <QUdpSocket>
 #include <LinkInterface.h>
+#include <LinkRate.h>
 #include <configuration.h>
 
 class UDPLink : public LinkInterface
@@ -78,6 +81,9 @@ public:
     int getLinkQuality();
     bool isFullDuplex();
     int getId();
+    bool setReceiveBuffer(LinkRingBuffer* buffer);
+    /** @brief Send only to the peer the system was last heard from, to all peers if unknown */
+    void writeBytesToSystem(int systemId, const char* data, qint64 size);
 
 public slots:
     void setAddress(QString address);
@@ -102,21 +108,36 @@ protected:
     int id;
     QUdpSocket* socket;
     bool connectState;
-    QList<QHostAddress>* hosts;
-    //    QMap<QHostAddress, quint16>* ports;
-    QList<quint16>* ports;
+
+    /** @brief Remote end which sent datagrams to this link */
+    struct Peer
+    {
+        QHostAddress address;
+        quint16 port;
+        quint64 lastHeard;          ///< Ground time in ms of the last datagram of the peer
+    };
+    QVector<Peer> peers;            ///< All peers heard so far, the broadcast targets
+    QHash<quint64, int> peerIndex;  ///< Index into peers by peerKey()
+    int systemPeers[256];           ///< Index into peers of the peer a system was last heard from, -1 if unknown
+    quint64 lastExpiry;             ///< Ground time in ms peers were last checked for expiry
 
     quint64 bitsSentTotal;
-    quint64 bitsSentCurrent;
-    quint64 bitsSentMax;
+    LinkRate upstream;          ///< Sliding window rate of bitsSentTotal
     quint64 bitsReceivedTotal;
-    quint64 bitsReceivedCurrent;
-    quint64 bitsReceivedMax;
+    LinkRate downstream;        ///< Sliding window rate of bitsReceivedTotal
     quint64 connectionStartTime;
     QMutex statisticsMutex;
     QMutex dataMutex;
 
     void setName(QString name);
+    /** @brief Read one pending datagram */
+    void readDatagram();
+    /** @brief Register the sender as peer and as route to the systems of the valid frames in the datagram */
+    void updateRoutes(const char* data, qint64 length, const QHostAddress& sender, quint16 senderPort);
+    /** @brief Remove the peers not heard for UDP_PEER_TIMEOUT, has to be called with dataMutex locked */
+    void expirePeers(quint64 now);
+    /** @brief Hash key of a peer address and port */
+    static quint64 peerKey(const QHostAddress& address, quint16 port);
 
 signals:
     // Signals are defined by LinkInterface
@@ -4,9 +4,27 @@
 /** @brief Polling interval in ms */
 #define SERIAL_POLL_INTERVAL 2
 
+/** @brief Maximum time in ms an event driven serial reader sleeps without bytes */
+#define SERIAL_WAIT_TIMEOUT 100
+
+/** @brief Bytes waiting for a serial port above which the link signals backpressure */
+#define SERIAL_WRITE_HIGH_WATER 4096
+
+/** @brief Time in ms after which a silent UDP peer is no longer sent to */
+#define UDP_PEER_TIMEOUT 10000
+
 /** @brief Heartbeat emission rate, in Hertz (times per second) */
 #define MAVLINK_HEARTBEAT_DEFAULT_RATE 1
 
+/** @brief Worker threads the vehicles are sharded over, -1 for one per core, 0 to run them in the GUI thread */
+#define UAS_WORKER_THREADS -1
+
+/** @brief Interval in ms at which the coalesced vehicle state is published to the widgets */
+#define UAS_SNAPSHOT_INTERVAL 40
+
+/** @brief Longest time in ms the mission log keeps values in memory before they are written */
+#define MISSIONLOG_WINDOW 1000
+
 #define WITH_TEXT_TO_SPEECH 1
 
 #define QGC_APPLICATION_NAME "QGroundControl"
@@ -0,0 +1,105 @@
+#-------------------------------------------------
+#
+# QGroundControl - Micro Air Vehicle Groundstation
+#
+# Please see our website at <http://qgroundcontrol.org>
+#
+# Author:
+# Lorenz Meier <mavteam@student.ethz.ch>
+#
+# (c) 2009-2010 PIXHAWK Team
+#
+# This file is part of the mav groundstation project
+# QGroundControl is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+# QGroundControl is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+# You should have received a copy of the GNU General Public License
+# along with QGroundControl. If not, see <http://www.gnu.org/licenses/>.
+#
+#-------------------------------------------------
+
+# Communication and vehicle core of QGroundControl. These files do not
+# depend on any widget, they are shared by the groundstation, the
+# qgroundcontrol-core library and the headless server. Build with
+# DEFINES += QGC_NO_GUI to strip the remaining dialogs and audio output.
+
+CORE_DIR = $$PWD
+
+INCLUDEPATH += $$CORE_DIR \
+    $$CORE_DIR/uas \
+    $$CORE_DIR/comm
+
+HEADERS += $$CORE_DIR/MG.h \
+    $$CORE_DIR/QGC.h \
+    $$CORE_DIR/configuration.h \
+    $$CORE_DIR/Waypoint.h \
+    $$CORE_DIR/MissionLog.h \
+    $$CORE_DIR/uas/UASInterface.h \
+    $$CORE_DIR/uas/UAS.h \
+    $$CORE_DIR/uas/UASManager.h \
+    $$CORE_DIR/uas/UASWaypointManager.h \
+    $$CORE_DIR/uas/UASStreamRateController.h \
+    $$CORE_DIR/uas/UASChannelRegistry.h \
+    $$CORE_DIR/uas/UASValueFrame.h \
+    $$CORE_DIR/uas/UASStateSnapshot.h \
+    $$CORE_DIR/uas/UASWorkerPool.h \
+    $$CORE_DIR/uas/SlugsMAV.h \
+    $$CORE_DIR/uas/PxQuadMAV.h \
+    $$CORE_DIR/uas/ArduPilotMAV.h \
+    $$CORE_DIR/comm/LinkManager.h \
+    $$CORE_DIR/comm/LinkInterface.h \
+    $$CORE_DIR/comm/SerialLinkInterface.h \
+    $$CORE_DIR/comm/SerialLink.h \
+    $$CORE_DIR/comm/UDPLink.h \
+    $$CORE_DIR/comm/LogReplayLink.h \
+    $$CORE_DIR/comm/ProtocolInterface.h \
+    $$CORE_DIR/comm/MAVLinkProtocol.h \
+    $$CORE_DIR/comm/MAVLinkDecoder.h \
+    $$CORE_DIR/comm/LinkRingBuffer.h \
+    $$CORE_DIR/comm/MAVLinkFrameScanner.h \
+    $$CORE_DIR/comm/MAVLinkDispatcher.h \
+    $$CORE_DIR/comm/MAVLinkForwarder.h \
+    $$CORE_DIR/comm/MAVLinkStatistics.h \
+    $$CORE_DIR/comm/MAVLinkScheduler.h \
+    $$CORE_DIR/comm/MAVLinkDeduplicator.h \
+    $$CORE_DIR/comm/MAVLinkMessagePool.h \
+    $$CORE_DIR/comm/MAVLinkSubscriber.h \
+    $$CORE_DIR/comm/LinkRate.h \
+    $$CORE_DIR/comm/MAVLinkLogWriter.h \
+    $$CORE_DIR/comm/MAVLinkLogReader.h
+
+SOURCES += $$CORE_DIR/QGC.cc \
+    $$CORE_DIR/Waypoint.cc \
+    $$CORE_DIR/MissionLog.cc \
+    $$CORE_DIR/uas/UAS.cc \
+    $$CORE_DIR/uas/UASManager.cc \
+    $$CORE_DIR/uas/UASWaypointManager.cc \
+    $$CORE_DIR/uas/UASStreamRateController.cc \
+    $$CORE_DIR/uas/UASChannelRegistry.cc \
+    $$CORE_DIR/uas/UASWorkerPool.cc \
+    $$CORE_DIR/uas/SlugsMAV.cc \
+    $$CORE_DIR/uas/PxQuadMAV.cc \
+    $$CORE_DIR/uas/ArduPilotMAV.cc \
+    $$CORE_DIR/comm/LinkManager.cc \
+    $$CORE_DIR/comm/SerialLink.cc \
+    $$CORE_DIR/comm/UDPLink.cc \
+    $$CORE_DIR/comm/LogReplayLink.cc \
+    $$CORE_DIR/comm/MAVLinkProtocol.cc \
+    $$CORE_DIR/comm/MAVLinkDecoder.cc \
+    $$CORE_DIR/comm/LinkRingBuffer.cc \
+    $$CORE_DIR/comm/MAVLinkFrameScanner.cc \
+    $$CORE_DIR/comm/MAVLinkDispatcher.cc \
+    $$CORE_DIR/comm/MAVLinkForwarder.cc \
+    $$CORE_DIR/comm/MAVLinkStatistics.cc \
+    $$CORE_DIR/comm/MAVLinkScheduler.cc \
+    $$CORE_DIR/comm/MAVLinkDeduplicator.cc \
+    $$CORE_DIR/comm/MAVLinkMessagePool.cc \
+    $$CORE_DIR/comm/MAVLinkSubscriber.cc \
+    $$CORE_DIR/comm/LinkRate.cc \
+    $$CORE_DIR/comm/MAVLinkLogWriter.cc \
+    $$CORE_DIR/comm/MAVLinkLogReader.cc
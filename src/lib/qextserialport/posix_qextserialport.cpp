@@ -67,6 +67,8 @@ Posix_QextSerialPort::Posix_QextSerialPort(const Posix_QextSerialPort& s)
     memcpy(&Posix_Timeout, &s.Posix_Timeout, sizeof(struct timeval));
     memcpy(&Posix_Copy_Timeout, &s.Posix_Copy_Timeout, sizeof(struct timeval));
     memcpy(&Posix_CommConfig, &s.Posix_CommConfig, sizeof(struct termios));
+    setQueryMode(s.queryMode());
+    initWakePipe();
 }
 
 /*!
@@ -143,8 +145,28 @@ Posix_QextSerialPort& Posix_QextSerialPort::operator=(const Posix_QextSerialPort
 void Posix_QextSerialPort::init()
 {
 	fd = 0;
-	if (queryMode() == QextSerialBase::EventDriven)
-		qWarning("POSIX doesn't have event driven mechanism implemented yet");
+	initWakePipe();
+}
+
+/*!
+\fn void Posix_QextSerialPort::initWakePipe()
+In event driven mode a reading thread sleeps in waitForReadyRead() until bytes arrive. The
+pipe allows other threads to wake it up, e.g. when the port is closed.
+*/
+void Posix_QextSerialPort::initWakePipe()
+{
+	wakePipe[0] = -1;
+	wakePipe[1] = -1;
+	if (queryMode() == QextSerialBase::EventDriven) {
+		if (pipe(wakePipe) == -1) {
+			qWarning("could not create wake pipe: %s", strerror(errno));
+			wakePipe[0] = -1;
+			wakePipe[1] = -1;
+			return;
+		}
+		fcntl(wakePipe[0], F_SETFL, O_NONBLOCK);
+		fcntl(wakePipe[1], F_SETFL, O_NONBLOCK);
+	}
 }
 
 /*!
@@ -156,6 +178,10 @@ Posix_QextSerialPort::~Posix_QextSerialPort()
     if (isOpen()) {
         close();
     }
+    if (wakePipe[0] != -1) {
+        ::close(wakePipe[0]);
+        ::close(wakePipe[1]);
+    }
 }
 
 /*!
@@ -896,6 +922,8 @@ void Posix_QextSerialPort::close()
 	QIODevice::close();	// Flag the device as closed
 	// QIODevice::close() doesn't actually close the port, so do that here
 	::close(fd);
+	// Return a thread sleeping in waitForReadyRead() on the closed port
+	wakeUp();
     }
     UNLOCK_MUTEX();
 }
@@ -950,6 +978,69 @@ qint64 Posix_QextSerialPort::bytesAvailable() const
     return 0;
 }
 
+/*!
+\fn bool Posix_QextSerialPort::waitForReadyRead(int msecs)
+Blocks in poll() until bytes arrive at the port, at most msecs milliseconds (-1 waits without
+timeout). In event driven mode the wait can be interrupted by wakeUp(), which close() calls.
+The port mutex is not held while waiting, so other threads can write to the port meanwhile.
+Returns true if bytes can be read.  If the line hung up, the remaining time is waited on the
+wake pipe only, so a calling loop does not spin on the port.
+*/
+bool Posix_QextSerialPort::waitForReadyRead(int msecs)
+{
+    LOCK_MUTEX();
+    if (!isOpen()) {
+        UNLOCK_MUTEX();
+        return false;
+    }
+    if (QIODevice::bytesAvailable() > 0) {
+        UNLOCK_MUTEX();
+        return true;
+    }
+    struct pollfd fds[2];
+    fds[0].fd = fd;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = wakePipe[0];
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+    nfds_t count = (wakePipe[0] != -1) ? 2 : 1;
+    UNLOCK_MUTEX();
+
+    int ready = poll(fds, count, msecs);
+    if (ready <= 0)
+        return false;
+    if (count == 2 && (fds[1].revents & POLLIN)) {
+        // Drain the wake-up requests
+        char buffer[16];
+        while (::read(wakePipe[0], buffer, sizeof(buffer)) > 0);
+    }
+    if (fds[0].revents & POLLIN)
+        return true;
+    if ((fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) && count == 2 && !(fds[1].revents & POLLIN)) {
+        LOCK_MUTEX();
+        lastErr = E_READ_FAILED;
+        UNLOCK_MUTEX();
+        poll(&fds[1], 1, msecs);
+    }
+    return false;
+}
+
+/*!
+\fn void Posix_QextSerialPort::wakeUp()
+Returns a thread waiting in waitForReadyRead() immediately.  Only available in event driven
+mode, in polling mode this function has no effect.
+*/
+void Posix_QextSerialPort::wakeUp()
+{
+    if (wakePipe[1] != -1) {
+        char c = 0;
+        if (::write(wakePipe[1], &c, 1) == -1) {
+            // The pipe is full, a wake-up is pending anyway
+        }
+    }
+}
+
 /*!
 \fn void Posix_QextSerialPort::ungetChar(char)
 This function is included to implement the full QIODevice interface, and currently has no
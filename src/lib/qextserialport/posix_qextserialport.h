@@ -8,6 +8,7 @@
 #include <sys/time.h>
 #include <sys/ioctl.h>
 #include <sys/select.h>
+#include <poll.h>
 #include "qextserialbase.h"
 
 class Posix_QextSerialPort:public QextSerialBase 
@@ -17,6 +18,10 @@ class Posix_QextSerialPort:public QextSerialBase
 	     * This method is a part of constructor.
 	     */
 	    void init();
+	    /*!
+	     * Creates the pipe used to interrupt waitForReadyRead() in event driven mode.
+	     */
+	    void initWakePipe();
 
 	protected:
 	    int fd;
@@ -24,6 +29,7 @@ class Posix_QextSerialPort:public QextSerialBase
 	    struct termios old_termios;
 	    struct timeval Posix_Timeout;
 	    struct timeval Posix_Copy_Timeout;
+	    int wakePipe[2];
 	
 	    virtual qint64 readData(char * data, qint64 maxSize);
 	    virtual qint64 writeData(const char * data, qint64 maxSize);
@@ -50,6 +56,8 @@ class Posix_QextSerialPort:public QextSerialBase
 	
 	    virtual qint64 size() const;
 	    virtual qint64 bytesAvailable() const;
+	    virtual bool waitForReadyRead(int msecs);
+	    virtual void wakeUp();
 	
 	    virtual void ungetChar(char c);
 	
@@ -61,10 +61,7 @@ void PxMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
         {
             mavlink_debug_vect_t vect;
             mavlink_msg_debug_vect_decode(msg, &vect);
-            QString str((const char*)vect.name);
-            emit valueChanged(uasId, str+".x", vect.x, MG::TIME::getGroundTimeNow());
-            emit valueChanged(uasId, str+".y", vect.y, MG::TIME::getGroundTimeNow());
-            emit valueChanged(uasId, str+".z", vect.z, MG::TIME::getGroundTimeNow());
+            emitVector((const char*)vect.name, vect.x, vect.y, vect.z, MG::TIME::getGroundTimeNow());
         }
         break;
     case MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE:
@@ -72,17 +69,17 @@ void PxMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
             mavlink_vision_position_estimate_t pos;
             mavlink_msg_vision_position_estimate_decode(&message, &pos);
             quint64 time = getUnixTime(pos.usec);
-            emit valueChanged(uasId, "vis. time", pos.usec, time);
-            emit valueChanged(uasId, "vis. roll", pos.roll, time);
-            emit valueChanged(uasId, "vis. pitch", pos.pitch, time);
-            emit valueChanged(uasId, "vis. yaw", pos.yaw, time);
-            emit valueChanged(uasId, "vis. x", pos.x, time);
-            emit valueChanged(uasId, "vis. y", pos.y, time);
-            emit valueChanged(uasId, "vis. z", pos.z, time);
-            emit valueChanged(uasId, "vis. vx", pos.vx, time);
-            emit valueChanged(uasId, "vis. vy", pos.vy, time);
-            emit valueChanged(uasId, "vis. vz", pos.vz, time);
-            emit valueChanged(uasId, "vis. vyaw", pos.vyaw, time);
+            emitValue("vis. time", pos.usec, time);
+            emitValue("vis. roll", pos.roll, time);
+            emitValue("vis. pitch", pos.pitch, time);
+            emitValue("vis. yaw", pos.yaw, time);
+            emitValue("vis. x", pos.x, time);
+            emitValue("vis. y", pos.y, time);
+            emitValue("vis. z", pos.z, time);
+            emitValue("vis. vx", pos.vx, time);
+            emitValue("vis. vy", pos.vy, time);
+            emitValue("vis. vz", pos.vz, time);
+            emitValue("vis. vyaw", pos.vyaw, time);
             // Set internal state
             if (!positionLock)
             {
@@ -96,6 +93,7 @@ void PxMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
         // Do nothing
         break;
     }
+    emitFrame();
 }
 
 void PxMAV::sendProcessCommand(int watchdogId, int processId, unsigned int command)
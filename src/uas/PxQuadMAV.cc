@@ -22,7 +22,6 @@ This file is part of the QGROUNDCONTROL project
 ======================================================================*/
 
 #include "PxQuadMAV.h"
-#include "GAudioOutput.h"
 
 PxQuadMAV::PxQuadMAV(MAVLinkProtocol* mavlink, int id) :
         UAS(mavlink, id)
@@ -60,8 +59,8 @@ void PxQuadMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 mavlink_raw_aux_t raw;
                 mavlink_msg_raw_aux_decode(&message, &raw);
                 quint64 time = getUnixTime(0);
-                emit valueChanged(uasId, "Pressure", raw.baro, time);
-                emit valueChanged(uasId, "Temperature", raw.temp, time);
+                emitValue("Pressure", raw.baro, time);
+                emitValue("Temperature", raw.temp, time);
             }
             break;
         case MAVLINK_MSG_ID_PATTERN_DETECTED:
@@ -108,11 +107,8 @@ void PxQuadMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
             {
                 mavlink_debug_vect_t vect;
                 mavlink_msg_debug_vect_decode(msg, &vect);
-                QString str((const char*)vect.name);
                 quint64 time = getUnixTime(vect.usec);
-                emit valueChanged(uasId, str+".x", vect.x, time);
-                emit valueChanged(uasId, str+".y", vect.y, time);
-                emit valueChanged(uasId, str+".z", vect.z, time);
+                emitVector((const char*)vect.name, vect.x, vect.y, vect.z, time);
             }
             break;
     case MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE:
@@ -120,13 +116,13 @@ void PxQuadMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 mavlink_vision_position_estimate_t pos;
                 mavlink_msg_vision_position_estimate_decode(&message, &pos);
                 quint64 time = getUnixTime(pos.usec);
-                //emit valueChanged(uasId, "vis. time", pos.usec, time);
-                emit valueChanged(uasId, "vis. roll", pos.roll, time);
-                emit valueChanged(uasId, "vis. pitch", pos.pitch, time);
-                emit valueChanged(uasId, "vis. yaw", pos.yaw, time);
-                emit valueChanged(uasId, "vis. x", pos.x, time);
-                emit valueChanged(uasId, "vis. y", pos.y, time);
-                emit valueChanged(uasId, "vis. z", pos.z, time);
+                //emitValue("vis. time", pos.usec, time);
+                emitValue("vis. roll", pos.roll, time);
+                emitValue("vis. pitch", pos.pitch, time);
+                emitValue("vis. yaw", pos.yaw, time);
+                emitValue("vis. x", pos.x, time);
+                emitValue("vis. y", pos.y, time);
+                emitValue("vis. z", pos.z, time);
             }
             break;
     case MAVLINK_MSG_ID_AUX_STATUS:
@@ -166,6 +162,7 @@ void PxQuadMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
     }
 
 #endif
+    emitFrame();
 }
 
 void PxQuadMAV::sendProcessCommand(int watchdogId, int processId, unsigned int command)
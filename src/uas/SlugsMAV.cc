@@ -61,9 +61,9 @@ void SlugsMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
             quint64 time = getUnixTime(0);
             mavlink_msg_cpu_load_decode(&message,&cpu_load);
 
-                emit valueChanged(uasId, tr("SensorDSC Load"), cpu_load.sensLoad, time);
-                emit valueChanged(uasId, tr("ControlDSC Load"), cpu_load.ctrlLoad, time);
-                emit valueChanged(uasId, tr("Battery Volt"), cpu_load.batVolt, time);
+                emitValue("SensorDSC Load", cpu_load.sensLoad, time);
+                emitValue("ControlDSC Load", cpu_load.ctrlLoad, time);
+                emitValue("Battery Volt", cpu_load.batVolt, time);
 
             break;
         }
@@ -72,9 +72,9 @@ void SlugsMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
             mavlink_air_data_t air_data;
             quint64 time = getUnixTime(0);
             mavlink_msg_air_data_decode(&message,&air_data);
-                emit valueChanged(uasId, tr("Dynamic Pressure"), air_data.dynamicPressure,time);
-                emit valueChanged(uasId, tr("Static Pressure"),air_data.staticPressure, time);
-                emit valueChanged(uasId, tr("Temp"),air_data.temperature,time);
+                emitValue("Dynamic Pressure", air_data.dynamicPressure,time);
+                emitValue("Static Pressure", air_data.staticPressure, time);
+                emitValue("Temp", air_data.temperature,time);
 
             break;
         }
@@ -83,12 +83,12 @@ void SlugsMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
             mavlink_sensor_bias_t sensor_bias;
             quint64 time = getUnixTime(0);
             mavlink_msg_sensor_bias_decode(&message,&sensor_bias);
-                emit valueChanged(uasId,tr("Ax Bias"),sensor_bias.axBias, time);
-                emit valueChanged(uasId,tr("Ay Bias"),sensor_bias.ayBias,time);
-                emit valueChanged(uasId,tr("Az Bias"),sensor_bias.azBias,time);
-                emit valueChanged(uasId,tr("Gx Bias"),sensor_bias.gxBias,time);
-                emit valueChanged(uasId,tr("Gy Bias"),sensor_bias.gyBias,time);
-                emit valueChanged(uasId,tr("Gz Bias"),sensor_bias.gzBias,time);
+                emitValue("Ax Bias", sensor_bias.axBias, time);
+                emitValue("Ay Bias", sensor_bias.ayBias,time);
+                emitValue("Az Bias", sensor_bias.azBias,time);
+                emitValue("Gx Bias", sensor_bias.gxBias,time);
+                emitValue("Gy Bias", sensor_bias.gyBias,time);
+                emitValue("Gz Bias", sensor_bias.gzBias,time);
 
             break;
         }
@@ -97,12 +97,12 @@ void SlugsMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
             mavlink_diagnostic_t diagnostic;
             quint64 time = getUnixTime(0);
             mavlink_msg_diagnostic_decode(&message,&diagnostic);
-                emit valueChanged(uasId,tr("Diag F1"),diagnostic.diagFl1,time);
-                emit valueChanged(uasId,tr("Diag F2"),diagnostic.diagFl2,time);
-                emit valueChanged(uasId,tr("Diag F3"),diagnostic.diagFl3,time);
-                emit valueChanged(uasId,tr("Diag S1"),diagnostic.diagSh1,time);
-                emit valueChanged(uasId,tr("Diag S2"),diagnostic.diagSh2,time);
-                emit valueChanged(uasId,tr("Diag S3"),diagnostic.diagSh3,time);
+                emitValue("Diag F1", diagnostic.diagFl1,time);
+                emitValue("Diag F2", diagnostic.diagFl2,time);
+                emitValue("Diag F3", diagnostic.diagFl3,time);
+                emitValue("Diag S1", diagnostic.diagSh1,time);
+                emitValue("Diag S2", diagnostic.diagSh2,time);
+                emitValue("Diag S3", diagnostic.diagSh3,time);
 
             break;
         }
@@ -111,11 +111,11 @@ void SlugsMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
             mavlink_pilot_console_t pilot;
             quint64 time = getUnixTime(0);
             mavlink_msg_pilot_console_decode(&message,&pilot);
-                emit valueChanged(uasId,"dt",pilot.dt,time);
-                emit valueChanged(uasId,"dla",pilot.dla,time);
-                emit valueChanged(uasId,"dra",pilot.dra,time);
-                emit valueChanged(uasId,"dr",pilot.dr,time);
-                emit valueChanged(uasId,"de",pilot.de,time);
+                emitValue("dt", pilot.dt,time);
+                emitValue("dla", pilot.dla,time);
+                emitValue("dra", pilot.dra,time);
+                emitValue("dr", pilot.dr,time);
+                emitValue("de", pilot.de,time);
 
             break;
         }
@@ -124,16 +124,16 @@ void SlugsMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
             mavlink_pwm_commands_t pwm;
             quint64 time = getUnixTime(0);
             mavlink_msg_pwm_commands_decode(&message,&pwm);
-                emit valueChanged(uasId,"dt_c",pwm.dt_c,time);
-                emit valueChanged(uasId,"dla_c",pwm.dla_c,time);
-                emit valueChanged(uasId,"dra_c",pwm.dra_c,time);
-                emit valueChanged(uasId,"dr_c",pwm.dr_c,time);
-                emit valueChanged(uasId,"dle_c",pwm.dle_c,time);
-                emit valueChanged(uasId,"dre_c",pwm.dre_c,time);
-                emit valueChanged(uasId,"dlf_c",pwm.dlf_c,time);
-                emit valueChanged(uasId,"drf_c",pwm.drf_c,time);
-                emit valueChanged(uasId,"da1_c",pwm.aux1,time);
-                emit valueChanged(uasId,"da2_c",pwm.aux2,time);
+                emitValue("dt_c", pwm.dt_c,time);
+                emitValue("dla_c", pwm.dla_c,time);
+                emitValue("dra_c", pwm.dra_c,time);
+                emitValue("dr_c", pwm.dr_c,time);
+                emitValue("dle_c", pwm.dle_c,time);
+                emitValue("dre_c", pwm.dre_c,time);
+                emitValue("dlf_c", pwm.dlf_c,time);
+                emitValue("drf_c", pwm.drf_c,time);
+                emitValue("da1_c", pwm.aux1,time);
+                emitValue("da2_c", pwm.aux2,time);
 
 
             break;
@@ -144,4 +144,5 @@ void SlugsMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
         qDebug() << "\nSLUGS RECEIVED MESSAGE WITH ID" << message.msgid;
         break;
     }
+    emitFrame();
 }
@@ -30,7 +30,9 @@ This file is part of the QGROUNDCONTROL project
  */
 
 #include <QList>
+#ifndef QGC_NO_GUI
 #include <QMessageBox>
+#endif
 #include <QTimer>
 #include <iostream>
 #include <QDebug>
@@ -40,7 +42,10 @@ This file is part of the QGROUNDCONTROL project
 #include "UASManager.h"
 #include "MG.h"
 #include "QGC.h"
+#include "configuration.h"
+#ifndef QGC_NO_GUI
 #include "GAudioOutput.h"
+#endif
 #include "MAVLinkProtocol.h"
 #include <mavlink.h>
 
@@ -53,6 +58,7 @@ UAS::UAS(MAVLinkProtocol* protocol, int id) : UASInterface(),
         unknownPackets(),
         mavlink(protocol),
         waypointManager(*this),
+        rateController(*this),
         thrustSum(0),
         thrustMax(10),
         startVoltage(0),
@@ -73,12 +79,26 @@ UAS::UAS(MAVLinkProtocol* protocol, int id) : UASInterface(),
         sendDropRate(0),
         lowBattAlarm(false),
         positionLock(false),
-        statusTimeout(new QTimer(this))
+        statusTimeout(new QTimer(this)),
+        snapshotTimer(new QTimer(this))
 {
+    // The signals are delivered from the worker thread to the widgets by
+    // queued connections, all other argument types are built into Qt
+    qRegisterMetaType<UASValueFrame>("UASValueFrame");
+    qRegisterMetaType<UASStateSnapshot>("UASStateSnapshot");
+    qRegisterMetaType<UASInterface*>("UASInterface*");
+    qRegisterMetaType<UASInterface::CommStatus>("CommStatus");
+    frame.uasId = uasId;
+    snapshot.uasId = uasId;
+    // The members move with the UAS when it is handed to a worker thread
+    waypointManager.setParent(this);
+    rateController.setParent(this);
     color = UASInterface::getNextColor();
     setBattery(LIPOLY, 3);
     statusTimeout->setInterval(500);
     connect(statusTimeout, SIGNAL(timeout()), this, SLOT(updateState()));
+    connect(snapshotTimer, SIGNAL(timeout()), this, SLOT(emitSnapshot()));
+    snapshotTimer->start(UAS_SNAPSHOT_INTERVAL);
 }
 
 UAS::~UAS()
@@ -101,10 +121,12 @@ void UAS::updateState()
     }
     else
     {
+#ifndef QGC_NO_GUI
         if (mode > (uint8_t)MAV_MODE_LOCKED && positionLock)
         {
-            GAudioOutput::instance()->notifyNegative();
+            QMetaObject::invokeMethod(GAudioOutput::instance(), "notifyNegative", Qt::QueuedConnection);
         }
+#endif
     }
 }
 
@@ -218,6 +240,10 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 timeRemaining = calculateTimeRemaining();
                 //qDebug() << "Voltage: " << currentVoltage << " Chargelevel: " << getChargeLevel() << " Time remaining " << timeRemaining;
                 emit batteryChanged(this, lpVoltage, getChargeLevel(), timeRemaining);
+                snapshot.voltage = lpVoltage;
+                snapshot.charge = getChargeLevel();
+                snapshot.secondsRemaining = timeRemaining;
+                snapshot.fields |= UASStateSnapshot::BATTERY;
                 emit voltageChanged(message.sysid, state.vbat/1000.0f);
 
                 // LOW BATTERY ALARM
@@ -233,6 +259,8 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
 
                 // COMMUNICATIONS DROP RATE
                 emit dropRateChanged(this->getUASID(), state.packet_drop);
+                snapshot.dropRate = state.packet_drop;
+                snapshot.fields |= UASStateSnapshot::STATUS;
                 //qDebug() << __FILE__ << __LINE__ << "RCV LOSS: " << state.packet_drop;
 
                 // AUDIO
@@ -246,15 +274,17 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                     // Output the one message
                     audiostring += modeAudio + stateAudio;
                 }
+#ifndef QGC_NO_GUI
                 if ((int)state.status == (int)MAV_STATE_CRITICAL || state.status == (int)MAV_STATE_EMERGENCY)
                 {
-                    GAudioOutput::instance()->startEmergency();
+                    QMetaObject::invokeMethod(GAudioOutput::instance(), "startEmergency", Qt::QueuedConnection);
                 }
                 else if (modechanged || statechanged)
                 {
-                    GAudioOutput::instance()->stopEmergency();
-                    GAudioOutput::instance()->say(audiostring);
+                    QMetaObject::invokeMethod(GAudioOutput::instance(), "stopEmergency", Qt::QueuedConnection);
+                    QMetaObject::invokeMethod(GAudioOutput::instance(), "say", Qt::QueuedConnection, Q_ARG(QString, audiostring));
                 }
+#endif
             }
             break;
         case MAVLINK_MSG_ID_RAW_IMU:
@@ -263,15 +293,15 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 mavlink_msg_raw_imu_decode(&message, &raw);
                 quint64 time = getUnixTime(raw.usec);
 
-                emit valueChanged(uasId, "Accel. X", raw.xacc, time);
-                emit valueChanged(uasId, "Accel. Y", raw.yacc, time);
-                emit valueChanged(uasId, "Accel. Z", raw.zacc, time);
-                emit valueChanged(uasId, "Gyro Phi", raw.xgyro, time);
-                emit valueChanged(uasId, "Gyro Theta", raw.ygyro, time);
-                emit valueChanged(uasId, "Gyro Psi", raw.zgyro, time);
-                emit valueChanged(uasId, "Mag. X", raw.xmag, time);
-                emit valueChanged(uasId, "Mag. Y", raw.ymag, time);
-                emit valueChanged(uasId, "Mag. Z", raw.zmag, time);
+                emitValue("Accel. X", raw.xacc, time);
+                emitValue("Accel. Y", raw.yacc, time);
+                emitValue("Accel. Z", raw.zacc, time);
+                emitValue("Gyro Phi", raw.xgyro, time);
+                emitValue("Gyro Theta", raw.ygyro, time);
+                emitValue("Gyro Psi", raw.zgyro, time);
+                emitValue("Mag. X", raw.xmag, time);
+                emitValue("Mag. Y", raw.ymag, time);
+                emitValue("Mag. Z", raw.zmag, time);
             }
             break;
         case MAVLINK_MSG_ID_ATTITUDE:
@@ -281,16 +311,24 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 mavlink_attitude_t attitude;
                 mavlink_msg_attitude_decode(&message, &attitude);
                 quint64 time = getUnixTime(attitude.usec);
-                emit valueChanged(uasId, "roll IMU", mavlink_msg_attitude_get_roll(&message), time);
-                emit valueChanged(uasId, "pitch IMU", mavlink_msg_attitude_get_pitch(&message), time);
-                emit valueChanged(uasId, "yaw IMU", mavlink_msg_attitude_get_yaw(&message), time);
-                emit valueChanged(this, "roll IMU", mavlink_msg_attitude_get_roll(&message), time);
-                emit valueChanged(this, "pitch IMU", mavlink_msg_attitude_get_pitch(&message), time);
-                emit valueChanged(this, "yaw IMU", mavlink_msg_attitude_get_yaw(&message), time);
-                emit valueChanged(uasId, "rollspeed IMU", attitude.rollspeed, time);
-                emit valueChanged(uasId, "pitchspeed IMU", attitude.pitchspeed, time);
-                emit valueChanged(uasId, "yawspeed IMU", attitude.yawspeed, time);
+                emitValue("roll IMU", mavlink_msg_attitude_get_roll(&message), time);
+                emitValue("pitch IMU", mavlink_msg_attitude_get_pitch(&message), time);
+                emitValue("yaw IMU", mavlink_msg_attitude_get_yaw(&message), time);
+                if (receivers(SIGNAL(valueChanged(UASInterface*,QString,double,quint64))) > 0)
+                {
+                    emit valueChanged(this, "roll IMU", mavlink_msg_attitude_get_roll(&message), time);
+                    emit valueChanged(this, "pitch IMU", mavlink_msg_attitude_get_pitch(&message), time);
+                    emit valueChanged(this, "yaw IMU", mavlink_msg_attitude_get_yaw(&message), time);
+                }
+                emitValue("rollspeed IMU", attitude.rollspeed, time);
+                emitValue("pitchspeed IMU", attitude.pitchspeed, time);
+                emitValue("yawspeed IMU", attitude.yawspeed, time);
                 emit attitudeChanged(this, mavlink_msg_attitude_get_roll(&message), mavlink_msg_attitude_get_pitch(&message), mavlink_msg_attitude_get_yaw(&message), time);
+                snapshot.roll = mavlink_msg_attitude_get_roll(&message);
+                snapshot.pitch = mavlink_msg_attitude_get_pitch(&message);
+                snapshot.yaw = mavlink_msg_attitude_get_yaw(&message);
+                snapshot.attitudeTime = time;
+                snapshot.fields |= UASStateSnapshot::ATTITUDE;
             }
             break;
         case MAVLINK_MSG_ID_LOCAL_POSITION:
@@ -300,21 +338,32 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 mavlink_local_position_t pos;
                 mavlink_msg_local_position_decode(&message, &pos);
                 quint64 time = getUnixTime(pos.usec);
-                emit valueChanged(uasId, "x", pos.x, time);
-                emit valueChanged(uasId, "y", pos.y, time);
-                emit valueChanged(uasId, "z", pos.z, time);
-                emit valueChanged(uasId, "Vx", pos.vx, time);
-                emit valueChanged(uasId, "Vy", pos.vy, time);
-                emit valueChanged(uasId, "Vz", pos.vz, time);
+                emitValue("x", pos.x, time);
+                emitValue("y", pos.y, time);
+                emitValue("z", pos.z, time);
+                emitValue("Vx", pos.vx, time);
+                emitValue("Vy", pos.vy, time);
+                emitValue("Vz", pos.vz, time);
                 emit localPositionChanged(this, pos.x, pos.y, pos.z, time);
                 emit speedChanged(this, pos.vx, pos.vy, pos.vz, time);
+                snapshot.x = pos.x;
+                snapshot.y = pos.y;
+                snapshot.z = pos.z;
+                snapshot.localTime = time;
+                snapshot.vx = pos.vx;
+                snapshot.vy = pos.vy;
+                snapshot.vz = pos.vz;
+                snapshot.speedTime = time;
+                snapshot.fields |= UASStateSnapshot::LOCAL_POSITION | UASStateSnapshot::SPEED;
                 //emit attitudeChanged(this, pos.roll, pos.pitch, pos.yaw, time);
                 // Set internal state
+#ifndef QGC_NO_GUI
                 if (!positionLock)
                 {
                     // If position was not locked before, notify positive
-                    GAudioOutput::instance()->notifyPositive();
+                    QMetaObject::invokeMethod(GAudioOutput::instance(), "notifyPositive", Qt::QueuedConnection);
                 }
+#endif
                 positionLock = true;
             }
             break;
@@ -325,20 +374,31 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 mavlink_global_position_t pos;
                 mavlink_msg_global_position_decode(&message, &pos);
                 quint64 time = getUnixTime(pos.usec);
-                emit valueChanged(uasId, "lat", pos.lat, time);
-                emit valueChanged(uasId, "lon", pos.lon, time);
-                emit valueChanged(uasId, "alt", pos.alt, time);
-                emit valueChanged(uasId, "g-vx", pos.vx, time);
-                emit valueChanged(uasId, "g-vy", pos.vy, time);
-                emit valueChanged(uasId, "g-vz", pos.vz, time);
+                emitValue("lat", pos.lat, time);
+                emitValue("lon", pos.lon, time);
+                emitValue("alt", pos.alt, time);
+                emitValue("g-vx", pos.vx, time);
+                emitValue("g-vy", pos.vy, time);
+                emitValue("g-vz", pos.vz, time);
                 emit globalPositionChanged(this, pos.lon, pos.lat, pos.alt, time);
                 emit speedChanged(this, pos.vx, pos.vy, pos.vz, time);
+                snapshot.lat = pos.lat;
+                snapshot.lon = pos.lon;
+                snapshot.alt = pos.alt;
+                snapshot.globalTime = time;
+                snapshot.vx = pos.vx;
+                snapshot.vy = pos.vy;
+                snapshot.vz = pos.vz;
+                snapshot.speedTime = time;
+                snapshot.fields |= UASStateSnapshot::GLOBAL_POSITION | UASStateSnapshot::SPEED;
                 // Set internal state
+#ifndef QGC_NO_GUI
                 if (!positionLock)
                 {
                     // If position was not locked before, notify positive
-                    GAudioOutput::instance()->notifyPositive();
+                    QMetaObject::invokeMethod(GAudioOutput::instance(), "notifyPositive", Qt::QueuedConnection);
                 }
+#endif
                 positionLock = true;
             }
             break;
@@ -353,8 +413,8 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 // only accept values in a realistic range
                // quint64 time = getUnixTime(pos.usec);
                 quint64 time = MG::TIME::getGroundTimeNow();
-                emit valueChanged(uasId, "lat", pos.lat, time);
-                emit valueChanged(uasId, "lon", pos.lon, time);
+                emitValue("lat", pos.lat, time);
+                emitValue("lon", pos.lon, time);
                 // Check for NaN
                 int alt = pos.alt;
                 if (alt != alt)
@@ -362,29 +422,46 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                     alt = 0;
                     emit textMessageReceived(uasId, message.compid, 255, "GCS ERROR: RECEIVED NaN FOR ALTITUDE");
                 }
-                emit valueChanged(uasId, "alt", pos.alt, time);
+                emitValue("alt", pos.alt, time);
                 // Smaller than threshold and not NaN
                 if (pos.v < 1000000 && pos.v == pos.v)
                 {
-                    emit valueChanged(uasId, "speed", pos.v, time);
+                    emitValue("speed", pos.v, time);
                     //qDebug() << "GOT GPS RAW";
                     emit speedChanged(this, (double)pos.v, 0.0, 0.0, time);
+                    snapshot.vx = pos.v;
+                    snapshot.vy = 0.0;
+                    snapshot.vz = 0.0;
+                    snapshot.speedTime = time;
+                    snapshot.fields |= UASStateSnapshot::SPEED;
                 }
                 else
                 {
                      emit textMessageReceived(uasId, message.compid, 255, QString("GCS ERROR: RECEIVED INVALID SPEED OF %1 m/s").arg(pos.v));
                 }
                 emit globalPositionChanged(this, pos.lon, pos.lat, alt, time);
+                snapshot.lat = pos.lat;
+                snapshot.lon = pos.lon;
+                snapshot.alt = alt;
+                snapshot.globalTime = time;
+                snapshot.fields |= UASStateSnapshot::GLOBAL_POSITION;
             }
             break;
         case MAVLINK_MSG_ID_GPS_STATUS:
             {
                 mavlink_gps_status_t pos;
                 mavlink_msg_gps_status_decode(&message, &pos);
-                for(int i = 0; i < (int)pos.satellites_visible; i++)
+                snapshot.satellites = qMin((int)pos.satellites_visible, (int)UASStateSnapshot::MAX_SATELLITES);
+                for(int i = 0; i < snapshot.satellites; i++)
                 {
                     emit gpsSatelliteStatusChanged(uasId, (unsigned char)pos.satellite_prn[i], (unsigned char)pos.satellite_elevation[i], (unsigned char)pos.satellite_azimuth[i], (unsigned char)pos.satellite_snr[i], static_cast<bool>(pos.satellite_used[i]));
+                    snapshot.satellitePrn[i] = pos.satellite_prn[i];
+                    snapshot.satelliteElevation[i] = pos.satellite_elevation[i];
+                    snapshot.satelliteAzimuth[i] = pos.satellite_azimuth[i];
+                    snapshot.satelliteSnr[i] = pos.satellite_snr[i];
+                    snapshot.satelliteUsed[i] = static_cast<bool>(pos.satellite_used[i]);
                 }
+                snapshot.fields |= UASStateSnapshot::SATELLITES;
             }
             break;
         case MAVLINK_MSG_ID_RC_CHANNELS:
@@ -431,7 +508,16 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             }
             break;
         case MAVLINK_MSG_ID_DEBUG:
-            emit valueChanged(uasId, QString("debug ") + QString::number(mavlink_msg_debug_get_ind(&message)), mavlink_msg_debug_get_value(&message), MG::TIME::getGroundTimeNow());
+            {
+                int index = mavlink_msg_debug_get_ind(&message);
+                int channel = debugChannels.value(index, -1);
+                if (channel < 0)
+                {
+                    channel = getChannel(QString("debug ") + QString::number(index));
+                    debugChannels.insert(index, channel);
+                }
+                emitValue(channel, mavlink_msg_debug_get_value(&message), MG::TIME::getGroundTimeNow());
+            }
             break;
         case MAVLINK_MSG_ID_ATTITUDE_CONTROLLER_OUTPUT:
             {
@@ -439,9 +525,10 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 mavlink_msg_attitude_controller_output_decode(&message, &out);
                 quint64 time = MG::TIME::getGroundTimeNowUsecs();
                 emit attitudeThrustSetPointChanged(this, out.roll/127.0f, out.pitch/127.0f, out.yaw/127.0f, (uint8_t)out.thrust, time);
-                emit valueChanged(uasId, "att control roll", out.roll, time/1000.0f);
-                emit valueChanged(uasId, "att control pitch", out.pitch, time/1000.0f);
-                emit valueChanged(uasId, "att control yaw", out.yaw, time/1000.0f);
+                setAttitudeSetpointSnapshot(out.roll/127.0f, out.pitch/127.0f, out.yaw/127.0f, (uint8_t)out.thrust, time);
+                emitValue("att control roll", out.roll, time/1000.0f);
+                emitValue("att control pitch", out.pitch, time/1000.0f);
+                emitValue("att control yaw", out.yaw, time/1000.0f);
             }
             break;
         case MAVLINK_MSG_ID_POSITION_CONTROLLER_OUTPUT:
@@ -450,9 +537,9 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 mavlink_msg_position_controller_output_decode(&message, &out);
                 quint64 time = MG::TIME::getGroundTimeNow();
                 //emit positionSetPointsChanged(uasId, out.x/127.0f, out.y/127.0f, out.z/127.0f, out.yaw, time);
-                emit valueChanged(uasId, "pos control x", out.x, time);
-                emit valueChanged(uasId, "pos control y", out.y, time);
-                emit valueChanged(uasId, "pos control z", out.z, time);
+                emitValue("pos control x", out.x, time);
+                emitValue("pos control y", out.y, time);
+                emitValue("pos control z", out.z, time);
             }
             break;
         case MAVLINK_MSG_ID_WAYPOINT_COUNT:
@@ -520,7 +607,14 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             {
                 mavlink_local_position_setpoint_t p;
                 mavlink_msg_local_position_setpoint_decode(&message, &p);
-                emit positionSetPointsChanged(uasId, p.x, p.y, p.z, p.yaw, QGC::groundTimeUsecs());
+                quint64 time = QGC::groundTimeUsecs();
+                emit positionSetPointsChanged(uasId, p.x, p.y, p.z, p.yaw, time);
+                snapshot.xSetpoint = p.x;
+                snapshot.ySetpoint = p.y;
+                snapshot.zSetpoint = p.z;
+                snapshot.yawPositionSetpoint = p.yaw;
+                snapshot.positionSetpointTime = time;
+                snapshot.fields |= UASStateSnapshot::POSITION_SETPOINT;
             }
             break;
 
@@ -550,6 +644,7 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             break;
         }
     }
+    emitFrame();
 }
 
 void UAS::setLocalPositionSetpoint(float x, float y, float z, float yaw)
@@ -561,6 +656,120 @@ void UAS::setLocalPositionSetpoint(float x, float y, float z, float yaw)
   #endif
 }
 
+/**
+ * @param name The name of the value, e.g. "battery voltage"
+ * @return The channel id, the same for all calls with the same name
+ */
+int UAS::getChannel(const QString& name)
+{
+    return UASChannelRegistry::instance()->getChannel(uasId, name);
+}
+
+/**
+ * The value is only emitted with the frame. A new frame is started if the
+ * timestamp differs or the frame is full. The signals per value are only
+ * served if somebody still listens to them, the name is then taken from
+ * the registry without building a string.
+ *
+ * @param channel The channel of the value
+ * @param value The new value
+ * @param msec The timestamp of the value, in milliseconds
+ */
+void UAS::emitValue(int channel, double value, quint64 msec)
+{
+    if (frame.count == UASValueFrame::CAPACITY || (frame.count > 0 && frame.msec != msec))
+    {
+        emitFrame();
+    }
+    frame.msec = msec;
+    frame.channels[frame.count] = channel;
+    frame.values[frame.count] = value;
+    frame.count++;
+
+    if (receivers(SIGNAL(channelValueChanged(int,double,quint64))) > 0)
+    {
+        emit channelValueChanged(channel, value, msec);
+    }
+    if (receivers(SIGNAL(valueChanged(int,QString,double,quint64))) > 0)
+    {
+        emit valueChanged(uasId, UASChannelRegistry::instance()->getName(channel), value, msec);
+    }
+}
+
+void UAS::emitFrame()
+{
+    if (frame.count == 0) return;
+    emit valuesChanged(frame);
+    frame.count = 0;
+}
+
+void UAS::setAttitudeSetpointSnapshot(double roll, double pitch, double yaw, double thrust, quint64 time)
+{
+    snapshot.rollSetpoint = roll;
+    snapshot.pitchSetpoint = pitch;
+    snapshot.yawSetpoint = yaw;
+    snapshot.thrustSetpoint = thrust;
+    snapshot.attitudeSetpointTime = time;
+    snapshot.fields |= UASStateSnapshot::ATTITUDE_SETPOINT;
+}
+
+/**
+ * Called by the snapshot timer. A vehicle sending attitude at 200 Hz
+ * updates the instruments at the timer rate, the intermediate states
+ * are never queued to the GUI thread.
+ */
+void UAS::emitSnapshot()
+{
+    if (snapshot.fields == 0) return;
+    emit stateChanged(snapshot);
+    snapshot.fields = 0;
+}
+
+/**
+ * String literals keep their address, so the channel is looked up by
+ * hashing the pointer instead of the characters. Names built at runtime
+ * have to be interned with getChannel() instead.
+ *
+ * @param name The name of the value as string literal
+ * @param value The new value
+ * @param msec The timestamp of the value, in milliseconds
+ */
+void UAS::emitValue(const char* name, double value, quint64 msec)
+{
+    int channel = literalChannels.value(name, -1);
+    if (channel < 0)
+    {
+        channel = getChannel(QString(name));
+        literalChannels.insert(name, channel);
+    }
+    emitValue(channel, value, msec);
+}
+
+/**
+ * The components are published as name.x, name.y and name.z. Systems only
+ * send a handful of vectors, which are searched linearly by their name.
+ *
+ * @param name The name of the vector as sent by the system, up to 10 characters
+ */
+void UAS::emitVector(const char* name, double x, double y, double z, quint64 msec)
+{
+    int i = 0;
+    while (i < vectorChannels.size() && qstrncmp(vectorChannels[i].name, name, 10) != 0) i++;
+    if (i == vectorChannels.size())
+    {
+        VectorChannels channels;
+        qstrncpy(channels.name, name, sizeof(channels.name));
+        QString str(channels.name);
+        channels.x = getChannel(str + ".x");
+        channels.y = getChannel(str + ".y");
+        channels.z = getChannel(str + ".z");
+        vectorChannels.append(channels);
+    }
+    emitValue(vectorChannels[i].x, x, msec);
+    emitValue(vectorChannels[i].y, y, msec);
+    emitValue(vectorChannels[i].z, z, msec);
+}
+
 quint64 UAS::getUnixTime(quint64 time)
 {
     if (time == 0)
@@ -629,8 +838,9 @@ void UAS::sendMessage(LinkInterface* link, mavlink_message_t message)
     // If link is connected
     if (link->isConnected())
     {
-        // Send the portion of the buffer now occupied by the message
-        link->writeBytes((const char*)buffer, len);
+        // Send the portion of the buffer now occupied by the message,
+        // links shared by several systems only send it to this one
+        mavlink->getScheduler(link)->send(uasId, message.msgid, (const char*)buffer, len);
     }
 }
 
@@ -975,6 +1185,31 @@ void UAS::enableExtra3Transmission(bool enabled)
 #endif
 }
 
+/**
+ * The request is sent once, the stream rate controller repeats its
+ * requests regularly.
+ *
+ * @param streamId The stream id, 1 to 9, 0 for all streams
+ * @param rate The message rate in Hertz, 0 to stop the stream
+ */
+void UAS::setDataStreamRate(int streamId, int rate)
+{
+#ifdef MAVLINK_ENABLED_PIXHAWK_MESSAGES
+    mavlink_message_t msg;
+    mavlink_request_data_stream_t stream;
+    stream.req_stream_id = streamId;
+    stream.req_message_rate = rate;
+    stream.start_stop = (rate > 0) ? 1 : 0;
+    stream.target_system = uasId;
+    stream.target_component = 0;
+    mavlink_msg_request_data_stream_encode(mavlink->getSystemId(), mavlink->getComponentId(), &msg, &stream);
+    sendMessage(msg);
+#else
+    Q_UNUSED(streamId);
+    Q_UNUSED(rate);
+#endif
+}
+
 /**
  * Set a parameter value onboard
  *
@@ -1076,6 +1311,7 @@ void UAS::setManualControlCommands(double roll, double pitch, double yaw, double
         qDebug() << __FILE__ << __LINE__ << ": SENT MANUAL CONTROL MESSAGE: roll" << manualRollAngle << " pitch: " << manualPitchAngle << " yaw: " << manualYawAngle << " thrust: " << manualThrust;
 
         emit attitudeThrustSetPointChanged(this, roll, pitch, yaw, thrust, MG::TIME::getGroundTimeNow());
+        setAttitudeSetpointSnapshot(roll, pitch, yaw, thrust, MG::TIME::getGroundTimeNow());
       #endif
     }
 }
@@ -1213,62 +1449,32 @@ void UAS::emergencySTOP()
  * All systems are immediately shut down (e.g. the main power line is cut).
  * @warning This might lead to a crash
  *
- * The command will not be executed until emergencyKILLConfirm is issues immediately afterwards
+ * The command is sent right away. The operator has to confirm it in the
+ * GUI thread before, see UASManager::killUAS().
  */
 bool UAS::emergencyKILL()
 {
-    bool result = false;
-    QMessageBox msgBox;
-    msgBox.setIcon(QMessageBox::Critical);
-    msgBox.setText("EMERGENCY: KILL ALL MOTORS ON UAS");
-    msgBox.setInformativeText("Do you want to cut power on all systems?");
-    msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::Cancel);
-    msgBox.setDefaultButton(QMessageBox::Cancel);
-    int ret = msgBox.exec();
-
-    // Close the message box shortly after the click to prevent accidental clicks
-    QTimer::singleShot(5000, &msgBox, SLOT(reject()));
-
-
-    if (ret == QMessageBox::Yes)
-    {
-        mavlink_message_t msg;
-        // TODO Replace MG System ID with static function call and allow to change ID in GUI
-        mavlink_msg_action_pack(MG::SYSTEM::ID, MG::SYSTEM::COMPID, &msg, this->getUASID(), MAV_COMP_ID_IMU, (int)MAV_ACTION_EMCY_KILL);
-        // Send message twice to increase chance of reception
-        sendMessage(msg);
-        sendMessage(msg);
-        result = true;
-    }
-    return result;
+    mavlink_message_t msg;
+    // TODO Replace MG System ID with static function call and allow to change ID in GUI
+    mavlink_msg_action_pack(MG::SYSTEM::ID, MG::SYSTEM::COMPID, &msg, this->getUASID(), MAV_COMP_ID_IMU, (int)MAV_ACTION_EMCY_KILL);
+    // Send message twice to increase chance of reception
+    sendMessage(msg);
+    sendMessage(msg);
+    return true;
 }
 
+/**
+ * The command is sent right away. The operator has to confirm it in the
+ * GUI thread before, see UASManager::shutdownUAS().
+ */
 void UAS::shutdown()
 {
-    bool result = false;
-    QMessageBox msgBox;
-    msgBox.setIcon(QMessageBox::Critical);
-    msgBox.setText("Shutting down the UAS");
-    msgBox.setInformativeText("Do you want to shut down the onboard computer?");
-    msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::Cancel);
-    msgBox.setDefaultButton(QMessageBox::Cancel);
-    int ret = msgBox.exec();
-
-    // Close the message box shortly after the click to prevent accidental clicks
-    QTimer::singleShot(5000, &msgBox, SLOT(reject()));
-
-
-    if (ret == QMessageBox::Yes)
-    {
-        // If the active UAS is set, execute command
-        mavlink_message_t msg;
-        // TODO Replace MG System ID with static function call and allow to change ID in GUI
-        mavlink_msg_action_pack(MG::SYSTEM::ID, MG::SYSTEM::COMPID, &msg, this->getUASID(), MAV_COMP_ID_IMU,(int)MAV_ACTION_SHUTDOWN);
-        // Send message twice to increase chance of reception
-        sendMessage(msg);
-        sendMessage(msg);
-        result = true;
-    }
+    mavlink_message_t msg;
+    // TODO Replace MG System ID with static function call and allow to change ID in GUI
+    mavlink_msg_action_pack(MG::SYSTEM::ID, MG::SYSTEM::COMPID, &msg, this->getUASID(), MAV_COMP_ID_IMU,(int)MAV_ACTION_SHUTDOWN);
+    // Send message twice to increase chance of reception
+    sendMessage(msg);
+    sendMessage(msg);
 }
 
 /**
@@ -1370,8 +1576,10 @@ void UAS::startLowBattAlarm()
 {
     if (!lowBattAlarm)
     {
-        GAudioOutput::instance()->alert("LOW BATTERY");
+#ifndef QGC_NO_GUI
+        QMetaObject::invokeMethod(GAudioOutput::instance(), "alert", Qt::QueuedConnection, Q_ARG(QString, QString("LOW BATTERY")));
         QTimer::singleShot(2000, GAudioOutput::instance(), SLOT(startEmergency()));
+#endif
         lowBattAlarm = true;
     }
 }
@@ -1380,7 +1588,9 @@ void UAS::stopLowBattAlarm()
 {
     if (lowBattAlarm)
     {
-        GAudioOutput::instance()->stopEmergency();
+#ifndef QGC_NO_GUI
+        QMetaObject::invokeMethod(GAudioOutput::instance(), "stopEmergency", Qt::QueuedConnection);
+#endif
         lowBattAlarm = false;
     }
 }
@@ -36,6 +36,10 @@ This file is part of the QGROUNDCONTROL project
 #include "MG.h"
 #include <MAVLinkProtocol.h>
 #include <mavlink.h>
+#include "UASStreamRateController.h"
+#include "UASChannelRegistry.h"
+#include <QHash>
+#include <QVector>
 
 /**
  * @brief A generic MAVLINK-connected MAV/UAV
@@ -80,6 +84,7 @@ public:
     QList<LinkInterface*>* getLinks();
 
 friend class UASWaypointManager;
+friend class UASStreamRateController;
 protected:
     int uasId;                    ///< Unique system ID
     int type;                     ///< UAS type (from type enum)
@@ -93,6 +98,7 @@ protected:
     int cells;                    ///< Number of cells
 
     UASWaypointManager waypointManager;
+    UASStreamRateController rateController; ///< Adapts the stream rates to the link capacity
 
     QList<double> actuatorValues;
     QList<QString> actuatorNames;
@@ -129,6 +135,19 @@ protected:
     bool positionLock;          ///< Status if position information is available or not
     QTimer* statusTimeout;      ///< Timer for various status timeouts
 
+    /** @brief Channels of one named debug vector */
+    struct VectorChannels
+    {
+        char name[11];
+        int x, y, z;
+    };
+    QHash<const char*, int> literalChannels; ///< Channels of the value names given as string literals
+    QHash<int, int> debugChannels;           ///< Channels of the debug values by index
+    QVector<VectorChannels> vectorChannels;  ///< Channels of the debug vectors
+    UASValueFrame frame;                     ///< Values of the message being decoded, not yet emitted
+    UASStateSnapshot snapshot;               ///< State for the instruments, published by snapshotTimer
+    QTimer* snapshotTimer;                   ///< Rate limits the state updates to the widgets
+
     /** @brief Set the current battery type */
     void setBattery(BatteryType type, int cells);
     /** @brief Estimate how much flight time is remaining */
@@ -139,9 +158,22 @@ protected:
     void getStatusForCode(int statusCode, QString& uasState, QString& stateDescription);
     /** @brief Check if vehicle is in autonomous mode */
     bool isAuto();
+    /** @brief Get the telemetry channel of a value of this system */
+    int getChannel(const QString& name);
+    /** @brief Add a value to the frame of the current message */
+    void emitValue(int channel, double value, quint64 msec);
+    /** @brief Publish a value, the name has to be a string literal */
+    void emitValue(const char* name, double value, quint64 msec);
+    /** @brief Publish the components of a debug vector */
+    void emitVector(const char* name, double x, double y, double z, quint64 msec);
+    /** @brief Emit the values collected since the last frame, called at the end of receiveMessage() */
+    void emitFrame();
+    /** @brief Store the attitude setpoint for the next snapshot */
+    void setAttitudeSetpointSnapshot(double roll, double pitch, double yaw, double thrust, quint64 time);
 
 public:
     UASWaypointManager &getWaypointManager(void) { return waypointManager; }
+    UASStreamRateController &getStreamRateController(void) { return rateController; }
     int getSystemType();
 
 public slots:
@@ -215,9 +247,13 @@ public slots:
     void enableExtra1Transmission(bool enabled);
     void enableExtra2Transmission(bool enabled);
     void enableExtra3Transmission(bool enabled);
+    /** @brief Request a data stream at a rate in Hertz, 0 stops the stream */
+    void setDataStreamRate(int streamId, int rate);
 
     /** @brief Update the system state */
     void updateState();
+    /** @brief Publish the state if it changed since the last snapshot */
+    void emitSnapshot();
 
     /** @brief Set local position setpoint */
     void setLocalPositionSetpoint(float x, float y, float z, float yaw);
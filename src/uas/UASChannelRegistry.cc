@@ -0,0 +1,93 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the registry of telemetry channels
+ *
+ */
+
+#include "UASChannelRegistry.h"
+
+UASChannelRegistry* UASChannelRegistry::instance()
+{
+    static UASChannelRegistry registry;
+    return &registry;
+}
+
+UASChannelRegistry::UASChannelRegistry()
+{
+    channels.reserve(256);
+}
+
+/**
+ * Lookups of known values only take the read lock, the write lock is
+ * taken once per new channel.
+ */
+int UASChannelRegistry::getChannel(int uasId, const QString& name)
+{
+    int channel = findChannel(uasId, name);
+    if (channel >= 0) return channel;
+
+    QWriteLocker locker(&lock);
+    // Another thread might have added the channel meanwhile
+    QHash<QString, int>& names = systems[uasId];
+    QHash<QString, int>::const_iterator i = names.constFind(name);
+    if (i != names.constEnd()) return i.value();
+
+    Channel c;
+    c.uasId = uasId;
+    c.name = name;
+    channel = channels.size();
+    channels.append(c);
+    names.insert(name, channel);
+    return channel;
+}
+
+int UASChannelRegistry::findChannel(int uasId, const QString& name)
+{
+    QReadLocker locker(&lock);
+    QHash<int, QHash<QString, int> >::const_iterator system = systems.constFind(uasId);
+    if (system == systems.constEnd()) return -1;
+    return system.value().value(name, -1);
+}
+
+QString UASChannelRegistry::getName(int channel)
+{
+    QReadLocker locker(&lock);
+    if (channel < 0 || channel >= channels.size()) return QString();
+    return channels[channel].name;
+}
+
+int UASChannelRegistry::getSystem(int channel)
+{
+    QReadLocker locker(&lock);
+    if (channel < 0 || channel >= channels.size()) return -1;
+    return channels[channel].uasId;
+}
+
+int UASChannelRegistry::getChannelCount()
+{
+    QReadLocker locker(&lock);
+    return channels.size();
+}
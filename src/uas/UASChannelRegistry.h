@@ -0,0 +1,86 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the registry of telemetry channels
+ *
+ */
+
+#ifndef UASCHANNELREGISTRY_H
+#define UASCHANNELREGISTRY_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QReadWriteLock>
+
+/**
+ * @brief Interns the telemetry values of all systems to small integers
+ *
+ * Each pair of system id and value name, e.g. (42, "roll IMU"), is
+ * assigned a channel id the first time it is seen. Ids are handed out
+ * from zero upwards and never reused, so receivers can keep the state of
+ * a channel in a plain vector indexed by the id and resolve the name only
+ * once per channel instead of hashing and comparing it per sample.
+ **/
+class UASChannelRegistry
+{
+public:
+    static UASChannelRegistry* instance();
+
+    /**
+     * @brief Get the channel of a value, assign a new one if the value is unknown
+     * @param uasId The system the value belongs to
+     * @param name The name of the value, e.g. "battery voltage"
+     * @return The channel id
+     */
+    int getChannel(int uasId, const QString& name);
+    /** @brief Get the channel of a value, -1 if it has not been assigned yet */
+    int findChannel(int uasId, const QString& name);
+    /** @brief Get the name of the value of a channel, empty for unknown channels */
+    QString getName(int channel);
+    /** @brief Get the system a channel belongs to, -1 for unknown channels */
+    int getSystem(int channel);
+    /** @brief Get the number of assigned channels, all ids are below */
+    int getChannelCount();
+
+protected:
+    UASChannelRegistry();
+
+    /** @brief Owner and name of one channel */
+    struct Channel
+    {
+        int uasId;
+        QString name;
+    };
+
+    QVector<Channel> channels;                   ///< Channels indexed by their id
+    QHash<int, QHash<QString, int> > systems;    ///< Channel ids per system and name
+    QReadWriteLock lock;                         ///< Values are published from several threads
+
+private:
+    Q_DISABLE_COPY(UASChannelRegistry)
+};
+
+#endif // UASCHANNELREGISTRY_H
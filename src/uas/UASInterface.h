@@ -40,6 +40,8 @@ This file is part of the QGROUNDCONTROL project
 #include "LinkInterface.h"
 #include "ProtocolInterface.h"
 #include "UASWaypointManager.h"
+#include "UASValueFrame.h"
+#include "UASStateSnapshot.h"
 
 /**
  * @brief Interface for all robots.
@@ -161,12 +163,17 @@ public slots:
     virtual void setMode(int mode) = 0;
     /** Stops the robot system. If it is an MAV, the robot starts the emergency landing procedure **/
     virtual void emergencySTOP() = 0;
-    /** Kills the robot. All systems are immediately shut down (e.g. the main power line is cut). This might lead to a crash **/
+    /**
+     * @brief Kills the robot. All systems are immediately shut down (e.g. the main power line is cut). This might lead to a crash
+     *
+     * Does not ask the operator, use UASManager::killUAS() from the user interface.
+     */
     virtual bool emergencyKILL() = 0;
     /**
      * @brief Shut down the system's computers
      *
      * Works only if already landed and will cleanly shut down all onboard computers.
+     * Does not ask the operator, use UASManager::shutdownUAS() from the user interface.
      */
     virtual void shutdown() = 0;
     /** @brief Request the list of stored waypoints from the robot */
@@ -288,6 +295,34 @@ signals:
       */
     void valueChanged(int uasId, QString name, double value, quint64 msec);
     void valueChanged(UASInterface* uas, QString name, double value, quint64 msec);
+    /** @brief A value of the robot has changed.
+      *
+      * Same as valueChanged(), but the value is identified by its channel in the
+      * UASChannelRegistry instead of its name. Receivers can resolve the name
+      * once per channel and avoid string comparisons per sample.
+      *
+      * @param channel channel id of the value, unique over all systems
+      * @param value the value that changed
+      * @param msec the timestamp of the message, in milliseconds
+      */
+    void channelValueChanged(int channel, double value, quint64 msec);
+    /** @brief All values decoded from one message have changed.
+      *
+      * Emitted once per message instead of once per value, receivers connected
+      * through a queued connection get a single event per message.
+      *
+      * @param frame the channels and values of the message, sharing one timestamp
+      */
+    void valuesChanged(const UASValueFrame& frame);
+    /** @brief The state shown by the instruments has changed.
+      *
+      * Emitted at most every UAS_SNAPSHOT_INTERVAL milliseconds with the latest
+      * attitude, position, speed and battery state, however many messages
+      * updated them in between.
+      *
+      * @param snapshot the latest state and the fields updated since the last snapshot
+      */
+    void stateChanged(const UASStateSnapshot& snapshot);
     void voltageChanged(int uasId, double voltage);
     void waypointUpdated(int uasId, int id, double x, double y, double z, double yaw, bool autocontinue, bool active);
     void waypointSelected(int uasId, int id);
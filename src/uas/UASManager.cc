@@ -29,12 +29,16 @@ This file is part of the QGROUNDCONTROL project
  */
 
 #include <QList>
-#include <QApplication>
+#include <QCoreApplication>
+#ifndef QGC_NO_GUI
 #include <QMessageBox>
+#endif
 #include <QTimer>
+#include <QMutexLocker>
 #include "UAS.h"
 #include <UASInterface.h>
 #include <UASManager.h>
+#include "configuration.h"
 
 UASManager* UASManager::instance() {
     static UASManager* _instance = 0;
@@ -54,7 +58,9 @@ UASManager* UASManager::instance() {
  * This class implements the singleton design pattern and has therefore only a private constructor.
  **/
 UASManager::UASManager() :
-        activeUAS(NULL)
+        activeUAS(NULL),
+        workerPool(UAS_WORKER_THREADS),
+        missionLogging(false)
 {
     systems = QMap<int, UASInterface*>();
     start(QThread::LowPriority);
@@ -65,6 +71,16 @@ UASManager::~UASManager()
 }
 
 
+UASWorkerPool* UASManager::getWorkerPool()
+{
+    return &workerPool;
+}
+
+MissionLog* UASManager::getMissionLog()
+{
+    return &missionLog;
+}
+
 void UASManager::run()
 {
 }
@@ -72,9 +88,20 @@ void UASManager::run()
 void UASManager::addUAS(UASInterface* uas)
 {
     // Only execute if there is no UAS at this index
-    if (!systems.contains(uas->getUASID()))
+    systemsMutex.lock();
+    bool created = !systems.contains(uas->getUASID());
+    if (created)
     {
         systems.insert(uas->getUASID(), uas);
+    }
+    if (created && missionLogging)
+    {
+        // Started under the mutex, so recording can not be disabled meanwhile
+        missionLog.startLog(uas);
+    }
+    systemsMutex.unlock();
+    if (created)
+    {
         emit UASCreated(uas);
     }
 
@@ -85,14 +112,42 @@ void UASManager::addUAS(UASInterface* uas)
     }
 }
 
+/**
+ * The files are created in the application directory, one per vehicle,
+ * see MissionLog::startLog().
+ *
+ * @param enabled True to record all current and future vehicles
+ */
+void UASManager::setMissionLogging(bool enabled)
+{
+    systemsMutex.lock();
+    missionLogging = enabled;
+    QList<UASInterface*> current = systems.values();
+    systemsMutex.unlock();
+
+    if (enabled)
+    {
+        foreach (UASInterface* uas, current)
+        {
+            missionLog.startLog(uas);
+        }
+    }
+    else
+    {
+        missionLog.stopAll();
+    }
+}
+
 UASInterface* UASManager::getActiveUAS()
 {
+#ifndef QGC_NO_GUI
     if(!activeUAS)
     {
         QMessageBox msgBox;
         msgBox.setText(tr("No Micro Air Vehicle connected. Please connect one first."));
         msgBox.exec();
     }
+#endif
     return activeUAS; ///< Return zero pointer if no UAS has been loaded
 }
 
@@ -133,16 +188,72 @@ bool UASManager::stopActiveUAS()
 
 bool UASManager::killActiveUAS()
 {
-    if (getActiveUAS()) activeUAS->emergencyKILL();
+    if (getActiveUAS()) killUAS(activeUAS);
     return (activeUAS);
 }
 
 bool UASManager::shutdownActiveUAS()
 {
-    if (getActiveUAS()) activeUAS->shutdown();
+    if (getActiveUAS()) shutdownUAS(activeUAS);
     return (activeUAS);
 }
 
+/**
+ * The UAS processes its messages in a worker thread, so the dialog can not
+ * be shown from there. It is shown here and only the confirmed, non
+ * interactive command is queued to the UAS.
+ *
+ * @param uas The system to kill
+ */
+bool UASManager::killUAS(UASInterface* uas)
+{
+    if (!uas) return false;
+    if (!confirm(tr("EMERGENCY: KILL ALL MOTORS ON UAS"), tr("Do you want to cut power on all systems?"))) return false;
+    QMetaObject::invokeMethod(uas, "emergencyKILL", Qt::QueuedConnection);
+    return true;
+}
+
+/**
+ * @param uas The system to shut down
+ */
+bool UASManager::shutdownUAS(UASInterface* uas)
+{
+    if (!uas) return false;
+    if (!confirm(tr("Shutting down the UAS"), tr("Do you want to shut down the onboard computer?"))) return false;
+    QMetaObject::invokeMethod(uas, "shutdown", Qt::QueuedConnection);
+    return true;
+}
+
+/**
+ * Critical commands have to be confirmed by the operator. Without a user
+ * interface there is nobody to confirm, so the command is refused.
+ *
+ * @param text short description of the command
+ * @param question question presented to the operator
+ * @return true if the operator accepted the command
+ */
+bool UASManager::confirm(const QString& text, const QString& question)
+{
+#ifndef QGC_NO_GUI
+    QMessageBox msgBox;
+    msgBox.setIcon(QMessageBox::Critical);
+    msgBox.setText(text);
+    msgBox.setInformativeText(question);
+    msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::Cancel);
+    msgBox.setDefaultButton(QMessageBox::Cancel);
+    int ret = msgBox.exec();
+
+    // Close the message box shortly after the click to prevent accidental clicks
+    QTimer::singleShot(5000, &msgBox, SLOT(reject()));
+
+    return (ret == QMessageBox::Yes);
+#else
+    Q_UNUSED(question);
+    qDebug() << "Refusing" << text << "- no operator to confirm";
+    return false;
+#endif
+}
+
 void UASManager::configureActiveUAS()
 {
     UASInterface* actUAS = getActiveUAS();
@@ -155,9 +266,16 @@ void UASManager::configureActiveUAS()
 UASInterface* UASManager::getUASForId(int id)
 {
     // Return NULL pointer if UAS does not exist
+    QMutexLocker locker(&systemsMutex);
     return systems.value(id, NULL);
 }
 
+int UASManager::getUASCount()
+{
+    QMutexLocker locker(&systemsMutex);
+    return systems.size();
+}
+
 void UASManager::setActiveUAS(UASInterface* uas)
 {
     if (uas != NULL)
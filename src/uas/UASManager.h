@@ -35,6 +35,8 @@ This file is part of the QGROUNDCONTROL project
 #include <QList>
 #include <QMutex>
 #include <UASInterface.h>
+#include "UASWorkerPool.h"
+#include "MissionLog.h"
 
 /**
  * @brief Central manager for all connected aerial vehicles
@@ -67,7 +69,12 @@ public:
      * @return UAS with the given ID, NULL pointer else
      **/
     UASInterface* getUASForId(int id);
-
+    /** @brief Get the number of vehicles */
+    int getUASCount();
+    /** @brief Get the threads the vehicles are processed in */
+    UASWorkerPool* getWorkerPool();
+    /** @brief Get the recorder for the telemetry of the vehicles */
+    MissionLog* getMissionLog();
 
 public slots:
 
@@ -79,6 +86,13 @@ public slots:
      **/
     void addUAS(UASInterface* UAS);
 
+    /**
+     * @brief Record the telemetry of all vehicles to mission logs
+     *
+     * Vehicles added later are recorded as well while enabled.
+     * @param enabled True to start recording, false to stop and close the files
+     **/
+    void setMissionLogging(bool enabled);
 
     /**
       * @brief Set a UAS as currently selected
@@ -156,12 +170,31 @@ public slots:
     /** @brief Shut down the onboard operating system down */
     bool shutdownActiveUAS();
 
+    /**
+     * @brief EMERGENCY: Kill a UAS once the operator confirmed it
+     *
+     * Has to be called from the GUI thread. The confirmation is asked
+     * there and the command is then queued to the thread of the UAS.
+     *
+     * @return True if the operator confirmed the command
+     */
+    bool killUAS(UASInterface* uas);
+
+    /** @brief Shut down the onboard computers of a UAS once the operator confirmed it, see killUAS() */
+    bool shutdownUAS(UASInterface* uas);
+
 
 protected:
     UASManager();
+    /** @brief Ask the operator to confirm a critical command, only in the GUI thread */
+    bool confirm(const QString& text, const QString& question);
     QMap<int, UASInterface*> systems;
+    QMutex systemsMutex;        ///< Systems are looked up from the decoder threads of the links
     UASInterface* activeUAS;
     QMutex activeUASMutex;
+    UASWorkerPool workerPool;   ///< Threads the vehicles process their messages in
+    MissionLog missionLog;      ///< Records the telemetry, stopped before the worker threads
+    bool missionLogging;        ///< Record new vehicles, guarded by systemsMutex
 
 signals:
     void UASCreated(UASInterface* UAS);
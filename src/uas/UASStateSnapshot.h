@@ -0,0 +1,108 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the coalesced vehicle state
+ *
+ */
+
+#ifndef UASSTATESNAPSHOT_H
+#define UASSTATESNAPSHOT_H
+
+#include <QtGlobal>
+#include <QMetaType>
+
+/**
+ * @brief Latest state of one vehicle, as shown by the instruments
+ *
+ * The vehicle overwrites the fields with every decoded message and
+ * publishes a copy at a fixed rate (see UAS_SNAPSHOT_INTERVAL), so the
+ * widgets are updated once per interval no matter how many messages
+ * arrived in between. The fields mask tells which parts were updated
+ * since the last snapshot. Like UASValueFrame it is copied by value.
+ **/
+struct UASStateSnapshot
+{
+    enum Field
+    {
+        ATTITUDE        = 1 << 0,
+        LOCAL_POSITION  = 1 << 1,
+        GLOBAL_POSITION = 1 << 2,
+        SPEED           = 1 << 3,
+        BATTERY         = 1 << 4,
+        STATUS          = 1 << 5,
+        ATTITUDE_SETPOINT = 1 << 6,
+        POSITION_SETPOINT = 1 << 7,
+        SATELLITES      = 1 << 8
+    };
+
+    enum
+    {
+        MAX_SATELLITES = 20           ///< Satellites of one GPS status message
+    };
+
+    UASStateSnapshot() :
+            uasId(0), fields(0),
+            roll(0), pitch(0), yaw(0), attitudeTime(0),
+            x(0), y(0), z(0), localTime(0),
+            lat(0), lon(0), alt(0), globalTime(0),
+            vx(0), vy(0), vz(0), speedTime(0),
+            voltage(0), charge(0), secondsRemaining(0),
+            dropRate(0),
+            rollSetpoint(0), pitchSetpoint(0), yawSetpoint(0), thrustSetpoint(0), attitudeSetpointTime(0),
+            xSetpoint(0), ySetpoint(0), zSetpoint(0), yawPositionSetpoint(0), positionSetpointTime(0),
+            satellites(0) {}
+
+    int uasId;                    ///< System the state belongs to
+    int fields;                   ///< Fields updated since the last snapshot, see Field
+
+    double roll, pitch, yaw;      ///< Attitude, in radians
+    quint64 attitudeTime;         ///< Timestamp of the attitude, in milliseconds
+    double x, y, z;               ///< Local position, in meters
+    quint64 localTime;            ///< Timestamp of the local position, in milliseconds
+    double lat, lon, alt;         ///< Global position, in degrees and meters
+    quint64 globalTime;           ///< Timestamp of the global position, in milliseconds
+    double vx, vy, vz;            ///< Speed, in meters per second
+    quint64 speedTime;            ///< Timestamp of the speed, in milliseconds
+    double voltage;               ///< Filtered battery voltage
+    double charge;                ///< Charge level, in percent
+    int secondsRemaining;         ///< Estimated flight time left
+    float dropRate;               ///< Packet drop rate reported by the vehicle, in percent
+    double rollSetpoint, pitchSetpoint, yawSetpoint, thrustSetpoint; ///< Attitude controller setpoint
+    quint64 attitudeSetpointTime; ///< Timestamp of the attitude setpoint
+    float xSetpoint, ySetpoint, zSetpoint, yawPositionSetpoint; ///< Local position setpoint, in meters and radians
+    quint64 positionSetpointTime; ///< Timestamp of the position setpoint
+    int satellites;               ///< Visible satellites, entries used in the arrays below
+    quint8 satellitePrn[MAX_SATELLITES];
+    quint8 satelliteElevation[MAX_SATELLITES];
+    quint8 satelliteAzimuth[MAX_SATELLITES];
+    quint8 satelliteSnr[MAX_SATELLITES];
+    bool satelliteUsed[MAX_SATELLITES];
+
+    bool has(Field field) const { return (fields & field) != 0; }
+};
+
+Q_DECLARE_METATYPE(UASStateSnapshot)
+
+#endif // UASSTATESNAPSHOT_H
@@ -0,0 +1,206 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the adaptive stream rate controller
+ *
+ */
+
+#include "UASStreamRateController.h"
+#include "UAS.h"
+#include "MAVLinkProtocol.h"
+#include "MAVLinkStatistics.h"
+
+UASStreamRateController::UASStreamRateController(UAS& _uas) :
+        uas(_uas),
+        streams(),
+        timer(this),
+        target(uas.mavlink->getStreamRateTarget() / 100.0),
+        utilization(0),
+        hold(0),
+        refresh(0)
+{
+    // Streams by priority. The minimum rates keep the vehicle flyable
+    // from the ground station, all other streams may be stopped.
+    addStream(5, 10, 50);  // Raw sensor fusion, attitude
+    addStream(2, 2, 10);   // Extended system status
+    addStream(6, 2, 20);   // Position
+    addStream(3, 0, 10);   // RC channels
+    addStream(4, 0, 20);   // Raw controller
+    addStream(1, 0, 50);   // Raw sensors
+    addStream(7, 0, 10);   // Extra 1
+    addStream(8, 0, 10);   // Extra 2
+    addStream(9, 0, 10);   // Extra 3
+
+    timer.setInterval(CONTROL_INTERVAL);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(step()));
+    connect(uas.mavlink, SIGNAL(streamRateControlChanged(bool)), this, SLOT(setEnabled(bool)));
+    connect(uas.mavlink, SIGNAL(streamRateTargetChanged(int)), this, SLOT(setTarget(int)));
+    if (uas.mavlink->streamRateControlEnabled()) setEnabled(true);
+}
+
+void UASStreamRateController::addStream(int streamId, int minRate, int maxRate)
+{
+    Stream stream;
+    stream.id = streamId;
+    stream.minRate = minRate;
+    stream.maxRate = maxRate;
+    stream.rate = maxRate;
+    streams.append(stream);
+}
+
+int UASStreamRateController::getRate(int streamId) const
+{
+    if (!isEnabled()) return -1;
+    foreach (const Stream& stream, streams)
+    {
+        if (stream.id == streamId) return stream.rate;
+    }
+    return -1;
+}
+
+/**
+ * The control starts from the minimum rates and raises them until the
+ * target is reached, so a slow link is never flooded by the default rates.
+ * When the control is stopped, the vehicle is asked to send all streams at
+ * its own default rates again, as it did before the controller started.
+ * The maximum rates of the controller are no request of the vehicle and
+ * are therefore not sent.
+ *
+ * @param enabled true to start the control, false to return to the default rates
+ */
+void UASStreamRateController::setEnabled(bool enabled)
+{
+    if (enabled == isEnabled()) return;
+    if (enabled)
+    {
+        for (int i = 0; i < streams.size(); ++i)
+        {
+            setRate(streams[i], streams[i].minRate);
+        }
+        hold = HOLD_STEPS;
+        refresh = REFRESH_STEPS;
+        timer.start();
+    }
+    else
+    {
+        timer.stop();
+        uas.enableAllDataTransmission(true);
+    }
+}
+
+void UASStreamRateController::setTarget(int percent)
+{
+    target = percent / 100.0;
+}
+
+bool UASStreamRateController::measure(double* utilization, double* loss)
+{
+    MAVLinkStatistics* statistics = uas.mavlink->getStatistics();
+    bool measured = false;
+    *utilization = 0;
+    *loss = 0;
+    foreach (LinkInterface* link, *uas.getLinks())
+    {
+        MAVLinkStatistics::Report report;
+        double capacity = MAVLinkStatistics::getCapacity(link);
+        if (capacity <= 0 || !statistics->getLinkReport(link->getId(), &report)) continue;
+
+        // A half duplex link shares its capacity with the uplink
+        double bytes = report.byteRate;
+        if (!link->isFullDuplex())
+        {
+            foreach (const MAVLinkStatistics::MessageReport& sent, statistics->getMessageReports(link->getId(), true))
+            {
+                bytes += sent.byteRate;
+            }
+        }
+        *utilization = qMax(*utilization, bytes / capacity);
+        *loss = qMax(*loss, report.loss);
+        measured = true;
+    }
+    return measured;
+}
+
+/**
+ * Only one stream is changed per step. A reduction is held for a few
+ * steps until the two second statistics window has caught up, raising
+ * the rates continues every step as long as there is headroom.
+ */
+void UASStreamRateController::step()
+{
+    double loss;
+    if (!measure(&utilization, &loss)) return;
+
+    // Requests may get lost on a congested link, repeat them regularly
+    if (--refresh <= 0)
+    {
+        refresh = REFRESH_STEPS;
+        foreach (const Stream& stream, streams)
+        {
+            uas.setDataStreamRate(stream.id, stream.rate);
+        }
+    }
+
+    if (hold > 0)
+    {
+        hold--;
+        return;
+    }
+
+    if (utilization > target || loss > LOSS_LIMIT)
+    {
+        // Packet loss gives no estimate of the overload, halve the rate then
+        double factor = (loss > LOSS_LIMIT) ? 0.5 : qMax(0.5, target / utilization);
+        for (int i = streams.size() - 1; i >= 0; --i)
+        {
+            Stream& stream = streams[i];
+            if (stream.rate > stream.minRate)
+            {
+                setRate(stream, qMax(stream.minRate, qMin(stream.rate - 1, (int)(stream.rate * factor))));
+                hold = HOLD_STEPS;
+                return;
+            }
+        }
+    }
+    else if (utilization < target * 0.9)
+    {
+        for (int i = 0; i < streams.size(); ++i)
+        {
+            Stream& stream = streams[i];
+            if (stream.rate < stream.maxRate)
+            {
+                setRate(stream, qMin(stream.maxRate, stream.rate + qMax(1, stream.rate / 4)));
+                return;
+            }
+        }
+    }
+}
+
+void UASStreamRateController::setRate(Stream& stream, int rate)
+{
+    stream.rate = rate;
+    uas.setDataStreamRate(stream.id, rate);
+    emit rateChanged(uas.getUASID(), stream.id, rate);
+}
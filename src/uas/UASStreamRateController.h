@@ -0,0 +1,116 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the adaptive stream rate controller
+ *
+ */
+
+#ifndef UASSTREAMRATECONTROLLER_H
+#define UASSTREAMRATECONTROLLER_H
+
+#include <QObject>
+#include <QList>
+#include <QTimer>
+class UAS;
+
+/**
+ * @brief Closed loop control of the data stream rates of one system
+ *
+ * Once per second the controller measures the utilization of the links
+ * of the system, the received bytes (plus the sent bytes on half duplex
+ * links) relative to the capacity derived from getNominalDataRate(), and
+ * the packet loss. If the busiest link is above the target utilization or
+ * loses packets, the rate of the lowest priority stream which is still
+ * above its minimum is reduced multiplicatively. If the utilization is
+ * clearly below the target, the highest priority stream below its maximum
+ * is raised additively. After each change the controller waits until the
+ * statistics window reflects the new rates.
+ *
+ * Heartbeats are not part of any stream and are never throttled, the
+ * sensor fusion stream carrying the attitude has the highest priority and
+ * a minimum rate which is always requested.
+ */
+class UASStreamRateController : public QObject
+{
+    Q_OBJECT
+public:
+    UASStreamRateController(UAS&);
+
+    enum
+    {
+        CONTROL_INTERVAL = 1000, ///< Milliseconds between two control steps
+        HOLD_STEPS = 2,          ///< Steps to wait after a change for the measurement to settle
+        REFRESH_STEPS = 5,       ///< Steps after which all rates are requested again
+        LOSS_LIMIT = 5           ///< Packet loss in percent treated as congestion
+    };
+
+    /** @brief Append a stream with the lowest priority, rates in Hertz */
+    void addStream(int streamId, int minRate, int maxRate);
+    /** @brief Get the currently requested rate of a stream, -1 if the stream or the controller is disabled */
+    int getRate(int streamId) const;
+    /** @brief Get the utilization of the busiest link at the last step, 0 to 1 */
+    double getUtilization() const { return utilization; }
+    /** @brief Get the target utilization, 0 to 1 */
+    double getTarget() const { return target; }
+    bool isEnabled() const { return timer.isActive(); }
+
+public slots:
+    /** @brief Start the control, beginning with the minimum rates, or return the streams to the vehicle defaults */
+    void setEnabled(bool enabled);
+    /** @brief Set the target utilization in percent of the link capacity */
+    void setTarget(int percent);
+
+protected slots:
+    /** @brief Measure the links and adjust one stream */
+    void step();
+
+protected:
+    struct Stream
+    {
+        int id;
+        int minRate;
+        int maxRate;
+        int rate;
+    };
+
+    UAS& uas;
+    QList<Stream> streams;  ///< Ordered by priority, highest first
+    QTimer timer;
+    double target;          ///< Target utilization, 0 to 1
+    double utilization;     ///< Utilization of the busiest link at the last step
+    int hold;               ///< Steps left until the next change
+    int refresh;            ///< Steps left until all rates are requested again
+
+    /** @brief Get the utilization and the loss in percent of the busiest link, false if no link is measured */
+    bool measure(double* utilization, double* loss);
+    /** @brief Request a new rate of a stream */
+    void setRate(Stream& stream, int rate);
+
+signals:
+    /** @brief Emitted after a new rate has been requested for a stream */
+    void rateChanged(int uasId, int streamId, int rate);
+};
+
+#endif // UASSTREAMRATECONTROLLER_H
@@ -0,0 +1,63 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the telemetry value frame
+ *
+ */
+
+#ifndef UASVALUEFRAME_H
+#define UASVALUEFRAME_H
+
+#include <QtGlobal>
+#include <QMetaType>
+
+/**
+ * @brief All telemetry values decoded from one message
+ *
+ * The values are stored as two parallel arrays of channel ids (see
+ * UASChannelRegistry) and values, sharing one timestamp. A frame is
+ * emitted once per decoded message, so a queued connection posts a single
+ * event per message instead of one per value. The frame has a fixed
+ * capacity and is copied by value, it does not allocate.
+ **/
+struct UASValueFrame
+{
+    enum
+    {
+        CAPACITY = 16  ///< Most values of one frame, more are split into several frames
+    };
+
+    UASValueFrame() : uasId(0), msec(0), count(0) {}
+
+    int uasId;                    ///< System the values belong to
+    quint64 msec;                 ///< Timestamp of all values, in milliseconds
+    int count;                    ///< Number of values in the frame
+    int channels[CAPACITY];       ///< Channel ids of the values
+    double values[CAPACITY];      ///< The values
+};
+
+Q_DECLARE_METATYPE(UASValueFrame)
+
+#endif // UASVALUEFRAME_H
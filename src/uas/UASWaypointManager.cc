@@ -29,6 +29,9 @@ This file is part of the QGROUNDCONTROL project
  *
  */
 
+#include <QThread>
+#include <QCoreApplication>
+#include <QMutexLocker>
 #include "UASWaypointManager.h"
 #include "UAS.h"
 
@@ -49,6 +52,40 @@ UASWaypointManager::UASWaypointManager(UAS &_uas)
     connect(&protocol_timer, SIGNAL(timeout()), this, SLOT(timeout()));
 }
 
+/**
+ * Only the thread of the manager modifies the list, it reads it without
+ * locking. Other threads get a copy, which stays valid until they return
+ * to the event loop of the application.
+ */
+QVector<Waypoint *> UASWaypointManager::getWaypointList()
+{
+    QMutexLocker locker(&waypointsMutex);
+    return waypoints;
+}
+
+/**
+ * Waypoints created in the thread of the UAS are moved to the thread of
+ * the application, where the widgets use them and where they are deleted.
+ */
+void UASWaypointManager::adoptWaypoint(Waypoint *wp)
+{
+    if (wp->thread() == QThread::currentThread() && QCoreApplication::instance())
+    {
+        wp->moveToThread(QCoreApplication::instance()->thread());
+    }
+}
+
+/**
+ * The waypoint may still be referenced by a copy of the list taken by a
+ * widget, it is therefore deleted by the event loop of the application.
+ * Call after waypointListChanged() was emitted, so the widgets drop the
+ * waypoint before it is deleted.
+ */
+void UASWaypointManager::releaseWaypoint(Waypoint *wp)
+{
+    wp->deleteLater();
+}
+
 void UASWaypointManager::timeout()
 {
     if (current_retries > 0)
@@ -250,6 +287,12 @@ void UASWaypointManager::handleWaypointCurrent(quint8 systemId, quint8 compId, m
 
 int UASWaypointManager::setCurrentWaypoint(quint16 seq)
 {
+    if (QThread::currentThread() != thread())
+    {
+        int result = -1;
+        QMetaObject::invokeMethod(this, "setCurrentWaypoint", Qt::BlockingQueuedConnection, Q_RETURN_ARG(int, result), Q_ARG(quint16, seq));
+        return result;
+    }
     if (seq < waypoints.size())
     {
         if(current_state == WP_IDLE)
@@ -290,27 +333,43 @@ int UASWaypointManager::setCurrentWaypoint(quint16 seq)
 
 void UASWaypointManager::localAddWaypoint(Waypoint *wp)
 {
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, "localAddWaypoint", Qt::BlockingQueuedConnection, Q_ARG(Waypoint*, wp));
+        return;
+    }
     if (wp)
     {
+        adoptWaypoint(wp);
+        waypointsMutex.lock();
         wp->setId(waypoints.size());
         waypoints.insert(waypoints.size(), wp);
+        waypointsMutex.unlock();
         emit waypointListChanged();
     }
 }
 
 int UASWaypointManager::localRemoveWaypoint(quint16 seq)
 {
+    if (QThread::currentThread() != thread())
+    {
+        int result = -1;
+        QMetaObject::invokeMethod(this, "localRemoveWaypoint", Qt::BlockingQueuedConnection, Q_RETURN_ARG(int, result), Q_ARG(quint16, seq));
+        return result;
+    }
     if (seq < waypoints.size())
     {
+        waypointsMutex.lock();
         Waypoint *t = waypoints[seq];
         waypoints.remove(seq);
-        delete t;
 
         for(int i = seq; i < waypoints.size(); i++)
         {
             waypoints[i]->setId(i);
         }
+        waypointsMutex.unlock();
         emit waypointListChanged();
+        releaseWaypoint(t);
         return 0;
     }
     return -1;
@@ -318,8 +377,14 @@ int UASWaypointManager::localRemoveWaypoint(quint16 seq)
 
 void UASWaypointManager::localMoveWaypoint(quint16 cur_seq, quint16 new_seq)
 {
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, "localMoveWaypoint", Qt::BlockingQueuedConnection, Q_ARG(quint16, cur_seq), Q_ARG(quint16, new_seq));
+        return;
+    }
     if (cur_seq != new_seq && cur_seq < waypoints.size() && new_seq < waypoints.size())
     {
+        QMutexLocker locker(&waypointsMutex);
         Waypoint *t = waypoints[cur_seq];
         if (cur_seq < new_seq)
         {
@@ -339,6 +404,7 @@ void UASWaypointManager::localMoveWaypoint(quint16 cur_seq, quint16 new_seq)
         }
         waypoints[new_seq] = t;
         //waypoints[new_seq]->setId(new_seq);
+        locker.unlock();
 
         emit waypointListChanged();
     }
@@ -346,6 +412,11 @@ void UASWaypointManager::localMoveWaypoint(quint16 cur_seq, quint16 new_seq)
 
 void UASWaypointManager::localSaveWaypoints(const QString &saveFile)
 {
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, "localSaveWaypoints", Qt::BlockingQueuedConnection, Q_ARG(QString, saveFile));
+        return;
+    }
     QFile file(saveFile);
     if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
         return;
@@ -360,30 +431,43 @@ void UASWaypointManager::localSaveWaypoints(const QString &saveFile)
 
 void UASWaypointManager::localLoadWaypoints(const QString &loadFile)
 {
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, "localLoadWaypoints", Qt::BlockingQueuedConnection, Q_ARG(QString, loadFile));
+        return;
+    }
     QFile file(loadFile);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
         return;
 
-    while(waypoints.size()>0)
-    {
-        Waypoint *t = waypoints[0];
-        waypoints.remove(0);
-        delete t;
-    }
-
+    QVector<Waypoint *> loaded;
     QTextStream in(&file);
     while (!in.atEnd())
     {
         Waypoint *t = new Waypoint();
         if(t->load(in))
         {
-            t->setId(waypoints.size());
-            waypoints.insert(waypoints.size(), t);
+            adoptWaypoint(t);
+            t->setId(loaded.size());
+            loaded.insert(loaded.size(), t);
+        }
+        else
+        {
+            delete t;
         }
     }
     file.close();
 
+    waypointsMutex.lock();
+    QVector<Waypoint *> removed = waypoints;
+    waypoints = loaded;
+    waypointsMutex.unlock();
+
     emit waypointListChanged();
+    foreach (Waypoint *t, removed)
+    {
+        releaseWaypoint(t);
+    }
 }
 
 void UASWaypointManager::globalAddWaypoint(Waypoint *wp)
@@ -398,6 +482,11 @@ int UASWaypointManager::globalRemoveWaypoint(quint16 seq)
 
 void UASWaypointManager::clearWaypointList()
 {
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, "clearWaypointList", Qt::BlockingQueuedConnection);
+        return;
+    }
     if(current_state == WP_IDLE)
     {
         protocol_timer.start(PROTOCOL_TIMEOUT_MS);
@@ -414,13 +503,22 @@ void UASWaypointManager::clearWaypointList()
 
 void UASWaypointManager::readWaypoints()
 {
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, "readWaypoints", Qt::BlockingQueuedConnection);
+        return;
+    }
     if(current_state == WP_IDLE)
     {
-        while(waypoints.size()>0)
+        waypointsMutex.lock();
+        QVector<Waypoint *> removed = waypoints;
+        waypoints.clear();
+        waypointsMutex.unlock();
+
+        emit waypointListChanged();
+        foreach (Waypoint *t, removed)
         {
-            Waypoint *t = waypoints.back();
-            delete t;
-            waypoints.pop_back();
+            releaseWaypoint(t);
         }
 
         protocol_timer.start(PROTOCOL_TIMEOUT_MS);
@@ -437,6 +535,11 @@ void UASWaypointManager::readWaypoints()
 
 void UASWaypointManager::writeWaypoints()
 {
+    if (QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, "writeWaypoints", Qt::BlockingQueuedConnection);
+        return;
+    }
     if (current_state == WP_IDLE)
     {
         if (waypoints.count() > 0)
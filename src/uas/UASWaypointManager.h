@@ -35,6 +35,7 @@ This file is part of the QGROUNDCONTROL project
 #include <QObject>
 #include <QVector>
 #include <QTimer>
+#include <QMutex>
 #include "Waypoint.h"
 #include <mavlink.h>
 class UAS;
@@ -44,7 +45,9 @@ class UAS;
  *
  * This class handles the communication with a waypoint manager on the MAV.
  * All waypoints are stored in the QVector waypoints, modifications can be done with the WaypointList widget.
- * Notice that currently the access to the internal waypoint storage is not guarded nor thread-safe. This works as long as no other widget alters the data.
+ * The remote and local operations may be called from any thread, they are executed in the thread of the UAS and block the caller until done.
+ * The list is therefore only modified in the thread of the UAS, other threads get a copy of it. Removed waypoints
+ * are deleted in the thread of the application once it returns to its event loop, so the copies stay valid while they are used.
  *
  * See http://qgroundcontrol.org/waypoint_protocol for more information about the protocol and the states.
  */
@@ -77,25 +80,25 @@ public:
 
     /** @name Remote operations */
     /*@{*/
-    void clearWaypointList();                       ///< Sends the waypoint clear all message to the MAV
-    void readWaypoints();                           ///< Requests the MAV's current waypoint list
-    void writeWaypoints();                          ///< Sends the local waypoint list to the MAV
-    int setCurrentWaypoint(quint16 seq);            ///< Changes the current waypoint and sends the sequence number of the waypoint that should get the new target waypoint to the UAS
+    Q_INVOKABLE void clearWaypointList();           ///< Sends the waypoint clear all message to the MAV
+    Q_INVOKABLE void readWaypoints();               ///< Requests the MAV's current waypoint list
+    Q_INVOKABLE void writeWaypoints();              ///< Sends the local waypoint list to the MAV
+    Q_INVOKABLE int setCurrentWaypoint(quint16 seq); ///< Changes the current waypoint and sends the sequence number of the waypoint that should get the new target waypoint to the UAS
     /*@}*/
 
     /** @name Local waypoint list operations */
     /*@{*/
-    const QVector<Waypoint *> &getWaypointList(void) { return waypoints; }  ///< Returns a const reference to the local waypoint list.
-    void localAddWaypoint(Waypoint *wp);                        ///< locally adds a new waypoint to the end of the list and changes its sequence number accordingly
-    int localRemoveWaypoint(quint16 seq);                       ///< locally remove the specified waypoint from the storage
-    void localMoveWaypoint(quint16 cur_seq, quint16 new_seq);   ///< locally move a waypoint from its current position cur_seq to a new position new_seq
-    void localSaveWaypoints(const QString &saveFile);           ///< saves the local waypoint list to saveFile
-    void localLoadWaypoints(const QString &loadFile);           ///< loads a waypoint list from loadFile
+    QVector<Waypoint *> getWaypointList(void);                  ///< Returns a copy of the local waypoint list, can be called from any thread
+    Q_INVOKABLE void localAddWaypoint(Waypoint *wp);            ///< locally adds a new waypoint to the end of the list and changes its sequence number accordingly
+    Q_INVOKABLE int localRemoveWaypoint(quint16 seq);           ///< locally remove the specified waypoint from the storage
+    Q_INVOKABLE void localMoveWaypoint(quint16 cur_seq, quint16 new_seq); ///< locally move a waypoint from its current position cur_seq to a new position new_seq
+    Q_INVOKABLE void localSaveWaypoints(const QString &saveFile); ///< saves the local waypoint list to saveFile
+    Q_INVOKABLE void localLoadWaypoints(const QString &loadFile); ///< loads a waypoint list from loadFile
     /*@}*/
 
     /** @name Global waypoint list operations */
     /*@{*/
-    const QVector<Waypoint *> &getGlobalWaypointList(void) { return waypoints; }  ///< Returns a const reference to the global waypoint list.
+    QVector<Waypoint *> getGlobalWaypointList(void) { return getWaypointList(); }  ///< Returns a copy of the global waypoint list.
     void globalAddWaypoint(Waypoint *wp);                        ///< locally adds a new waypoint to the end of the list and changes its sequence number accordingly
     int globalRemoveWaypoint(quint16 seq);                       ///< locally remove the specified waypoint from the storage
     /*@}*/
@@ -112,6 +115,9 @@ private:
     void sendWaypointAck(quint8 type);              ///< Sends a waypoint ack
     /*@}*/
 
+    void adoptWaypoint(Waypoint *wp);               ///< Hands a new waypoint to the thread of the application
+    void releaseWaypoint(Waypoint *wp);             ///< Deletes a removed waypoint once the readers of the list are done
+
 public slots:
     void timeout();                                 ///< Called by the timer if a response times out. Handles send retries.
 
@@ -130,6 +136,7 @@ private:
     quint8 current_partner_compid;                  ///< The current protocol communication target component
 
     QVector<Waypoint *> waypoints;                  ///< local waypoint list (main storage)
+    QMutex waypointsMutex;                          ///< Guards waypoints against the copies taken by other threads
     QVector<mavlink_waypoint_t *> waypoint_buffer;  ///< buffer for waypoints during communication
     QTimer protocol_timer;                          ///< Timer to catch timeouts
 };
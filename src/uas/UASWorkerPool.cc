@@ -0,0 +1,197 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the pool of vehicle processing threads
+ *
+ */
+
+#include <QMutexLocker>
+#include <QCoreApplication>
+#include "UASWorkerPool.h"
+
+UASWorkerProbe::UASWorkerProbe(const QTime* clock) :
+        clock(clock),
+        pending(-1),
+        latency(0),
+        maxLatency(0)
+{
+}
+
+void UASWorkerProbe::send()
+{
+    QMutexLocker locker(&mutex);
+    if (pending >= 0) return;
+    pending = clock->elapsed();
+    locker.unlock();
+    QMetaObject::invokeMethod(this, "ping", Qt::QueuedConnection, Q_ARG(int, pending));
+}
+
+void UASWorkerProbe::ping(int sent)
+{
+    QMutexLocker locker(&mutex);
+    latency = clock->elapsed() - sent;
+    maxLatency = qMax(maxLatency, latency);
+    pending = -1;
+}
+
+/**
+ * A thread which does not return to its event loop shows a latency
+ * growing with the time it is blocked.
+ */
+int UASWorkerProbe::getLatency()
+{
+    QMutexLocker locker(&mutex);
+    if (pending >= 0) return qMax(latency, clock->elapsed() - pending);
+    return latency;
+}
+
+int UASWorkerProbe::getMaxLatency()
+{
+    QMutexLocker locker(&mutex);
+    return maxLatency;
+}
+
+/**
+ * The threads are started right away and run at normal priority, above
+ * the decoders of the links and below the schedulers. The probe timer
+ * runs in the GUI thread, independent of the thread creating the pool.
+ */
+UASWorkerPool::UASWorkerPool(int threads, QObject* parent) :
+        QObject(parent)
+{
+    clock.start();
+    if (threads < 0) threads = qBound(1, QThread::idealThreadCount(), 8);
+    for (int i = 0; i < threads; i++)
+    {
+        QThread* worker = new QThread();
+        worker->start(QThread::NormalPriority);
+        workers.append(worker);
+        load.append(0);
+        UASWorkerProbe* workerProbe = new UASWorkerProbe(&clock);
+        workerProbe->moveToThread(worker);
+        probes.append(workerProbe);
+    }
+
+    guiProbe = new UASWorkerProbe(&clock);
+    QTimer* timer = new QTimer(guiProbe);
+    timer->setInterval(PROBE_INTERVAL);
+    connect(timer, SIGNAL(timeout()), this, SLOT(probe()), Qt::DirectConnection);
+    if (QCoreApplication::instance()) guiProbe->moveToThread(QCoreApplication::instance()->thread());
+    // Timers can only be started in their own thread
+    QMetaObject::invokeMethod(timer, "start", Qt::QueuedConnection);
+}
+
+/**
+ * Stops the event loops of all workers and waits for them to return.
+ * The vehicles are not deleted, but do not process messages anymore.
+ */
+UASWorkerPool::~UASWorkerPool()
+{
+    foreach (QThread* worker, workers)
+    {
+        worker->quit();
+    }
+    foreach (QThread* worker, workers)
+    {
+        worker->wait();
+        delete worker;
+    }
+    qDeleteAll(probes);
+    if (guiProbe->thread() == QThread::currentThread())
+    {
+        delete guiProbe;
+    }
+    else
+    {
+        guiProbe->deleteLater();
+    }
+}
+
+QThread* UASWorkerPool::assign(QObject* vehicle)
+{
+    if (workers.isEmpty()) return vehicle->thread();
+
+    QMutexLocker locker(&mutex);
+    int index = 0;
+    for (int i = 1; i < workers.size(); i++)
+    {
+        if (load[i] < load[index]) index = i;
+    }
+    load[index]++;
+    vehicles.insert(vehicle, index);
+    locker.unlock();
+
+    vehicle->moveToThread(workers[index]);
+    // Emitted in the worker thread, the slot only touches the guarded maps
+    connect(vehicle, SIGNAL(destroyed(QObject*)), this, SLOT(release(QObject*)), Qt::DirectConnection);
+    return workers[index];
+}
+
+int UASWorkerPool::getThreadCount()
+{
+    return workers.size();
+}
+
+QList<UASWorkerPool::Load> UASWorkerPool::getLoad()
+{
+    QMutexLocker locker(&mutex);
+    QList<Load> loads;
+    for (int i = 0; i < workers.size(); i++)
+    {
+        Load l;
+        l.vehicles = load[i];
+        l.latency = probes[i]->getLatency();
+        l.maxLatency = probes[i]->getMaxLatency();
+        loads.append(l);
+    }
+    return loads;
+}
+
+UASWorkerPool::Load UASWorkerPool::getGuiLoad()
+{
+    Load l;
+    l.vehicles = 0;
+    l.latency = guiProbe->getLatency();
+    l.maxLatency = guiProbe->getMaxLatency();
+    return l;
+}
+
+void UASWorkerPool::probe()
+{
+    guiProbe->send();
+    foreach (UASWorkerProbe* workerProbe, probes)
+    {
+        workerProbe->send();
+    }
+}
+
+void UASWorkerPool::release(QObject* vehicle)
+{
+    QMutexLocker locker(&mutex);
+    if (vehicles.contains(vehicle))
+    {
+        load[vehicles.take(vehicle)]--;
+    }
+}
@@ -0,0 +1,150 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the pool of vehicle processing threads
+ *
+ */
+
+#ifndef UASWORKERPOOL_H
+#define UASWORKERPOOL_H
+
+#include <QObject>
+#include <QThread>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QTime>
+#include <QTimer>
+
+/**
+ * @brief Measures the event loop latency of one thread
+ *
+ * A ping posted to the probe is executed by the event loop of its thread
+ * once all events queued before it are processed. The time the ping was
+ * queued is the delay any queued call into this thread currently sees.
+ **/
+class UASWorkerProbe : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @param clock Time base shared with the sender of the pings */
+    UASWorkerProbe(const QTime* clock);
+
+    /** @brief Post a ping unless the last one is still queued, can be called from any thread */
+    void send();
+    /** @brief Get the delay of the last ping in ms, the time since sending while a ping is still queued */
+    int getLatency();
+    /** @brief Get the longest delay of a ping in ms */
+    int getMaxLatency();
+
+public slots:
+    /** @brief Account the delay of a ping, executed in the thread of the probe */
+    void ping(int sent);
+
+protected:
+    const QTime* clock;
+    QMutex mutex;           ///< Protects the times, written by the sender and the probe thread
+    int pending;            ///< Time the queued ping was sent, -1 if none is queued
+    int latency;            ///< Delay of the last ping
+    int maxLatency;         ///< Longest delay of a ping
+};
+
+/**
+ * @brief Shards the vehicles over a fixed set of worker threads
+ *
+ * Each vehicle object is moved into the worker thread with the fewest
+ * vehicles. Decoding, setpoint handling and the waypoint protocol of the
+ * vehicle run there, so a busy vehicle only delays the vehicles sharing
+ * its thread and never the rendering in the GUI thread. The widgets are
+ * reached through queued connections.
+ *
+ * With a thread count of zero the pool is disabled and the vehicles stay
+ * in the GUI thread, as before.
+ *
+ * Every PROBE_INTERVAL the event loop latency of each worker and of the
+ * GUI thread is probed, so the effect of the number of vehicles on the
+ * processing delay can be measured, e.g. with the swarm of the simulation
+ * link.
+ **/
+class UASWorkerPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @param threads Number of worker threads, -1 for one per core */
+    UASWorkerPool(int threads = -1, QObject* parent = 0);
+    ~UASWorkerPool();
+
+    enum
+    {
+        PROBE_INTERVAL = 500   ///< Milliseconds between two latency probes
+    };
+
+    /** @brief Load of one worker thread */
+    struct Load
+    {
+        int vehicles;          ///< Vehicles assigned to the thread
+        int latency;           ///< Current event loop latency in ms
+        int maxLatency;        ///< Longest event loop latency in ms
+    };
+
+    /**
+     * @brief Move a vehicle into the least loaded worker thread
+     *
+     * Has to be called from the thread the vehicle lives in, before the
+     * vehicle is connected to objects which have to be in its thread.
+     *
+     * @param vehicle The vehicle object without parent, including all its children
+     * @return The thread the vehicle was moved to
+     */
+    QThread* assign(QObject* vehicle);
+    /** @brief Get the number of worker threads, 0 if the pool is disabled */
+    int getThreadCount();
+    /** @brief Get the vehicles and the latency per worker thread */
+    QList<Load> getLoad();
+    /** @brief Get the latency of the GUI thread, the vehicle count is not set */
+    Load getGuiLoad();
+
+protected slots:
+    /** @brief Forget a deleted vehicle */
+    void release(QObject* vehicle);
+    /** @brief Send a ping to every thread, executed in the GUI thread */
+    void probe();
+
+protected:
+    QList<QThread*> workers;        ///< The worker threads
+    QList<UASWorkerProbe*> probes;  ///< Latency probe per worker thread
+    UASWorkerProbe* guiProbe;       ///< Latency probe of the GUI thread, owns the probe timer
+    QTime clock;                    ///< Time base of the probes
+    QList<int> load;                ///< Vehicles per worker thread
+    QMap<QObject*, int> vehicles;   ///< Worker thread index per vehicle
+    QMutex mutex;                   ///< Protects the load and the vehicles
+
+private:
+    Q_DISABLE_COPY(UASWorkerPool)
+};
+
+#endif // UASWORKERPOOL_H
@@ -35,12 +35,14 @@ This file is part of the QGROUNDCONTROL project
 #include <QFileInfoList>
 #include <QBoxLayout>
 #include <QWidget>
+#include <QSpinBox>
 
 #include "CommConfigurationWindow.h"
 #include "SerialConfigurationWindow.h"
 #include "SerialLink.h"
 #include "UDPLink.h"
 #include "MAVLinkSimulationLink.h"
+#include "LogReplayLink.h"
 #ifdef OPAL_RT
 #include "OpalLink.h"
 #endif
@@ -109,6 +111,28 @@ CommConfigurationWindow::CommConfigurationWindow(LinkInterface* link, ProtocolIn
     if (sim != 0)
     {
         ui.linkGroupBox->setTitle(tr("MAVLink Simulation Link"));
+        // Additional vehicles load the groundstation like a swarm would
+        QSpinBox* swarm = new QSpinBox(ui.linkGroupBox);
+        swarm->setRange(0, 100);
+        swarm->setPrefix(tr("Additional vehicles: "));
+        // Throttling the simulation behaves like a narrow radio link
+        QSpinBox* rate = new QSpinBox(ui.linkGroupBox);
+        rate->setRange(0, 1000000);
+        rate->setSingleStep(9600);
+        rate->setPrefix(tr("Data rate: "));
+        rate->setSuffix(tr(" bit/s"));
+        rate->setSpecialValueText(tr("Data rate: unlimited"));
+        QBoxLayout* layout = new QBoxLayout(QBoxLayout::LeftToRight, ui.linkGroupBox);
+        layout->addWidget(swarm);
+        layout->addWidget(rate);
+        ui.linkGroupBox->setLayout(layout);
+        connect(swarm, SIGNAL(valueChanged(int)), sim, SLOT(setSwarmSize(int)));
+        connect(rate, SIGNAL(valueChanged(int)), sim, SLOT(setMaxDataRate(int)));
+    }
+    LogReplayLink* replay = dynamic_cast<LogReplayLink*>(link);
+    if (replay != 0)
+    {
+        ui.linkGroupBox->setTitle(tr("Log Replay Link"));
     }
 #ifdef OPAL_RT
     OpalLink* opal = dynamic_cast<OpalLink*>(link);
@@ -117,7 +141,7 @@ CommConfigurationWindow::CommConfigurationWindow(LinkInterface* link, ProtocolIn
         ui.linkGroupBox->setTitle(tr("Opal-RT Link"));
     }
 #endif
-    if (serial == 0 && udp == 0 && sim == 0
+    if (serial == 0 && udp == 0 && sim == 0 && replay == 0
 #ifdef OPAL_RT
         && opal == 0
 #endif
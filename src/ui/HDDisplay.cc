@@ -35,6 +35,7 @@ This file is part of the PIXHAWK project
 #include <QGraphicsTextItem>
 #include <QMouseEvent>
 #include "UASManager.h"
+#include "UASChannelRegistry.h"
 #include "HDDisplay.h"
 #include "ui_HDDisplay.h"
 #include "MG.h"
@@ -238,7 +239,7 @@ void HDDisplay::setActiveUAS(UASInterface* uas)
     if (this->uas != NULL && this->uas != uas)
     {
         // Disconnect any previously connected active MAV
-        disconnect(uas, SIGNAL(valueChanged(UASInterface*,QString,double,quint64)), this, SLOT(updateValue(UASInterface*,QString,double,quint64)));
+        disconnect(this->uas, SIGNAL(valuesChanged(UASValueFrame)), this, SLOT(updateFrame(UASValueFrame)));
     }
 
     // Now connect the new UAS
@@ -247,7 +248,7 @@ void HDDisplay::setActiveUAS(UASInterface* uas)
     // {
     //qDebug() << "UAS SET!" << "ID:" << uas->getUASID();
     // Setup communication
-    connect(uas, SIGNAL(valueChanged(UASInterface*,QString,double,quint64)), this, SLOT(updateValue(UASInterface*,QString,double,quint64)));
+    connect(uas, SIGNAL(valuesChanged(UASValueFrame)), this, SLOT(updateFrame(UASValueFrame)));
     //}
     this->uas = uas;
 }
@@ -603,6 +604,44 @@ void HDDisplay::updateValue(UASInterface* uas, QString name, double value, quint
     //}
 }
 
+/**
+ * Whether a channel is on the accept list is decided with its first value,
+ * the further values of rejected channels are dropped after a single
+ * vector access.
+ *
+ * @param channel The channel of the value, see UASChannelRegistry
+ * @param value The new value
+ * @param msec The timestamp of the value, in milliseconds
+ */
+void HDDisplay::updateChannelValue(int channel, double value, quint64 msec)
+{
+    if (channel < 0) return;
+    if (channel >= channelNames.size())
+    {
+        channelNames.resize(channel + 1);
+    }
+    if (channelNames[channel].isNull())
+    {
+        QString name = UASChannelRegistry::instance()->getName(channel);
+        channelNames[channel] = acceptList->contains(name) ? name : QString("");
+    }
+    if (!channelNames[channel].isEmpty())
+    {
+        updateValue(uas, channelNames[channel], value, msec);
+    }
+}
+
+/**
+ * @param frame The channels and values of one message
+ */
+void HDDisplay::updateFrame(const UASValueFrame& frame)
+{
+    for (int i = 0; i < frame.count; i++)
+    {
+        updateChannelValue(frame.channels[i], frame.values[i], frame.msec);
+    }
+}
+
 /**
  * @param y coordinate in pixels to be converted to reference mm units
  * @return the screen coordinate relative to the QGLWindow origin
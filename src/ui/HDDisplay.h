@@ -37,6 +37,7 @@ This file is part of the QGROUNDCONTROL project
 #include <QTimer>
 #include <QFontDatabase>
 #include <QMap>
+#include <QVector>
 #include <QPair>
 #include <cmath>
 
@@ -64,6 +65,10 @@ public:
 public slots:
     /** @brief Update a HDD value */
     void updateValue(UASInterface* uas, QString name, double value, quint64 msec);
+    /** @brief Update a HDD value identified by its telemetry channel */
+    void updateChannelValue(int channel, double value, quint64 msec);
+    /** @brief Update all HDD values decoded from one message */
+    void updateFrame(const UASValueFrame& frame);
     void start();
     void stop();
     void setActiveUAS(UASInterface* uas);
@@ -152,6 +157,7 @@ protected:
     float fineStrokeWidth;     ///< Fine line stroke width, used throughout the HUD
 
     QStringList* acceptList;   ///< Variable names to plot
+    QVector<QString> channelNames; ///< Accepted names by channel id, empty if not accepted, null if not yet looked up
 
     quint64 lastPaintTime;     ///< Last time this widget was refreshed
 
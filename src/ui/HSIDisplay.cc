@@ -443,13 +443,8 @@ void HSIDisplay::setActiveUAS(UASInterface* uas)
     //qDebug() << "ATTEMPTING TO SET UAS";
 
 
-    connect(uas, SIGNAL(gpsSatelliteStatusChanged(int,int,float,float,float,bool)), this, SLOT(updateSatellite(int,int,float,float,float,bool)));
-    connect(uas, SIGNAL(localPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateLocalPosition(UASInterface*,double,double,double,quint64)));
-    connect(uas, SIGNAL(globalPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateGlobalPosition(UASInterface*,double,double,double,quint64)));
-    connect(uas, SIGNAL(attitudeThrustSetPointChanged(UASInterface*,double,double,double,double,quint64)), this, SLOT(updateAttitudeSetpoints(UASInterface*,double,double,double,double,quint64)));
-    connect(uas, SIGNAL(positionSetPointsChanged(int,float,float,float,float,quint64)), this, SLOT(updatePositionSetpoints(int,float,float,float,float,quint64)));
-    connect(uas, SIGNAL(speedChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateSpeed(UASInterface*,double,double,double,quint64)));
-    connect(uas, SIGNAL(attitudeChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateAttitude(UASInterface*,double,double,double,quint64)));
+    // Satellites and setpoints arrive with the rate limited state as well
+    connect(uas, SIGNAL(stateChanged(UASStateSnapshot)), this, SLOT(updateSnapshot(UASStateSnapshot)));
 
     connect(uas, SIGNAL(attitudeControlEnabled(bool)), this, SLOT(updateAttitudeControllerEnabled(bool)));
     connect(uas, SIGNAL(positionXYControlEnabled(bool)), this, SLOT(updatePositionXYControllerEnabled(bool)));
@@ -520,6 +515,48 @@ void HSIDisplay::updateAttitudeSetpoints(UASInterface* uas, double rollDesired,
     altitudeSet = thrustDesired;
 }
 
+/**
+ * Position, speed, attitude, setpoints and satellites are taken from the
+ * rate limited state of the UAS, the display repaints at a fixed rate anyway.
+ *
+ * @param snapshot The latest state of the active UAS
+ */
+void HSIDisplay::updateSnapshot(const UASStateSnapshot& snapshot)
+{
+    if (snapshot.has(UASStateSnapshot::ATTITUDE))
+    {
+        updateAttitude(uas, snapshot.roll, snapshot.pitch, snapshot.yaw, snapshot.attitudeTime);
+    }
+    if (snapshot.has(UASStateSnapshot::LOCAL_POSITION))
+    {
+        updateLocalPosition(uas, snapshot.x, snapshot.y, snapshot.z, snapshot.localTime);
+    }
+    if (snapshot.has(UASStateSnapshot::GLOBAL_POSITION))
+    {
+        // Same argument order as UAS::globalPositionChanged(), longitude first
+        updateGlobalPosition(uas, snapshot.lon, snapshot.lat, snapshot.alt, snapshot.globalTime);
+    }
+    if (snapshot.has(UASStateSnapshot::SPEED))
+    {
+        updateSpeed(uas, snapshot.vx, snapshot.vy, snapshot.vz, snapshot.speedTime);
+    }
+    if (snapshot.has(UASStateSnapshot::ATTITUDE_SETPOINT))
+    {
+        updateAttitudeSetpoints(uas, snapshot.rollSetpoint, snapshot.pitchSetpoint, snapshot.yawSetpoint, snapshot.thrustSetpoint, snapshot.attitudeSetpointTime);
+    }
+    if (snapshot.has(UASStateSnapshot::POSITION_SETPOINT))
+    {
+        updatePositionSetpoints(snapshot.uasId, snapshot.xSetpoint, snapshot.ySetpoint, snapshot.zSetpoint, snapshot.yawPositionSetpoint, snapshot.positionSetpointTime);
+    }
+    if (snapshot.has(UASStateSnapshot::SATELLITES))
+    {
+        for (int i = 0; i < snapshot.satellites; i++)
+        {
+            updateSatellite(snapshot.uasId, snapshot.satellitePrn[i], snapshot.satelliteElevation[i], snapshot.satelliteAzimuth[i], snapshot.satelliteSnr[i], snapshot.satelliteUsed[i]);
+        }
+    }
+}
+
 void HSIDisplay::updateAttitude(UASInterface* uas, double roll, double pitch, double yaw, quint64 time)
 {
     Q_UNUSED(uas);
@@ -666,7 +703,7 @@ void HSIDisplay::drawWaypoints(QPainter& painter)
 {
     if (uas)
     {
-        const QVector<Waypoint*>& list = uas->getWaypointManager().getWaypointList();
+        QVector<Waypoint*> list = uas->getWaypointManager().getWaypointList();
 //        for (int i = 0; i < list.size(); i++)
 //        {
 //            QPointF in(list.at(i)->getX(), list.at(i)->getY());
@@ -55,6 +55,8 @@ public slots:
     void setMetricWidth(double width);
     void updateSatellite(int uasid, int satid, float azimuth, float direction, float snr, bool used);
     void updateAttitudeSetpoints(UASInterface*, double rollDesired, double pitchDesired, double yawDesired, double thrustDesired, quint64 usec);
+    /** @brief Update position, speed and attitude from the state of the UAS */
+    void updateSnapshot(const UASStateSnapshot& snapshot);
     void updateAttitude(UASInterface* uas, double roll, double pitch, double yaw, quint64 time);
     void updatePositionSetpoints(int uasid, float xDesired, float yDesired, float zDesired, float yawDesired, quint64 usec);
     void updateLocalPosition(UASInterface*, double x, double y, double z, quint64 usec);
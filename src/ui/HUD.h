@@ -71,6 +71,8 @@ public slots:
     /** @brief Update a HUD value */
     void updateValue(UASInterface* uas, QString name, double value, quint64 msec);
 
+    /** @brief Update the attitude and battery from the state of the UAS */
+    void updateSnapshot(const UASStateSnapshot& snapshot);
     void updateAttitude(UASInterface* uas, double roll, double pitch, double yaw, quint64 timestamp);
     void updateAttitudeThrustSetPoint(UASInterface*, double rollDesired, double pitchDesired, double yawDesired, double thrustDesired, quint64 usec);
     void updateBattery(UASInterface*, double, double, int);
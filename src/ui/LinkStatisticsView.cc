@@ -0,0 +1,255 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class LinkStatisticsView
+ */
+
+#include <QVBoxLayout>
+#include <QStringList>
+#include "LinkStatisticsView.h"
+#include "MAVLinkProtocol.h"
+#include "LinkManager.h"
+#include "LinkRingBuffer.h"
+#include "UASManager.h"
+#include "UASWorkerPool.h"
+
+LinkStatisticsView::LinkStatisticsView(MAVLinkProtocol* protocol, QWidget *parent) :
+        QWidget(parent),
+        protocol(protocol),
+        statistics(protocol->getStatistics()),
+        deduplicator(protocol->getDeduplicator()),
+        tree(new QTreeWidget(this)),
+        queueTree(new QTreeWidget(this)),
+        threadTree(new QTreeWidget(this))
+{
+    QStringList header;
+    header << tr("Source") << tr("Packets/s") << tr("Bytes/s") << tr("Loss %") << tr("Lost") << tr("Packets") << tr("Gap 50%") << tr("Gap 95%") << tr("First %") << tr("Late by ms") << tr("Ring max %") << tr("Ring overruns");
+    tree->setHeaderLabels(header);
+    tree->setRootIsDecorated(true);
+    tree->setAlternatingRowColors(true);
+
+    linkRoot = new QTreeWidgetItem(tree, QStringList(tr("Links")));
+    componentRoot = new QTreeWidgetItem(tree, QStringList(tr("Components")));
+    linkRoot->setExpanded(true);
+    componentRoot->setExpanded(true);
+
+    QStringList queueHeader;
+    queueHeader << tr("Outbound queue") << tr("Queued") << tr("Max queued") << tr("Frames") << tr("Dropped") << tr("Mean latency ms") << tr("Max latency ms");
+    queueTree->setHeaderLabels(queueHeader);
+    queueTree->setRootIsDecorated(true);
+    queueTree->setAlternatingRowColors(true);
+
+    QStringList threadHeader;
+    threadHeader << tr("Thread") << tr("Vehicles") << tr("Latency ms") << tr("Max latency ms");
+    threadTree->setHeaderLabels(threadHeader);
+    threadTree->setRootIsDecorated(false);
+    threadTree->setAlternatingRowColors(true);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(tree, 2);
+    layout->addWidget(queueTree, 1);
+    layout->addWidget(threadTree, 1);
+    setLayout(layout);
+
+    connect(statistics, SIGNAL(statisticsChanged()), this, SLOT(refresh()));
+}
+
+void LinkStatisticsView::refresh()
+{
+    if (!isVisible()) return;
+
+    MAVLinkStatistics::Report report;
+    foreach (int id, statistics->getLinks())
+    {
+        if (!statistics->getLinkReport(id, &report)) continue;
+        QTreeWidgetItem* item = linkItems.value(id, NULL);
+        if (item == NULL)
+        {
+            QString name = tr("Link %1").arg(id);
+            foreach (LinkInterface* link, LinkManager::instance()->getLinks())
+            {
+                if (link->getId() == id) name = link->getName();
+            }
+            item = new QTreeWidgetItem(linkRoot, QStringList(name));
+            linkItems.insert(id, item);
+        }
+        setRow(item, report);
+        setArrivals(item, id);
+        setReceiveBuffer(item, id);
+    }
+
+    foreach (int key, statistics->getComponents())
+    {
+        int sysid = key / 256;
+        int compid = key % 256;
+        if (!statistics->getComponentReport(sysid, compid, &report)) continue;
+        QTreeWidgetItem* item = componentItems.value(key, NULL);
+        if (item == NULL)
+        {
+            item = new QTreeWidgetItem(componentRoot, QStringList(tr("System %1 / Component %2").arg(sysid).arg(compid)));
+            componentItems.insert(key, item);
+        }
+        setRow(item, report);
+    }
+
+    refreshQueues();
+    refreshThreads();
+}
+
+/**
+ * The GUI thread row counts all vehicles, the vehicles of a disabled
+ * pool are processed in the GUI thread.
+ */
+void LinkStatisticsView::refreshThreads()
+{
+    UASWorkerPool* pool = UASManager::instance()->getWorkerPool();
+    QList<UASWorkerPool::Load> loads = pool->getLoad();
+    loads.prepend(pool->getGuiLoad());
+    loads[0].vehicles = UASManager::instance()->getUASCount();
+
+    for (int i = 0; i < loads.size(); i++)
+    {
+        QTreeWidgetItem* item = threadTree->topLevelItem(i);
+        if (item == NULL)
+        {
+            item = new QTreeWidgetItem(threadTree, QStringList((i == 0) ? tr("GUI") : tr("Vehicle thread %1").arg(i)));
+        }
+        item->setText(1, QString::number(loads[i].vehicles));
+        item->setText(2, QString::number(loads[i].latency));
+        item->setText(3, QString::number(loads[i].maxLatency));
+    }
+}
+
+void LinkStatisticsView::refreshQueues()
+{
+    // Drop the rows of deleted links
+    QList<MAVLinkScheduler*> schedulers = protocol->getSchedulers();
+    foreach (MAVLinkScheduler* scheduler, queueItems.keys())
+    {
+        if (!schedulers.contains(scheduler)) delete queueItems.take(scheduler);
+    }
+
+    foreach (MAVLinkScheduler* scheduler, schedulers)
+    {
+        QTreeWidgetItem* item = queueItems.value(scheduler, NULL);
+        if (item == NULL)
+        {
+            item = new QTreeWidgetItem(queueTree, QStringList(scheduler->getLink()->getName()));
+            for (int i = 0; i < MAVLinkScheduler::PRIORITY_COUNT; i++)
+            {
+                new QTreeWidgetItem(item, QStringList(MAVLinkScheduler::getPriorityName(i)));
+            }
+            item->setExpanded(true);
+            queueItems.insert(scheduler, item);
+        }
+
+        int depth = 0;
+        for (int i = 0; i < MAVLinkScheduler::PRIORITY_COUNT; i++)
+        {
+            MAVLinkScheduler::Statistics s = scheduler->getStatistics(i);
+            QTreeWidgetItem* row = item->child(i);
+            row->setText(1, QString::number(s.depth));
+            row->setText(2, QString::number(s.maxDepth));
+            row->setText(3, QString::number(s.frames));
+            row->setText(4, QString::number(s.drops));
+            row->setText(5, QString::number(s.meanLatency, 'f', 1));
+            row->setText(6, QString::number(s.maxLatency));
+            depth += s.depth;
+        }
+        item->setText(1, QString::number(depth));
+    }
+}
+
+void LinkStatisticsView::setRow(QTreeWidgetItem* item, const MAVLinkStatistics::Report& report)
+{
+    item->setText(1, QString::number(report.packetRate, 'f', 1));
+    item->setText(2, QString::number(report.byteRate, 'f', 0));
+    item->setText(3, QString::number(report.loss, 'f', 1));
+    item->setText(4, QString::number(report.lost));
+    item->setText(5, QString::number(report.packets));
+    item->setText(6, percentile(report, 0.5));
+    item->setText(7, percentile(report, 0.95));
+}
+
+/**
+ * Only packets received on more than one link are counted. The share of
+ * them which arrived first on this link shows which link is fresher.
+ */
+void LinkStatisticsView::setArrivals(QTreeWidgetItem* item, int linkId)
+{
+    MAVLinkDeduplicator::Statistics arrivals;
+    if (!deduplicator->getStatistics(linkId, &arrivals)) return;
+    quint64 contested = arrivals.wins + arrivals.lateArrivals;
+    if (contested == 0) return;
+    item->setText(8, QString::number(100.0 * arrivals.wins / contested, 'f', 1));
+    if (arrivals.lateArrivals > 0)
+    {
+        item->setText(9, QString::number((double)arrivals.totalDelay / arrivals.lateArrivals, 'f', 1));
+    }
+}
+
+/**
+ * The high-water mark of the receive ring shows how close the decoder of
+ * the link came to falling behind, the overruns count the reads of which
+ * bytes had to be dropped.
+ */
+void LinkStatisticsView::setReceiveBuffer(QTreeWidgetItem* item, int linkId)
+{
+    foreach (LinkInterface* link, LinkManager::instance()->getLinks())
+    {
+        if (link->getId() != linkId) continue;
+        LinkRingBuffer* ring = protocol->getReceiveBuffer(link);
+        if (ring == NULL) return;
+        item->setText(10, QString::number(100.0 * ring->getHighWaterMark() / ring->getSize(), 'f', 1));
+        item->setText(11, tr("%1 (%2 bytes)").arg(ring->getOverruns()).arg(ring->getOverrunBytes()));
+        return;
+    }
+}
+
+/**
+ * The histogram only knows the bin of each gap, the percentile is
+ * therefore reported as the upper limit of its bin.
+ */
+QString LinkStatisticsView::percentile(const MAVLinkStatistics::Report& report, double fraction)
+{
+    quint64 total = 0;
+    for (int i = 0; i < MAVLinkStatistics::JITTER_BINS; i++)
+    {
+        total += report.jitter[i];
+    }
+    if (total == 0) return "-";
+
+    quint64 sum = 0;
+    for (int i = 0; i < MAVLinkStatistics::JITTER_BINS - 1; i++)
+    {
+        sum += report.jitter[i];
+        if (sum >= fraction * total)
+        {
+            return QString("< %1 ms").arg(MAVLinkStatistics::getJitterBinLimit(i));
+        }
+    }
+    return QString(">= %1 ms").arg(MAVLinkStatistics::getJitterBinLimit(MAVLinkStatistics::JITTER_BINS - 2));
+}
@@ -0,0 +1,91 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class LinkStatisticsView
+ */
+
+#ifndef LINKSTATISTICSVIEW_H
+#define LINKSTATISTICSVIEW_H
+
+#include <QtGui/QWidget>
+#include <QTreeWidget>
+#include <QMap>
+#include "MAVLinkStatistics.h"
+#include "MAVLinkDeduplicator.h"
+
+class MAVLinkProtocol;
+class MAVLinkScheduler;
+
+/**
+ * @brief Live table of the receive statistics
+ *
+ * Shows packet rate, byte rate, loss and the inter-arrival time
+ * distribution of every link and every sending component. For links
+ * carrying the same vehicle, the share of packets which arrived first
+ * and the delay of the late copies are shown, as well as the high-water
+ * mark and the overruns of the receive ring of each link. The table
+ * is refreshed with each sample of the statistics while it is visible.
+ * A second table shows the outbound queues of every link by priority,
+ * a third the vehicles and the event loop latency of every vehicle
+ * thread and of the GUI thread.
+ */
+class LinkStatisticsView : public QWidget
+{
+    Q_OBJECT
+public:
+    LinkStatisticsView(MAVLinkProtocol* protocol, QWidget *parent = 0);
+
+public slots:
+    /** @brief Reload all rows from the statistics */
+    void refresh();
+
+protected:
+    MAVLinkProtocol* protocol;
+    MAVLinkStatistics* statistics;
+    MAVLinkDeduplicator* deduplicator;
+    QTreeWidget* tree;
+    QTreeWidget* queueTree;
+    QTreeWidget* threadTree;
+    QTreeWidgetItem* linkRoot;
+    QTreeWidgetItem* componentRoot;
+    QMap<int, QTreeWidgetItem*> linkItems;      ///< Rows by link id
+    QMap<int, QTreeWidgetItem*> componentItems; ///< Rows by sysid * 256 + compid
+    QMap<MAVLinkScheduler*, QTreeWidgetItem*> queueItems; ///< Rows by outbound scheduler
+
+    /** @brief Reload the outbound queue rows */
+    void refreshQueues();
+    /** @brief Reload the vehicle thread rows */
+    void refreshThreads();
+    /** @brief Write a report into the columns of a row */
+    void setRow(QTreeWidgetItem* item, const MAVLinkStatistics::Report& report);
+    /** @brief Write the first arrival share and the delay of a link into its row */
+    void setArrivals(QTreeWidgetItem* item, int linkId);
+    /** @brief Write the high-water mark and overruns of the receive ring of a link into its row */
+    void setReceiveBuffer(QTreeWidgetItem* item, int linkId);
+    /** @brief Get the upper limit of the bin containing the given fraction of all gaps */
+    static QString percentile(const MAVLinkStatistics::Report& report, double fraction);
+};
+
+#endif // LINKSTATISTICSVIEW_H
@@ -42,10 +42,16 @@ MAVLinkSettingsWidget::MAVLinkSettingsWidget(MAVLinkProtocol* protocol, QWidget
     connect(m_ui->heartbeatCheckBox, SIGNAL(toggled(bool)), protocol, SLOT(enableHeartbeats(bool)));
     connect(protocol, SIGNAL(loggingChanged(bool)), m_ui->loggingCheckBox, SLOT(setChecked(bool)));
     connect(m_ui->loggingCheckBox, SIGNAL(toggled(bool)), protocol, SLOT(enableLogging(bool)));
+    connect(protocol, SIGNAL(streamRateControlChanged(bool)), m_ui->streamRateCheckBox, SLOT(setChecked(bool)));
+    connect(m_ui->streamRateCheckBox, SIGNAL(toggled(bool)), protocol, SLOT(enableStreamRateControl(bool)));
+    connect(protocol, SIGNAL(streamRateTargetChanged(int)), m_ui->streamRateSpinBox, SLOT(setValue(int)));
+    connect(m_ui->streamRateSpinBox, SIGNAL(valueChanged(int)), protocol, SLOT(setStreamRateTarget(int)));
 
     // Initialize state
     m_ui->heartbeatCheckBox->setChecked(protocol->heartbeatsEnabled());
     m_ui->loggingCheckBox->setChecked(protocol->loggingEnabled());
+    m_ui->streamRateCheckBox->setChecked(protocol->streamRateControlEnabled());
+    m_ui->streamRateSpinBox->setValue(protocol->getStreamRateTarget());
 }
 
 MAVLinkSettingsWidget::~MAVLinkSettingsWidget()
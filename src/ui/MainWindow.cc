@@ -39,6 +39,7 @@ This file is part of the QGROUNDCONTROL project
 #include "MAVLinkSimulationLink.h"
 #include "SerialLink.h"
 #include "UDPLink.h"
+#include "LogReplayLink.h"
 #include "MAVLinkProtocol.h"
 #include "CommConfigurationWindow.h"
 #include "WaypointList.h"
@@ -169,6 +170,12 @@ void MainWindow::buildWidgets()
   rcViewDockWidget = new QDockWidget(tr("Radio Control"), this);
   rcViewDockWidget->setWidget( new QGCRemoteControlView(this) );
 
+  linkStatisticsDockWidget = new QDockWidget(tr("Link Statistics"), this);
+  linkStatisticsDockWidget->setWidget( new LinkStatisticsView(mavlink, this) );
+
+  messageBandwidthDockWidget = new QDockWidget(tr("Message Bandwidth"), this);
+  messageBandwidthDockWidget->setWidget( new MessageBandwidthView(mavlink, this) );
+
   // Dialogue widgets
   //FIXME: free memory in destructor
   joystick    = new JoystickInput();
@@ -325,6 +332,7 @@ void MainWindow::connectActions()
 {
     // Connect actions from ui
     connect(ui.actionAdd_Link, SIGNAL(triggered()), this, SLOT(addLink()));
+    connect(ui.actionReplay_Log, SIGNAL(triggered()), this, SLOT(addReplayLink()));
 
     // Connect internal actions
     connect(UASManager::instance(), SIGNAL(UASCreated(UASInterface*)), this, SLOT(UASCreated(UASInterface*)));
@@ -336,6 +344,7 @@ void MainWindow::connectActions()
     connect(ui.actionEmergency_Kill, SIGNAL(triggered()), UASManager::instance(), SLOT(killActiveUAS()));
 
     connect(ui.actionConfiguration, SIGNAL(triggered()), UASManager::instance(), SLOT(configureActiveUAS()));
+    connect(ui.actionRecord_Telemetry, SIGNAL(toggled(bool)), UASManager::instance(), SLOT(setMissionLogging(bool)));
 
     // User interface actions
     connect(ui.actionPilotView, SIGNAL(triggered()), this, SLOT(loadPilotView()));
@@ -418,6 +427,19 @@ void MainWindow::addLink()
     // TODO Implement the link removal!
 }
 
+void MainWindow::addReplayLink()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Replay Log"),
+                                                    MAVLinkProtocol::getLogfileName(),
+                                                    tr("MAVLink Logs (*.tlog)"));
+    if (fileName.isEmpty()) return;
+
+    LogReplayLink* link = new LogReplayLink(fileName);
+    addLink(link);
+    // Replay starts right away, the link can be paused and stopped like any other link
+    link->connect();
+}
+
 void MainWindow::addLink(LinkInterface *link)
 {
     LinkManager::instance()->addProtocol(link, mavlink);
@@ -931,6 +953,13 @@ void MainWindow::loadEngineerView()
         parametersDockWidget->show();
     }
 
+    // LINK STATISTICS
+    if (linkStatisticsDockWidget)
+    {
+        addDockWidget(Qt::BottomDockWidgetArea, linkStatisticsDockWidget);
+        linkStatisticsDockWidget->show();
+    }
+
     this->show();
 }
 
@@ -947,6 +976,13 @@ void MainWindow::loadMAVLinkView()
         }
     }
 
+    // MESSAGE BANDWIDTH
+    if (messageBandwidthDockWidget)
+    {
+        addDockWidget(Qt::BottomDockWidgetArea, messageBandwidthDockWidget);
+        messageBandwidthDockWidget->show();
+    }
+
     this->show();
 }
 
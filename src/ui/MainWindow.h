@@ -63,6 +63,8 @@ This file is part of the QGROUNDCONTROL project
 #include "HSIDisplay.h"
 #include "QGCDataPlot2D.h"
 #include "QGCRemoteControlView.h"
+#include "LinkStatisticsView.h"
+#include "MessageBandwidthView.h"
 
 #include "LogCompressor.h"
 
@@ -99,6 +101,8 @@ public slots:
     void showStatusMessage(const QString& status);
     void addLink();
     void addLink(LinkInterface* link);
+    /** @brief Select a packet log and add a link replaying it */
+    void addReplayLink();
     void configure();
     void UASCreated(UASInterface* uas);
     void startVideoCapture();
@@ -174,6 +178,8 @@ protected:
     QPointer<QDockWidget> watchdogControlDockWidget;
     QPointer<QDockWidget> hsiDockWidget;
     QPointer<QDockWidget> rcViewDockWidget;
+    QPointer<QDockWidget> linkStatisticsDockWidget;
+    QPointer<QDockWidget> messageBandwidthDockWidget;
 
     // Popup widgets
     JoystickWidget* joystickWidget;
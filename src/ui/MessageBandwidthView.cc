@@ -0,0 +1,185 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class MessageBandwidthView
+ */
+
+#include <QFile>
+#include <QTextStream>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QDesktopServices>
+#include "MessageBandwidthView.h"
+#include "MAVLinkProtocol.h"
+#include "LinkManager.h"
+
+MessageBandwidthView::MessageBandwidthView(MAVLinkProtocol* protocol, QWidget *parent) :
+        QWidget(parent),
+        statistics(protocol->getStatistics()),
+        linkBox(new QComboBox(this)),
+        directionBox(new QComboBox(this)),
+        table(new QTableWidget(0, 6, this))
+{
+    directionBox->addItem(tr("Received"));
+    directionBox->addItem(tr("Sent"));
+    QPushButton* exportButton = new QPushButton(tr("Export CSV"), this);
+
+    QStringList header;
+    header << tr("Message ID") << tr("Messages/s") << tr("Bytes/s") << tr("Capacity %") << tr("Messages") << tr("Bytes");
+    table->setHorizontalHeaderLabels(header);
+    table->verticalHeader()->hide();
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setSortingEnabled(true);
+    table->sortByColumn(2, Qt::DescendingOrder);
+
+    QHBoxLayout* controls = new QHBoxLayout();
+    controls->addWidget(linkBox, 1);
+    controls->addWidget(directionBox);
+    controls->addWidget(exportButton);
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addLayout(controls);
+    layout->addWidget(table);
+    setLayout(layout);
+
+    connect(linkBox, SIGNAL(currentIndexChanged(int)), this, SLOT(selectionChanged()));
+    connect(directionBox, SIGNAL(currentIndexChanged(int)), this, SLOT(selectionChanged()));
+    connect(exportButton, SIGNAL(clicked()), this, SLOT(exportCSV()));
+    connect(statistics, SIGNAL(statisticsChanged()), this, SLOT(refresh()));
+}
+
+LinkInterface* MessageBandwidthView::getSelectedLink()
+{
+    if (linkBox->currentIndex() < 0) return NULL;
+    int id = linkBox->itemData(linkBox->currentIndex()).toInt();
+    foreach (LinkInterface* link, LinkManager::instance()->getLinks())
+    {
+        if (link->getId() == id) return link;
+    }
+    return NULL;
+}
+
+void MessageBandwidthView::updateLinks()
+{
+    foreach (int id, statistics->getLinks())
+    {
+        if (linkBox->findData(id) >= 0) continue;
+        QString name = tr("Link %1").arg(id);
+        foreach (LinkInterface* link, LinkManager::instance()->getLinks())
+        {
+            if (link->getId() == id) name = link->getName();
+        }
+        linkBox->addItem(name, id);
+    }
+}
+
+void MessageBandwidthView::selectionChanged()
+{
+    table->setRowCount(0);
+    rows.clear();
+    refresh();
+}
+
+void MessageBandwidthView::refresh()
+{
+    updateLinks();
+    if (!isVisible() || linkBox->currentIndex() < 0) return;
+
+    int linkId = linkBox->itemData(linkBox->currentIndex()).toInt();
+    bool sent = (directionBox->currentIndex() == 1);
+    double capacity = MAVLinkStatistics::getCapacity(getSelectedLink());
+
+    // Rows move while sorting is enabled, re-sort once after the update
+    table->setSortingEnabled(false);
+    foreach (const MAVLinkStatistics::MessageReport& report, statistics->getMessageReports(linkId, sent))
+    {
+        int row = rows.value(report.msgid, -1);
+        if (row < 0)
+        {
+            row = table->rowCount();
+            table->insertRow(row);
+            for (int column = 0; column < table->columnCount(); column++)
+            {
+                table->setItem(row, column, new QTableWidgetItem());
+            }
+            table->item(row, 0)->setData(Qt::DisplayRole, report.msgid);
+        }
+        table->item(row, 1)->setData(Qt::DisplayRole, qRound(report.messageRate * 10) / 10.0);
+        table->item(row, 2)->setData(Qt::DisplayRole, qRound(report.byteRate));
+        table->item(row, 3)->setData(Qt::DisplayRole, (capacity > 0) ? qRound(1000 * report.byteRate / capacity) / 10.0 : 0.0);
+        table->item(row, 4)->setData(Qt::DisplayRole, report.messages);
+        table->item(row, 5)->setData(Qt::DisplayRole, report.bytes);
+    }
+    table->setSortingEnabled(true);
+
+    // Sorting changed the row of each message id
+    rows.clear();
+    for (int row = 0; row < table->rowCount(); row++)
+    {
+        rows.insert(table->item(row, 0)->data(Qt::DisplayRole).toInt(), row);
+    }
+}
+
+void MessageBandwidthView::exportCSV()
+{
+    QString fileName = QFileDialog::getSaveFileName(
+            this, tr("Export File Name"), QDesktopServices::storageLocation(QDesktopServices::DesktopLocation),
+            "CSV Files (*.csv)");
+    if (fileName.isEmpty()) return;
+    if (!fileName.endsWith(".csv")) fileName.append(".csv");
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        QMessageBox msgBox;
+        msgBox.setIcon(QMessageBox::Critical);
+        msgBox.setText(tr("Could not write %1").arg(fileName));
+        msgBox.setInformativeText(file.errorString());
+        msgBox.exec();
+        return;
+    }
+
+    QTextStream out(&file);
+    out << "link,direction";
+    for (int column = 0; column < table->columnCount(); column++)
+    {
+        out << "," << table->horizontalHeaderItem(column)->text();
+    }
+    out << "\n";
+    for (int row = 0; row < table->rowCount(); row++)
+    {
+        out << "\"" << linkBox->currentText() << "\"," << directionBox->currentText();
+        for (int column = 0; column < table->columnCount(); column++)
+        {
+            out << "," << table->item(row, column)->data(Qt::DisplayRole).toString();
+        }
+        out << "\n";
+    }
+}
@@ -0,0 +1,74 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class MessageBandwidthView
+ */
+
+#ifndef MESSAGEBANDWIDTHVIEW_H
+#define MESSAGEBANDWIDTHVIEW_H
+
+#include <QtGui/QWidget>
+#include <QTableWidget>
+#include <QComboBox>
+#include <QMap>
+#include "MAVLinkStatistics.h"
+
+class MAVLinkProtocol;
+
+/**
+ * @brief Sortable table of the bandwidth used per message id
+ *
+ * Shows for one link and one direction the message rate, the byte rate
+ * and the share of the nominal link capacity of each message id. The
+ * table can be exported as CSV file.
+ */
+class MessageBandwidthView : public QWidget
+{
+    Q_OBJECT
+public:
+    MessageBandwidthView(MAVLinkProtocol* protocol, QWidget *parent = 0);
+
+public slots:
+    /** @brief Reload the table from the statistics */
+    void refresh();
+    /** @brief Clear the table after another link or direction was selected */
+    void selectionChanged();
+    /** @brief Ask for a file name and write the table as CSV */
+    void exportCSV();
+
+protected:
+    MAVLinkStatistics* statistics;
+    QComboBox* linkBox;
+    QComboBox* directionBox;
+    QTableWidget* table;
+    QMap<int, int> rows;    ///< Table row by message id
+
+    /** @brief Get the currently selected link, NULL if none */
+    LinkInterface* getSelectedLink();
+    /** @brief Add the links which are not yet listed to the link selection */
+    void updateLinks();
+};
+
+#endif // MESSAGEBANDWIDTHVIEW_H
@@ -39,6 +39,8 @@ This file is part of the QGROUNDCONTROL project
 #include <QDesktopServices>
 #include "QGCDataPlot2D.h"
 #include "ui_QGCDataPlot2D.h"
+#include "LogReader.h"
+#include "MissionLogReader.h"
 #include "MG.h"
 #include <cmath>
 
@@ -47,11 +49,19 @@ This file is part of the QGROUNDCONTROL project
 QGCDataPlot2D::QGCDataPlot2D(QWidget *parent) :
         QWidget(parent),
         plot(new IncrementalPlot()),
+        compressor(NULL),
         logFile(NULL),
+        compressedFile(NULL),
+        loader(new QGCCsvLoader(this)),
+        plottedRows(0),
+        xColumn(0),
         ui(new Ui::QGCDataPlot2D)
 {
     ui->setupUi(this);
 
+    // Rows are appended to the plot while the file is loading
+    connect(loader, SIGNAL(rowsLoaded(int)), this, SLOT(appendRows(int)));
+
     // Add plot to ui
     QHBoxLayout* layout = new QHBoxLayout(ui->plotFrame);
     layout->addWidget(plot);
@@ -75,7 +85,12 @@ void QGCDataPlot2D::reloadFile()
 {
     if (QFileInfo(fileName).isReadable())
     {
-        if (ui->inputFileType->currentText().contains("pxIMU"))
+        // Binary logs are recognized by their name as well
+        if (fileName.endsWith(".bin") || fileName.endsWith(".mlog") || ui->inputFileType->currentText().contains("Binary"))
+        {
+            loadBinaryLog(fileName, ui->yAxis->text());
+        }
+        else if (ui->inputFileType->currentText().contains("pxIMU"))
         {
             loadRawLog(fileName, ui->xAxis->currentText(), ui->yAxis->text());
         }
@@ -90,7 +105,12 @@ void QGCDataPlot2D::loadFile()
 {
     if (QFileInfo(fileName).isReadable())
     {
-        if (ui->inputFileType->currentText().contains("pxIMU"))
+        // Binary logs are recognized by their name as well
+        if (fileName.endsWith(".bin") || fileName.endsWith(".mlog") || ui->inputFileType->currentText().contains("Binary"))
+        {
+            loadBinaryLog(fileName);
+        }
+        else if (ui->inputFileType->currentText().contains("pxIMU"))
         {
             loadRawLog(fileName);
         }
@@ -106,7 +126,12 @@ void QGCDataPlot2D::loadFile(QString file)
     fileName = file;
     if (QFileInfo(fileName).isReadable())
     {
-        if (fileName.contains(".raw") || fileName.contains(".imu"))
+        if (fileName.endsWith(".bin") || fileName.endsWith(".mlog"))
+        {
+            // Binary copy of a linechart log, e.g. "log.txt.bin", or a mission log
+            loadBinaryLog(fileName);
+        }
+        else if (fileName.contains(".raw") || fileName.contains(".imu"))
         {
             loadRawLog(fileName);
         }
@@ -262,7 +287,7 @@ void QGCDataPlot2D::selectFile()
     // Let user select the log file name
     //QDate date(QDate::currentDate());
     // QString("./pixhawk-log-" + date.toString("yyyy-MM-dd") + "-" + QString::number(logindex) + ".log")
-    fileName = QFileDialog::getOpenFileName(this, tr("Specify log file name"), tr("."), tr("Logfile (*.txt)"));
+    fileName = QFileDialog::getOpenFileName(this, tr("Specify log file name"), tr("."), tr("Logfile (*.txt *.bin *.mlog)"));
     // Store reference to file
 
     QFileInfo fileInfo(fileName);
@@ -287,44 +312,198 @@ void QGCDataPlot2D::selectFile()
 
 }
 
+/**
+ * The raw log is converted to CSV in the background. The rows are plotted
+ * while they are converted and the finished file is then loaded like a CSV
+ * file. The conversion can be aborted from the progress dialog.
+ *
+ * @param file The raw log
+ * @param xAxisName Column of the x axis, the timestamp if empty
+ * @param yAxisFilter Columns to plot, separated by |, all if empty
+ */
 void QGCDataPlot2D::loadRawLog(QString file, QString xAxisName, QString yAxisFilter)
 {
-    if (logFile != NULL)
-    {
-        logFile->close();
-        delete logFile;
-    }
+    // Only one conversion at a time
+    cancelRawLog();
+
     // Postprocess log file
-    logFile = new QTemporaryFile();
-    compressor = new LogCompressor(file, logFile->fileName());
+    delete compressedFile;
+    compressedFile = new QTemporaryFile(this);
+    if (!compressedFile->open())
+        return;
+    compressedFile->close();
+    rawXAxisName = xAxisName;
+    rawYAxisFilter = yAxisFilter;
+
+    compressor = new LogCompressor(file, compressedFile->fileName());
+    connect(compressor, SIGNAL(progressChanged(int,int)), this, SLOT(updateCompression(int,int)));
+    connect(compressor, SIGNAL(columnsFound(QStringList)), this, SLOT(setCompressedColumns(QStringList)));
+    connect(compressor, SIGNAL(rowsCompressed(QVector<double>,int)), this, SLOT(appendCompressedRows(QVector<double>,int)));
+    connect(compressor, SIGNAL(finishedFile(QString)), this, SLOT(finishRawLog(QString)));
+    connect(compressor, SIGNAL(finished()), compressor, SLOT(deleteLater()));
+
+    // The dialog does not block the rest of the application
+    progress = new QProgressDialog(tr("Transforming RAW log file to CSV"), tr("Abort Transformation"), 0, 1, this);
+    progress->setWindowModality(Qt::NonModal);
+    connect(progress, SIGNAL(canceled()), this, SLOT(cancelRawLog()));
+    connect(compressor, SIGNAL(finished()), progress, SLOT(deleteLater()));
+
     compressor->startCompression();
+}
 
-    // Block UI
-    QProgressDialog progress("Transforming RAW log file to CSV", "Abort Transformation", 0, 1, this);
-    progress.setWindowModality(Qt::WindowModal);
+void QGCDataPlot2D::updateCompression(int current, int total)
+{
+    if (progress)
+    {
+        progress->setMaximum(total);
+        progress->setValue(current);
+    }
+}
 
-    while (!compressor->isFinished())
+void QGCDataPlot2D::cancelRawLog()
+{
+    if (compressor)
     {
-        MG::SLEEP::usleep(100000);
-        progress.setMaximum(compressor->getDataLines());
-        progress.setValue(compressor->getCurrentLine());
+        // Deletes itself once the thread stopped
+        disconnect(compressor, 0, this, 0);
+        compressor->abort();
+        compressor = NULL;
     }
-    // Enforce end
-    progress.setMaximum(compressor->getDataLines());
-    progress.setValue(compressor->getDataLines());
+    if (progress)
+    {
+        progress->deleteLater();
+        progress = NULL;
+    }
+}
 
+/**
+ * Called once the compressor has read the whole raw log, before the first
+ * rows are converted.
+ *
+ * @param names The columns of the converted file, the timestamp first
+ */
+void QGCDataPlot2D::setCompressedColumns(const QStringList& names)
+{
+    plot->removeData();
+    xColumn = (rawXAxisName == "") ? 0 : names.indexOf(rawXAxisName);
+    yColumns.clear();
+    for (int i = 0; i < names.size(); i++)
+    {
+        if (i != xColumn && (rawYAxisFilter == "" || rawYAxisFilter.contains(names.at(i))))
+        {
+            yColumns.append(i);
+        }
+    }
+    compressedNames = names;
+}
+
+/**
+ * @param rows Converted values row by row
+ * @param columns Number of values per row
+ */
+void QGCDataPlot2D::appendCompressedRows(const QVector<double>& rows, int columns)
+{
+    if (xColumn < 0 || columns <= 0) return;
+    int count = rows.size() / columns;
+    QVector<double> xValues;
+    QVector<double> yValues;
+    xValues.reserve(count);
+    yValues.reserve(count);
+    foreach (int column, yColumns)
+    {
+        xValues.clear();
+        yValues.clear();
+        for (int i = 0; i < count; i++)
+        {
+            double x = rows.at(i * columns + xColumn);
+            double y = rows.at(i * columns + column);
+            if (x == x && y == y)
+            {
+                xValues.append(x);
+                yValues.append(y);
+            }
+        }
+        if (!xValues.isEmpty())
+        {
+            plot->appendData(compressedNames.at(column), xValues.data(), yValues.data(), xValues.size());
+        }
+    }
+}
+
+/**
+ * @param file The converted log, replaces the rows plotted during the conversion
+ */
+void QGCDataPlot2D::finishRawLog(QString file)
+{
+    compressor = NULL;
     // Done with preprocessing - now load csv log
-    loadCsvLog(logFile->fileName(), xAxisName, yAxisFilter);
+    loadCsvLog(file, rawXAxisName, rawYAxisFilter);
+}
+
+/**
+ * The binary copy of a linechart log and the mission log need no
+ * conversion, they are read at once and every channel of every system is
+ * plotted over time.
+ *
+ * @param file The binary log written next to the text log, or a mission log ending in ".mlog"
+ * @param yAxisFilter Curves to plot, separated by |, all if empty
+ */
+void QGCDataPlot2D::loadBinaryLog(QString file, QString yAxisFilter)
+{
+    cancelRawLog();
+    LogReader logReader;
+    MissionLogReader missionReader;
+    LogReader& reader = file.endsWith(".mlog") ? missionReader : logReader;
+    if (!reader.read(file))
+    {
+        ui->filenameLabel->setText(tr("Could not read %1").arg(QFileInfo(file).fileName()));
+        return;
+    }
+
+    if (ui->plotTitle->text() != "") plot->setTitle(ui->plotTitle->text());
+    if (ui->plotXAxisLabel->text() != "") plot->setAxisTitle(QwtPlot::xBottom, ui->plotXAxisLabel->text());
+    if (ui->plotYAxisLabel->text() != "") plot->setAxisTitle(QwtPlot::yLeft, ui->plotYAxisLabel->text());
+    if (reader.isTruncated())
+    {
+        ui->filenameLabel->setText(tr("%1 (incomplete)").arg(QFileInfo(file).fileName()));
+    }
+    else
+    {
+        ui->filenameLabel->setText(QFileInfo(file).fileName());
+    }
+
+    plot->removeData();
+    ui->xAxis->clear();
+    ui->yAxis->clear();
+    ui->xRegressionComboBox->clear();
+    ui->yRegressionComboBox->clear();
+    ui->regressionOutput->clear();
+    ui->xAxis->addItem(tr("Time"));
+
+    QStringList names = reader.getCurveNames();
+    QStringList plotted;
+    for (int i = 0; i < names.size(); i++)
+    {
+        if (yAxisFilter != "" && !yAxisFilter.contains(names.at(i))) continue;
+        QVector<double> times = reader.getTimes(i);
+        QVector<double> values = reader.getValues(i);
+        plot->appendData(names.at(i), times.data(), values.data(), times.size());
+        plotted.append(names.at(i));
+    }
+    ui->yAxis->setText(plotted.join("|"));
+    plot->setStyleText(ui->style->currentText());
 }
 
 /**
- * This function loads a CSV file into the plot. It tries to assign the dimension names
- * based on the first data row and tries to guess the separator char.
+ * This function loads a CSV file into the plot. The dimension names are
+ * taken from the header line, which also determines the separator char.
+ * The file is loaded in the background by the loader, the rows are
+ * appended to the plot by appendRows() as they become available.
  *
- * @param file Name of the file to open
- * @param xAxisName Optional paramater. If given, the x axis dimension will be selected to match this string
- * @param yAxisFilter Optional parameter. If given, only data dimension names present in the filter string will be
- *        plotted
+ * @param file The CSV or TSV file, the first line has to be the header
+ * @param xAxisName Optional parameter. If given, the x axis dimension will be selected to match this string, else the first column
+ * @param yAxisFilter Optional parameter. If given, only data dimension names present in the filter string (separated by |) will be
+ *        plotted, else all
  *
  * @code
  *
@@ -345,8 +524,8 @@ void QGCDataPlot2D::loadCsvLog(QString file, QString xAxisName, QString yAxisFil
     }
     logFile = new QFile(file);
 
-    // Load CSV data
-    if (!logFile->open(QIODevice::ReadOnly | QIODevice::Text))
+    // Read the header, the rows are loaded after the axes are selected
+    if (!loader->open(file))
         return;
 
     // Set plot title
@@ -354,60 +533,16 @@ void QGCDataPlot2D::loadCsvLog(QString file, QString xAxisName, QString yAxisFil
     if (ui->plotXAxisLabel->text() != "") plot->setAxisTitle(QwtPlot::xBottom, ui->plotXAxisLabel->text());
     if (ui->plotYAxisLabel->text() != "") plot->setAxisTitle(QwtPlot::yLeft, ui->plotYAxisLabel->text());
 
-    // Extract header
-
-    // Read in values
-    // Find all keys
-    QTextStream in(logFile);
-
-    // First line is header
-    QString header = in.readLine();
-
-    bool charRead = false;
-    QString separator = "";
-    QList<QChar> sepCandidates;
-    sepCandidates << '\t';
-    sepCandidates << ',';
-    sepCandidates << ';';
-    sepCandidates << ' ';
-    sepCandidates << '~';
-    sepCandidates << '|';
-
-    // Iterate until separator is found
-    // or full header is parsed
-    for (int i = 0; i < header.length(); i++)
-    {
-        if (sepCandidates.contains(header.at(i)))
-        {
-            // Separator found
-            if (charRead)
-            {
-                separator += header[i];
-            }
-        }
-        else
-        {
-            // Char found
-            charRead = true;
-            // If the separator is not empty, this char
-            // has been read after a separator, so detection
-            // is now complete
-            if (separator != "") break;
-        }
-    }
-
-    QString out = separator;
+    QString out = loader->getSeparator();
     out.replace("\t", "<tab>");
     ui->filenameLabel->setText(file.split("/").last().split("\\").last()+" Separator: \""+out+"\"");
-    //qDebug() << "READING CSV:" << header;
 
     // Clear plot
     plot->removeData();
 
-    QVector<double> xValues;
-    QMap<QString, QVector<double>* > yValues;
-
-    curveNames.append(header.split(separator, QString::SkipEmptyParts));
+    curveNames.append(loader->getColumnNames());
+    if (curveNames.isEmpty())
+        return;
     QString curveName;
 
     // Clear UI elements
@@ -419,8 +554,6 @@ void QGCDataPlot2D::loadCsvLog(QString file, QString xAxisName, QString yAxisFil
 
     int curveNameIndex = 0;
 
-    //int xValueIndex = curveNames.indexOf(xAxisName);
-
     QString xAxisFilter;
     if (xAxisName == "")
     {
@@ -431,6 +564,8 @@ void QGCDataPlot2D::loadCsvLog(QString file, QString xAxisName, QString yAxisFil
         xAxisFilter = xAxisName;
     }
 
+    xColumn = curveNames.indexOf(xAxisFilter);
+    yColumns.clear();
     foreach(curveName, curveNames)
     {
         // Add to plot x axis selection
@@ -442,7 +577,7 @@ void QGCDataPlot2D::loadCsvLog(QString file, QString xAxisName, QString yAxisFil
         {
             if ((yAxisFilter == "") || yAxisFilter.contains(curveName))
             {
-                yValues.insert(curveName, new QVector<double>());
+                yColumns.append(curveNames.indexOf(curveName));
                 // Add separator starting with second item
                 if (curveNameIndex > 0 && curveNameIndex < curveNames.count())
                 {
@@ -455,58 +590,55 @@ void QGCDataPlot2D::loadCsvLog(QString file, QString xAxisName, QString yAxisFil
     }
 
     // Select current axis in UI
-    ui->xAxis->setCurrentIndex(curveNames.indexOf(xAxisFilter));
+    ui->xAxis->setCurrentIndex(xColumn);
 
-    // Read data
+    // Load only the plotted columns
+    plottedRows = 0;
+    QList<int> columns = yColumns;
+    columns.prepend(xColumn);
+    loader->load(columns);
+    plot->setStyleText(ui->style->currentText());
+}
 
-    double x,y;
+/**
+ * Called while the loader works through the file. Only rows with a valid
+ * x and y value are plotted.
+ *
+ * @param rows Number of rows available in all loaded columns
+ */
+void QGCDataPlot2D::appendRows(int rows)
+{
+    // Signals of a previous file may still be queued
+    rows = qMin(rows, loader->getRows());
+    if (rows <= plottedRows) return;
+    const double* x = loader->getColumn(xColumn);
+    if (x == NULL) return;
 
-    while (!in.atEnd())
+    QVector<double> xValues;
+    QVector<double> yValues;
+    xValues.reserve(rows - plottedRows);
+    yValues.reserve(rows - plottedRows);
+    foreach (int column, yColumns)
     {
-        QString line = in.readLine();
-
-        QStringList values = line.split(separator, QString::SkipEmptyParts);
-
-        foreach(curveName, curveNames)
+        const double* y = loader->getColumn(column);
+        if (y == NULL) continue;
+        xValues.clear();
+        yValues.clear();
+        for (int i = plottedRows; i < rows; i++)
         {
-            bool okx;
-            if (curveName == xAxisFilter)
+            if (x[i] == x[i] && y[i] == y[i])
             {
-                // X  AXIS HANDLING
-
-                // Take this value as x if it is selected
-                x = values.at(curveNames.indexOf(curveName)).toDouble(&okx);
-                xValues.append(x);// - 1270125570000ULL);
-            }
-            else
-            {
-                // Y  AXIS HANDLING
-
-                if(yAxisFilter == "" || yAxisFilter.contains(curveName))
-                {
-                    // Only append y values where a valid x value is present
-                    if (yValues.value(curveName)->count() == xValues.count() - 1)
-                    {
-                        bool oky;
-                        int curveNameIndex = curveNames.indexOf(curveName);
-                        if (values.count() > curveNameIndex)
-                        {
-                            y = values.at(curveNameIndex).toDouble(&oky);
-                            yValues.value(curveName)->append(y);
-                        }
-                    }
-                }
+                xValues.append(x[i]);
+                yValues.append(y[i]);
             }
         }
+        // Add data array of each curve to the plot at once (fast)
+        if (!xValues.isEmpty())
+        {
+            plot->appendData(curveNames.at(column), xValues.data(), yValues.data(), xValues.size());
+        }
     }
-
-    // Add data array of each curve to the plot at once (fast)
-    // Iterates through all x-y curve combinations
-    for (int i = 0; i < yValues.count(); i++)
-    {
-        plot->appendData(yValues.keys().at(i), xValues.data(), yValues.values().at(i)->data(), xValues.count());
-    }
-    plot->setStyleText(ui->style->currentText());
+    plottedRows = rows;
 }
 
 bool QGCDataPlot2D::calculateRegression()
@@ -529,6 +661,9 @@ bool QGCDataPlot2D::calculateRegression(QString xName, QString yName, QString me
         if (QFileInfo(fileName).isReadable())
         {
             loadCsvLog(fileName, xName, yName);
+            // The regression needs all rows
+            loader->wait();
+            appendRows(loader->getRows());
             ui->xRegressionComboBox->setCurrentIndex(curveNames.indexOf(xName));
             ui->yRegressionComboBox->setCurrentIndex(curveNames.indexOf(yName));
         }
@@ -676,6 +811,11 @@ void QGCDataPlot2D::saveCsvLog()
 
 QGCDataPlot2D::~QGCDataPlot2D()
 {
+    if (compressor)
+    {
+        compressor->abort();
+        compressor->wait();
+    }
     delete ui;
 }
 
@@ -3,8 +3,12 @@
 
 #include <QWidget>
 #include <QFile>
+#include <QPointer>
+#include <QTemporaryFile>
+#include <QProgressDialog>
 #include "IncrementalPlot.h"
 #include "LogCompressor.h"
+#include "QGCCsvLoader.h"
 
 namespace Ui {
     class QGCDataPlot2D;
@@ -32,6 +36,10 @@ public slots:
     void selectFile();
     void loadCsvLog(QString file, QString xAxisName="", QString yAxisFilter="");
     void loadRawLog(QString file, QString xAxisName="", QString yAxisFilter="");
+    /** @brief Plot the binary copy of a linechart log or a mission log */
+    void loadBinaryLog(QString file, QString yAxisFilter="");
+    /** @brief Plot the rows the loader finished since the last call */
+    void appendRows(int rows);
     void saveCsvLog();
     /** @brief Save plot to PDF or SVG */
     void savePlot();
@@ -44,11 +52,32 @@ public slots:
     /** @brief Calculate and display regression function*/
     bool calculateRegression();
 
+protected slots:
+    /** @brief Show the progress of the raw log conversion */
+    void updateCompression(int current, int total);
+    /** @brief Stop the raw log conversion */
+    void cancelRawLog();
+    /** @brief Select the plotted columns of the raw log being converted */
+    void setCompressedColumns(const QStringList& names);
+    /** @brief Plot the rows of the raw log converted so far */
+    void appendCompressedRows(const QVector<double>& rows, int columns);
+    /** @brief Load the converted raw log */
+    void finishRawLog(QString file);
+
 protected:
     void changeEvent(QEvent *e);
     IncrementalPlot* plot;
-    LogCompressor* compressor;
+    QPointer<LogCompressor> compressor;  ///< Converts the raw log, deletes itself when done
+    QPointer<QProgressDialog> progress;  ///< Progress of the raw log conversion
     QFile* logFile;
+    QTemporaryFile* compressedFile;      ///< The converted raw log
+    QString rawXAxisName;                ///< X axis selected for the raw log
+    QString rawYAxisFilter;              ///< Y axis filter selected for the raw log
+    QStringList compressedNames;         ///< Columns of the raw log being converted
+    QGCCsvLoader* loader;        ///< Loads the CSV files in the background
+    int plottedRows;             ///< Rows of the loader already added to the plot
+    int xColumn;                 ///< Column of the x axis
+    QList<int> yColumns;         ///< Columns plotted over the x axis
     QString fileName;
     QStringList curveNames;
 
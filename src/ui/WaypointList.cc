@@ -162,7 +162,7 @@ void WaypointList::add()
 {
     if (uas)
     {
-        const QVector<Waypoint *> &waypoints = uas->getWaypointManager().getWaypointList();
+        QVector<Waypoint *> waypoints = uas->getWaypointManager().getWaypointList();
         if (waypoints.size() > 0)
         {
             Waypoint *last = waypoints.at(waypoints.size()-1);
@@ -181,7 +181,7 @@ void WaypointList::addCurrentPositonWaypoint()
 {
     if (uas)
     {
-        const QVector<Waypoint *> &waypoints = uas->getWaypointManager().getWaypointList();
+        QVector<Waypoint *> waypoints = uas->getWaypointManager().getWaypointList();
         if (waypoints.size() > 0)
         {
             Waypoint *last = waypoints.at(waypoints.size()-1);
@@ -213,13 +213,15 @@ void WaypointList::currentWaypointChanged(quint16 seq)
 {
     if (uas)
     {
-        const QVector<Waypoint *> &waypoints = uas->getWaypointManager().getWaypointList();
+        QVector<Waypoint *> waypoints = uas->getWaypointManager().getWaypointList();
 
         if (seq < waypoints.size())
         {
             for(int i = 0; i < waypoints.size(); i++)
             {
-                WaypointView* widget = wpViews.find(waypoints[i]).value();
+                // The view of a new waypoint is created with the next list change
+                WaypointView* widget = wpViews.value(waypoints[i], NULL);
+                if (widget == NULL) continue;
 
                 if (waypoints[i]->getId() == seq)
                 {
@@ -238,7 +240,7 @@ void WaypointList::waypointListChanged()
 {
     if (uas)
     {
-        const QVector<Waypoint *> &waypoints = uas->getWaypointManager().getWaypointList();
+        QVector<Waypoint *> waypoints = uas->getWaypointManager().getWaypointList();
 
         // first remove all views of non existing waypoints
         if (!wpViews.empty())
@@ -293,7 +295,7 @@ void WaypointList::moveUp(Waypoint* wp)
 {
     if (uas)
     {
-        const QVector<Waypoint *> &waypoints = uas->getWaypointManager().getWaypointList();
+        QVector<Waypoint *> waypoints = uas->getWaypointManager().getWaypointList();
 
         //get the current position of wp in the local storage
         int i;
@@ -315,7 +317,7 @@ void WaypointList::moveDown(Waypoint* wp)
 {
     if (uas)
     {
-        const QVector<Waypoint *> &waypoints = uas->getWaypointManager().getWaypointList();
+        QVector<Waypoint *> waypoints = uas->getWaypointManager().getWaypointList();
 
         //get the current position of wp in the local storage
         int i;
@@ -230,9 +230,45 @@ void LinechartPlot::appendData(QString dataname, quint64 ms, double value)
         addCurve(dataname);
     }
 
-    // Add new value
-    TimeSeriesData* dataset = data.value(dataname);
+    appendData(data.value(dataname), curves.value(dataname), ms, value);
 
+    datalock.unlock();
+}
+
+void LinechartPlot::appendData(int channel, const QString& dataname, quint64 ms, double value)
+{
+    /* Lock resource to ensure data integrity */
+    datalock.lock();
+
+    if (channel >= channelData.size())
+    {
+        int size = channelData.size();
+        channelData.resize(channel + 1);
+        channelCurves.resize(channel + 1);
+        for (int i = size; i <= channel; i++)
+        {
+            channelData[i] = NULL;
+            channelCurves[i] = NULL;
+        }
+    }
+
+    // Look the curve up by its name only once
+    if (channelData[channel] == NULL)
+    {
+        if(!data.contains(dataname)) {
+            addCurve(dataname);
+        }
+        channelData[channel] = data.value(dataname);
+        channelCurves[channel] = curves.value(dataname);
+    }
+
+    appendData(channelData[channel], channelCurves[channel], ms, value);
+
+    datalock.unlock();
+}
+
+void LinechartPlot::appendData(TimeSeriesData* dataset, QwtPlotCurve* curve, quint64 ms, double value)
+{
     // Append data
     if (m_groundTime)
     {
@@ -256,12 +292,9 @@ void LinechartPlot::appendData(QString dataname, quint64 ms, double value)
     valueInterval = maxValue - minValue;
 
     // Assign dataset to curve
-    QwtPlotCurve* curve = curves.value(dataname);
     curve->setRawData(dataset->getPlotX(), dataset->getPlotY(), dataset->getPlotCount());
 
     //    qDebug() << "mintime" << minTime << "maxtime" << maxTime << "last max time" << "window position" << getWindowPosition();
-
-    datalock.unlock();
 }
 
 /**
@@ -667,6 +700,9 @@ void LinechartPlot::paintRealtime()
 void LinechartPlot::removeAllData()
 {
     datalock.lock();
+    // Forget the curves of the channels
+    channelData.clear();
+    channelCurves.clear();
     // Delete curves
     QMap<QString, QwtPlotCurve*>::iterator i;
     for(i = curves.begin(); i != curves.end(); ++i) {
@@ -37,6 +37,7 @@ This file is part of the PIXHAWK project
 
 #include <QMap>
 #include <QList>
+#include <QVector>
 #include <QMutex>
 #include <QTime>
 #include <qwt_plot_panner.h>
@@ -231,6 +232,18 @@ public slots:
      * @param value value of the data point
      */
     void appendData(QString dataname, quint64 ms, double value);
+    /**
+     * @brief Append data to the curve of a telemetry channel
+     *
+     * Same as appendData(QString, quint64, double), but the curve is looked
+     * up by name only for the first data point of the channel.
+     *
+     * @param channel channel id of the data, see UASChannelRegistry
+     * @param dataname unique string (also used to label the data)
+     * @param ms time measure of the data point, in milliseconds
+     * @param value value of the data point
+     */
+    void appendData(int channel, const QString& dataname, quint64 ms, double value);
     void hideCurve(QString id);
     void showCurve(QString id);
     /** @brief Enable auto-refreshing of plot */
@@ -265,6 +278,8 @@ protected:
     QMap<QString, QwtPlotCurve*> curves;
     QMap<QString, TimeSeriesData*> data;
     QMap<QString, QwtScaleMap*> scaleMaps;
+    QVector<TimeSeriesData*> channelData;  ///< Data of the curves indexed by channel id, NULL if not yet looked up
+    QVector<QwtPlotCurve*> channelCurves;  ///< Curves indexed by channel id
     ScrollZoomer* zoomer;
 
     QList<QColor> colors;
@@ -301,6 +316,8 @@ protected:
     // Methods
     void addCurve(QString id);
     QColor getNextColor();
+    /** @brief Append a data point to a dataset and its curve, the data lock has to be held */
+    void appendData(TimeSeriesData* dataset, QwtPlotCurve* curve, quint64 ms, double value);
 
 private:
     TimeSeriesData* d_data;
@@ -48,6 +48,7 @@ This file is part of the PIXHAWK project
 #include "LinechartWidget.h"
 #include "LinechartPlot.h"
 #include "LogCompressor.h"
+#include "UASChannelRegistry.h"
 #include "MG.h"
 
 
@@ -63,7 +64,7 @@ curveLabels(new QMap<QString, QLabel*>()),
 curveMeans(new QMap<QString, QLabel*>()),
 curveMedians(new QMap<QString, QLabel*>()),
 curveMenu(new QMenu(this)),
-logFile(new QFile()),
+logWriter(NULL),
 logindex(1),
 logging(false),
 updateTimer(new QTimer())
@@ -121,7 +122,7 @@ void LinechartWidget::createLayout()
     //    activePlot = getPlot(0);
     //    plotContainer->setPlot(activePlot);
 
-    layout->addWidget(activePlot, 0, 0, 1, 6);
+    layout->addWidget(activePlot, 0, 0, 1, 7);
     layout->setRowStretch(0, 10);
     layout->setRowStretch(1, 0);
 
@@ -155,13 +156,22 @@ void LinechartWidget::createLayout()
     layout->setColumnStretch(3, 0);
     connect(logButton, SIGNAL(clicked()), this, SLOT(startLogging()));
 
+    // Binary log copy button
+    binaryLogButton = new QToolButton(this);
+    binaryLogButton->setText(tr("Binary Copy"));
+    binaryLogButton->setToolTip(tr("Also write the log at full precision to a binary .bin file"));
+    binaryLogButton->setCheckable(true);
+    binaryLogButton->setChecked(false);
+    layout->addWidget(binaryLogButton, 1, 4);
+    layout->setColumnStretch(4, 0);
+
     // Ground time button
     QToolButton* timeButton = new QToolButton(this);
     timeButton->setText(tr("Ground Time"));
     timeButton->setCheckable(true);
     timeButton->setChecked(false);
-    layout->addWidget(timeButton, 1, 4);
-    layout->setColumnStretch(4, 0);
+    layout->addWidget(timeButton, 1, 5);
+    layout->setColumnStretch(5, 0);
     connect(timeButton, SIGNAL(clicked(bool)), activePlot, SLOT(enforceGroundTime(bool)));
 
     // Create the scroll bar
@@ -176,8 +186,8 @@ void LinechartWidget::createLayout()
 
 
     // Add scroll bar to layout and make sure it gets all available space
-    layout->addWidget(scrollbar, 1, 5);
-    layout->setColumnStretch(5, 10);
+    layout->addWidget(scrollbar, 1, 6);
+    layout->setColumnStretch(6, 10);
 
     ui.diagramGroupBox->setLayout(layout);
 
@@ -223,12 +233,61 @@ void LinechartWidget::appendData(int uasId, QString curve, double value, quint64
     {
         if (activePlot->isVisible(curve))
         {
-            logFile->write(QString(QString::number(usec) + "\t" + QString::number(uasId) + "\t" + curve + "\t" + QString::number(value) + "\n").toLatin1());
-            logFile->flush();
+            logWriter->append(usec, uasId, UASChannelRegistry::instance()->getChannel(uasId, curve), value);
         }
     }
 }
 
+/**
+ * The name of a channel is resolved and its curve created with the first
+ * value, the further values go straight to the curve of the channel.
+ *
+ * @param channel The channel of the value
+ * @param value The new value
+ * @param usec The timestamp of the value
+ */
+void LinechartWidget::appendChannelData(int channel, double value, quint64 usec)
+{
+    if (channel < 0) return;
+    if (channel >= channelNames.size())
+    {
+        channelNames.resize(channel + 1);
+    }
+    bool first = channelNames[channel].isNull();
+    if (first)
+    {
+        channelNames[channel] = UASChannelRegistry::instance()->getName(channel);
+    }
+    const QString& curve = channelNames[channel];
+
+    // Order matters here, first append to plot, then update curve list
+    activePlot->appendData(channel, curve, usec, value);
+    if (first && !curveLabels->contains(curve))
+    {
+        addCurve(curve);
+    }
+
+    // Log data
+    if (logging)
+    {
+        if (activePlot->isVisible(curve))
+        {
+            logWriter->append(usec, sysid, channel, value);
+        }
+    }
+}
+
+/**
+ * @param frame The channels and values of one message
+ */
+void LinechartWidget::appendFrame(const UASValueFrame& frame)
+{
+    for (int i = 0; i < frame.count; i++)
+    {
+        appendChannelData(frame.channels[i], frame.values[i], frame.msec);
+    }
+}
+
 void LinechartWidget::refresh()
 {
     QString str;
@@ -286,30 +345,42 @@ void LinechartWidget::startLogging()
     // Check if the user did not abort the file save dialog
     if (!abort && fileName != "")
     {
-        logFile = new QFile(fileName);
-        if (logFile->open(QIODevice::WriteOnly | QIODevice::Text))
+        logWriter = new LogWriter(fileName);
+        logWriter->setBinarySidecar(binaryLogButton->isChecked());
+        if (logWriter->open())
         {
+            logWriter->start(QThread::LowPriority);
+            binaryLogButton->setEnabled(false);
             logging = true;
             logindex++;
             logButton->setText(tr("Stop logging"));
             disconnect(logButton, SIGNAL(clicked()), this, SLOT(startLogging()));
             connect(logButton, SIGNAL(clicked()), this, SLOT(stopLogging()));
         }
+        else
+        {
+            delete logWriter;
+            logWriter = NULL;
+        }
     }
 }
 
 void LinechartWidget::stopLogging()
 {
     logging = false;
-    if (logFile->isOpen())
+    if (logWriter)
     {
-        logFile->flush();
-        logFile->close();
+        // Write the queued samples before the log is compressed
+        logWriter->stop();
+        QString fileName = logWriter->getFileName();
+        delete logWriter;
+        logWriter = NULL;
         // Postprocess log file
-        compressor = new LogCompressor(logFile->fileName());
+        compressor = new LogCompressor(fileName);
         connect(compressor, SIGNAL(finishedFile(QString)), this, SIGNAL(logfileWritten(QString)));
         compressor->startCompression();
     }
+    binaryLogButton->setEnabled(true);
     logButton->setText(tr("Start logging"));
     disconnect(logButton, SIGNAL(clicked()), this, SLOT(stopLogging()));
     connect(logButton, SIGNAL(clicked()), this, SLOT(startLogging()));
@@ -40,6 +40,7 @@ This file is part of the PIXHAWK project
 #include <QScrollBar>
 #include <QSpinBox>
 #include <QMap>
+#include <QVector>
 #include <QString>
 #include <QAction>
 #include <QIcon>
@@ -54,6 +55,7 @@ This file is part of the PIXHAWK project
 #include "ui_Linechart.h"
 
 #include "LogCompressor.h"
+#include "LogWriter.h"
 
 /**
  * @brief The linechart widget allows to visualize different timeseries as lineplot.
@@ -73,6 +75,10 @@ public slots:
     void addCurve(QString curve);
     void removeCurve(QString curve);
     void appendData(int sysId, QString curve, double data, quint64 usec);
+    /** @brief Append a value of a telemetry channel, see UASChannelRegistry */
+    void appendChannelData(int channel, double data, quint64 usec);
+    /** @brief Append all values decoded from one message */
+    void appendFrame(const UASValueFrame& frame);
     void takeButtonClick(bool checked);
     void setPlotWindowPosition(int scrollBarValue);
     void setPlotWindowPosition(quint64 position);
@@ -106,6 +112,7 @@ protected:
     QMap<QString, QLabel*>* curveLabels;  ///< References to the curve labels
     QMap<QString, QLabel*>* curveMeans;   ///< References to the curve means
     QMap<QString, QLabel*>* curveMedians; ///< References to the curve medians
+    QVector<QString> channelNames;        ///< Names of the channels indexed by channel id, null until the first value
 
     QWidget* curvesWidget;                ///< The QWidget containing the curve selection button
     QVBoxLayout* curvesWidgetLayout;      ///< The layout for the curvesWidget QWidget
@@ -122,8 +129,9 @@ protected:
     QToolButton* scalingLinearButton;
     QToolButton* scalingLogButton;
     QToolButton* logButton;
+    QToolButton* binaryLogButton;         ///< Toggles the binary copy of the next log
 
-    QFile* logFile;
+    LogWriter* logWriter;                 ///< Writes the log in the background, NULL if not logging
     unsigned int logindex;
     bool logging;
     QTimer* updateTimer;
@@ -54,7 +54,7 @@ void Linecharts::addSystem(UASInterface* uas)
         LinechartWidget* widget = new LinechartWidget(uas->getUASID(), this);
         addWidget(widget);
         plots.insert(uas->getUASID(), widget);
-        connect(uas, SIGNAL(valueChanged(int,QString,double,quint64)), widget, SLOT(appendData(int,QString,double,quint64)));
+        connect(uas, SIGNAL(valuesChanged(UASValueFrame)), widget, SLOT(appendFrame(UASValueFrame)));
         connect(widget, SIGNAL(logfileWritten(QString)), this, SIGNAL(logfileWritten(QString)));
         // Set system active if this is the only system
         if (active)
@@ -77,6 +77,8 @@ engineOn(false)
     ui.modeComboBox->insertItem(CONTROL_MODE_TEST3_INDEX, CONTROL_MODE_TEST3);
     connect(ui.modeComboBox, SIGNAL(activated(int)), this, SLOT(setMode(int)));
     connect(ui.setModeButton, SIGNAL(clicked()), this, SLOT(transmitMode()));
+    // The shutdown is confirmed in the GUI thread before it is queued to the UAS
+    connect(ui.shutdownButton, SIGNAL(clicked()), this, SLOT(shutdownUAS()));
 
     ui.modeComboBox->setCurrentIndex(0);
 }
@@ -89,7 +91,6 @@ void UASControlWidget::setUAS(UASInterface* uas)
         disconnect(ui.controlButton, SIGNAL(clicked()), oldUAS, SLOT(enable_motors()));
         disconnect(ui.liftoffButton, SIGNAL(clicked()), oldUAS, SLOT(launch()));
         disconnect(ui.landButton, SIGNAL(clicked()), oldUAS, SLOT(home()));
-        disconnect(ui.shutdownButton, SIGNAL(clicked()), oldUAS, SLOT(shutdown()));
         disconnect(uas, SIGNAL(modeChanged(int,QString,QString)), this, SLOT(updateMode(int,QString,QString)));
         disconnect(uas, SIGNAL(statusChanged(int)), this, SLOT(updateState(int)));
     }
@@ -98,7 +99,6 @@ void UASControlWidget::setUAS(UASInterface* uas)
     connect(ui.controlButton, SIGNAL(clicked()), this, SLOT(cycleContextButton()));
     connect(ui.liftoffButton, SIGNAL(clicked()), uas, SLOT(launch()));
     connect(ui.landButton, SIGNAL(clicked()), uas, SLOT(home()));
-    connect(ui.shutdownButton, SIGNAL(clicked()), uas, SLOT(shutdown()));
     connect(uas, SIGNAL(modeChanged(int,QString,QString)), this, SLOT(updateMode(int,QString,QString)));
     connect(uas, SIGNAL(statusChanged(int)), this, SLOT(updateState(int)));
 
@@ -214,6 +214,14 @@ void UASControlWidget::transmitMode()
     }
 }
 
+void UASControlWidget::shutdownUAS()
+{
+    if (uas != 0)
+    {
+        UASManager::instance()->shutdownUAS(UASManager::instance()->getUASForId(uas));
+    }
+}
+
 void UASControlWidget::cycleContextButton()
 {
     UAS* mav = dynamic_cast<UAS*>(UASManager::instance()->getUASForId(this->uas));
@@ -63,6 +63,8 @@ public slots:
     void updateMode(int uas,QString mode,QString description);
     /** @brief Update state */
     void updateState(int state);
+    /** @brief Shut down the current UAS once the operator confirmed it */
+    void shutdownUAS();
 
 protected slots:
     /** @brief Set the background color for the widget */
@@ -88,8 +88,8 @@ void UASInfoWidget::addUAS(UASInterface* uas)
 {
     if (uas != NULL)
     {
-        connect(uas, SIGNAL(batteryChanged(UASInterface*,double,double,int)), this, SLOT(updateBattery(UASInterface*,double,double,int)));
-        connect(uas, SIGNAL(dropRateChanged(int,float)), this, SLOT(updateReceiveLoss(int,float)));
+        // Battery and drop rate arrive with the rate limited state
+        connect(uas, SIGNAL(stateChanged(UASStateSnapshot)), this, SLOT(updateSnapshot(UASStateSnapshot)));
         connect(uas, SIGNAL(loadChanged(UASInterface*, double)), this, SLOT(updateCPULoad(UASInterface*,double)));
         connect(uas, SIGNAL(errCountChanged(int,QString,QString,int)), this, SLOT(updateErrorCount(int,QString,QString,int)));
 
@@ -103,6 +103,25 @@ void UASInfoWidget::setActiveUAS(UASInterface* uas)
     activeUAS = uas;
 }
 
+/**
+ * Only the state of the active UAS is shown, the widget refreshes its
+ * labels with its own timer.
+ *
+ * @param snapshot The latest state of one UAS
+ */
+void UASInfoWidget::updateSnapshot(const UASStateSnapshot& snapshot)
+{
+    if (activeUAS == NULL || activeUAS->getUASID() != snapshot.uasId) return;
+    if (snapshot.has(UASStateSnapshot::BATTERY))
+    {
+        updateBattery(activeUAS, snapshot.voltage, snapshot.charge, snapshot.secondsRemaining);
+    }
+    if (snapshot.has(UASStateSnapshot::STATUS))
+    {
+        updateReceiveLoss(snapshot.uasId, snapshot.dropRate);
+    }
+}
+
 void UASInfoWidget::updateBattery(UASInterface* uas, double voltage, double percent, int seconds)
 {
     setVoltage(uas, voltage);
@@ -54,6 +54,8 @@ public slots:
 
     void setActiveUAS(UASInterface* uas);
 
+    /** @brief Take battery and drop rate from the rate limited state */
+    void updateSnapshot(const UASStateSnapshot& snapshot);
     void updateBattery(UASInterface* uas, double voltage, double percent, int seconds);
     void updateCPULoad(UASInterface* uas, double load);
     /** @brief Set the loss rate of packets received by the MAV */
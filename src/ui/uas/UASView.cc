@@ -65,12 +65,9 @@ UASView::UASView(UASInterface* uas, QWidget *parent) :
 
     // Setup communication
     //connect(uas, SIGNAL(valueChanged(int,QString,double,quint64)), this, SLOT(receiveValue(int,QString,double,quint64)));
-    connect(uas, SIGNAL(batteryChanged(UASInterface*, double, double, int)), this, SLOT(updateBattery(UASInterface*, double, double, int)));
+    connect(uas, SIGNAL(stateChanged(UASStateSnapshot)), this, SLOT(updateSnapshot(UASStateSnapshot)));
     connect(uas, SIGNAL(heartbeat(UASInterface*)), this, SLOT(receiveHeartbeat(UASInterface*)));
     connect(uas, SIGNAL(thrustChanged(UASInterface*, double)), this, SLOT(updateThrust(UASInterface*, double)));
-    connect(uas, SIGNAL(localPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateLocalPosition(UASInterface*,double,double,double,quint64)));
-    connect(uas, SIGNAL(globalPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateGlobalPosition(UASInterface*,double,double,double,quint64)));
-    connect(uas, SIGNAL(speedChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateSpeed(UASInterface*,double,double,double,quint64)));
     connect(uas, SIGNAL(statusChanged(UASInterface*,QString,QString)), this, SLOT(updateState(UASInterface*,QString,QString)));
     connect(uas, SIGNAL(modeChanged(int,QString,QString)), this, SLOT(updateMode(int,QString,QString)));
     connect(uas, SIGNAL(loadChanged(UASInterface*, double)), this, SLOT(updateLoad(UASInterface*, double)));
@@ -89,8 +86,9 @@ UASView::UASView(UASInterface* uas, QWidget *parent) :
     connect(m_ui->continueButton, SIGNAL(clicked()), uas, SLOT(go()));
     connect(m_ui->landButton, SIGNAL(clicked()), uas, SLOT(home()));
     connect(m_ui->abortButton, SIGNAL(clicked()), uas, SLOT(emergencySTOP()));
-    connect(m_ui->killButton, SIGNAL(clicked()), uas, SLOT(emergencyKILL()));
-    connect(m_ui->shutdownButton, SIGNAL(clicked()), uas, SLOT(shutdown()));
+    // Critical commands are confirmed in the GUI thread before they are queued to the UAS
+    connect(m_ui->killButton, SIGNAL(clicked()), this, SLOT(killUAS()));
+    connect(m_ui->shutdownButton, SIGNAL(clicked()), this, SLOT(shutdownUAS()));
 
     // Set static values
 
@@ -149,6 +147,16 @@ void UASView::setUASasActive(bool active)
     }
 }
 
+void UASView::killUAS()
+{
+    UASManager::instance()->killUAS(uas);
+}
+
+void UASView::shutdownUAS()
+{
+    UASManager::instance()->shutdownUAS(uas);
+}
+
 void UASView::updateActiveUAS(UASInterface* uas, bool active)
 {
     if (uas == this->uas)
@@ -238,6 +246,32 @@ void UASView::setSystemType(UASInterface* uas, unsigned int systemType)
     }
 }
 
+/**
+ * One view exists per vehicle, the views of a swarm are updated with the
+ * rate limited state instead of every single position message.
+ *
+ * @param snapshot The latest state of the UAS of this view
+ */
+void UASView::updateSnapshot(const UASStateSnapshot& snapshot)
+{
+    if (snapshot.has(UASStateSnapshot::BATTERY))
+    {
+        updateBattery(uas, snapshot.voltage, snapshot.charge, snapshot.secondsRemaining);
+    }
+    if (snapshot.has(UASStateSnapshot::LOCAL_POSITION))
+    {
+        updateLocalPosition(uas, snapshot.x, snapshot.y, snapshot.z, snapshot.localTime);
+    }
+    if (snapshot.has(UASStateSnapshot::GLOBAL_POSITION))
+    {
+        updateGlobalPosition(uas, snapshot.lon, snapshot.lat, snapshot.alt, snapshot.globalTime);
+    }
+    if (snapshot.has(UASStateSnapshot::SPEED))
+    {
+        updateSpeed(uas, snapshot.vx, snapshot.vy, snapshot.vz, snapshot.speedTime);
+    }
+}
+
 void UASView::updateLocalPosition(UASInterface* uas, double x, double y, double z, quint64 usec)
 {
     Q_UNUSED(usec);
@@ -52,6 +52,8 @@ public:
 public slots:
     void receiveHeartbeat(UASInterface* uas);
     void updateThrust(UASInterface* uas, double thrust);
+    /** @brief Update battery, position and speed from the state of the UAS */
+    void updateSnapshot(const UASStateSnapshot& snapshot);
     void updateBattery(UASInterface* uas, double voltage, double percent, int seconds);
     void updateLocalPosition(UASInterface*, double x, double y, double z, quint64 usec);
     void updateGlobalPosition(UASInterface*, double lon, double lat, double alt, quint64 usec);
@@ -72,6 +74,10 @@ public slots:
     void setSystemType(UASInterface* uas, unsigned int systemType);
     /** @brief Set the current UAS as the globally active system */
     void setUASasActive(bool);
+    /** @brief Kill the UAS once the operator confirmed it */
+    void killUAS();
+    /** @brief Shut down the UAS once the operator confirmed it */
+    void shutdownUAS();
     /** @brief Update the view if an UAS has been set to active */
     void updateActiveUAS(UASInterface* uas, bool active);
     /** @brief Set the background color for the widget */
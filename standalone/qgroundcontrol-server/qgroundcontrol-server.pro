@@ -1,4 +1,4 @@
-QT       += net
+QT       += network
 
 TEMPLATE = app
 TARGET = qgroundcontrol-server
@@ -7,22 +7,32 @@ BASEDIR = ../..
 BUILDDIR = $$BASEDIR/build/qgroundcontrol-server
 LANGUAGE = C++
 
-CONFIG += release
-CONFIG -= debug
+CONFIG += release console
+CONFIG -= debug app_bundle
 
 OBJECTS_DIR = $$BUILDDIR/qgroundcontrol-server/obj
 MOC_DIR = $$BUILDDIR/qgroundcontrol-server/moc
 
 macx:DESTDIR = $$BASEDIR/bin/mac
 
+# Links, protocol and vehicle model come from the non-GUI core library,
+# build $$BASEDIR/qgroundcontrol-core.pro first
+DEFINES += QGC_NO_GUI
+unix:DEFINES += _TTY_POSIX_
+win32:DEFINES += _TTY_WIN_
+
 INCLUDEPATH += $$BASEDIR/. \
     $$BASEDIR/src \
     $$BASEDIR/src/comm \
+    $$BASEDIR/src/uas \
+    $$BASEDIR/src/lib/qextserialport \
+    $$BASEDIR/../mavlink/include \
     $$BASEDIR/standalone/qgroundcontrol-server/src
 
-HEADERS += src/QGroundControlServer.h \
-   $$BASEDIR/src/comm/MAVLinkProtocol.h
+LIBS += -L$$BASEDIR/lib -lqgroundcontrol-core
+win32:LIBS += -lsetupapi
+PRE_TARGETDEPS += $$BASEDIR/lib/libqgroundcontrol-core.a
+
+HEADERS += src/QGroundControlServer.h
 SOURCES += src/main.cc \
-	src/QGroundControlServer.cc \
-	$$BASEDIR/src/comm/MAVLinkProtocol.cc
-RESOURCES = $$BASEDIR/mavground.qrc
+	src/QGroundControlServer.cc
@@ -23,71 +23,261 @@ This file is part of the PIXHAWK project
 
 /**
  * @file
- *   @brief Implementation of class MAVLinkGen
+ *   @brief Implementation of class QGroundControlServer
  *
  *   @author Lorenz Meier <mavteam@student.ethz.ch>
  *
  */
 
+#include <cstdio>
+#include <QStringList>
+#include <QHostAddress>
+#include <QDebug>
 
-#include <QFile>
-#include <QFlags>
-#include <QThread>
-#include <QSplashScreen>
-#include <QPixmap>
-#include <QDesktopWidget>
-#include <QPainter>
-#include <QStyleFactory>
-#include <QAction>
-#include <QSettings>
-#include <QFontDatabase>
-#include <QMainWindow>
-
-#include "MAVLinkGen.h"
-#include "XMLCommProtocolWidget.h"
-
+#include "QGroundControlServer.h"
+#include "MAVLinkProtocol.h"
+#include "LinkManager.h"
+#include "UDPLink.h"
+#include "SerialLink.h"
+#include "LogReplayLink.h"
+#include "UASManager.h"
+#include "UASInterface.h"
 
 /**
- * @brief Constructor for the main application.
+ * @brief Constructor for the server application.
  *
- * This constructor initializes and starts the whole application. It takes standard
- * command-line parameters
+ * Creates the protocol and all links given on the command line. Check
+ * isValid() before entering the event loop.
  *
  * @param argc The number of command-line parameters
  * @param argv The string array of parameters
  **/
-
-MAVLinkGen::MAVLinkGen(int &argc, char* argv[]) : QApplication(argc, argv)
+QGroundControlServer::QGroundControlServer(int &argc, char* argv[]) : QCoreApplication(argc, argv),
+    mavlink(NULL),
+    server(this),
+    listenPort(DEFAULT_LISTEN_PORT),
+    valid(false)
 {
-    this->setApplicationName("MAVLink Generator");
+    this->setApplicationName("QGroundControl Server");
     this->setApplicationVersion("v. 0.1.0 (Beta)");
     this->setOrganizationName(QLatin1String("OpenMAV Association"));
     this->setOrganizationDomain("http://qgroundcontrol.org");
-	
-    QSettings::setDefaultFormat(QSettings::IniFormat);
-    // Exit main application when last window is closed
-    connect(this, SIGNAL(lastWindowClosed()), this, SLOT(quit()));
-	
-    // Set application font
-    QFontDatabase fontDatabase = QFontDatabase();
-    const QString fontFileName = ":/general/vera.ttf"; ///< Font file is part of the QRC file and compiled into the app
-    const QString fontFamilyName = "Bitstream Vera Sans";
-    if(!QFile::exists(fontFileName)) printf("ERROR! font file: %s DOES NOT EXIST!\n", fontFileName.toStdString().c_str());
-    fontDatabase.addApplicationFont(fontFileName);
-    setFont(fontDatabase.font(fontFamilyName, "Roman", 12));
-
-    // Create main window
-    QMainWindow* window = new QMainWindow();
-    window->setCentralWidget(new XMLCommProtocolWidget(window));
-    window->setWindowTitle(applicationName() + " " + applicationVersion());
-    window->show();
+
+    mavlink = new MAVLinkProtocol();
+    connect(UASManager::instance(), SIGNAL(UASCreated(UASInterface*)), this, SLOT(addUAS(UASInterface*)));
+
+    if (!parseArguments())
+    {
+        printUsage();
+        return;
+    }
+
+    connect(&server, SIGNAL(newConnection()), this, SLOT(acceptClient()));
+    if (!server.listen(QHostAddress::Any, listenPort))
+    {
+        qDebug() << "Could not listen on TCP port" << listenPort << server.errorString();
+        return;
+    }
+    qDebug() << "Serving telemetry on TCP port" << listenPort;
+    valid = true;
 }
 
 /**
- * @brief Destructor for the groundstation. It destroys all loaded instances.
+ * @brief Destructor for the server. Disconnects all links and clients.
  *
  **/
-MAVLinkGen::~MAVLinkGen()
+QGroundControlServer::~QGroundControlServer()
+{
+    server.close();
+    foreach (QTcpSocket* client, clients)
+    {
+        client->disconnect(this);
+        client->abort();
+    }
+    qDeleteAll(clients);
+    clients.clear();
+
+    foreach (LinkInterface* link, LinkManager::instance()->getLinks())
+    {
+        link->disconnect();
+    }
+    mavlink->enableLogging(false);
+}
+
+bool QGroundControlServer::parseArguments()
+{
+    QStringList args = arguments();
+    bool haveLink = false;
+    bool log = false;
+    QStringList forwards;
+
+    for (int i = 1; i < args.size(); ++i)
+    {
+        const QString& arg = args.at(i);
+        bool hasValue = (i + 1 < args.size());
+
+        if (arg == "--log")
+        {
+            log = true;
+        }
+        else if (arg == "--udp" && hasValue)
+        {
+            bool ok;
+            quint16 port = args.at(++i).toUShort(&ok);
+            if (!ok) return false;
+            if (!addLink(new UDPLink(QHostAddress::Any, port))) return false;
+            haveLink = true;
+        }
+        else if (arg == "--serial" && hasValue)
+        {
+            QString spec = args.at(++i);
+            int split = spec.lastIndexOf(':');
+            SerialLink* link = new SerialLink();
+            bool ok = true;
+            if (split < 0)
+            {
+                link->setPortName(spec);
+            }
+            else
+            {
+                link->setPortName(spec.left(split));
+                ok = link->setBaudRate(spec.mid(split + 1).toInt());
+            }
+            if (!ok || !addLink(link)) return false;
+            haveLink = true;
+        }
+        else if (arg == "--replay" && hasValue)
+        {
+            LogReplayLink* link = new LogReplayLink(args.at(++i));
+            link->setSpeed(0);
+            if (!addLink(link)) return false;
+            haveLink = true;
+        }
+        else if (arg == "--forward" && hasValue)
+        {
+            // Applied once all links are known
+            forwards.append(args.at(++i));
+        }
+        else if (arg == "--listen" && hasValue)
+        {
+            bool ok;
+            listenPort = args.at(++i).toUShort(&ok);
+            if (!ok) return false;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    foreach (const QString& spec, forwards)
+    {
+        if (!addForwarding(spec)) return false;
+    }
+
+    if (log) mavlink->enableLogging(true);
+    return haveLink;
+}
+
+/**
+ * The links are numbered from 1 in the order they were given on the
+ * command line. An optional system id limits the route to one vehicle.
+ *
+ * @param spec Route as "<from>:<to>" or "<from>:<to>:<system id>"
+ * @return False if the route is malformed or names an unknown link
+ */
+bool QGroundControlServer::addForwarding(const QString& spec)
+{
+    QStringList parts = spec.split(':');
+    if (parts.size() < 2 || parts.size() > 3) return false;
+
+    bool ok;
+    int from = parts.at(0).toInt(&ok);
+    if (!ok || from < 1 || from > links.size()) return false;
+    int to = parts.at(1).toInt(&ok);
+    if (!ok || to < 1 || to > links.size()) return false;
+
+    MAVLinkForwarder::Filter filter;
+    if (parts.size() == 3)
+    {
+        filter.sysid = parts.at(2).toInt(&ok);
+        if (!ok || filter.sysid < 0 || filter.sysid > 255) return false;
+    }
+
+    if (mavlink->addForwardingRoute(links.at(from - 1), links.at(to - 1), filter) < 0) return false;
+    qDebug() << "Forwarding" << links.at(from - 1)->getName() << "to" << links.at(to - 1)->getName();
+    return true;
+}
+
+bool QGroundControlServer::addLink(LinkInterface* link)
+{
+    // The link registered itself with the LinkManager in its constructor
+    LinkManager::instance()->addProtocol(link, mavlink);
+    if (!link->connect())
+    {
+        qDebug() << "Could not connect" << link->getName();
+        return false;
+    }
+    qDebug() << "Connected" << link->getName();
+    links.append(link);
+    return true;
+}
+
+void QGroundControlServer::printUsage() const
+{
+    fprintf(stderr, "Usage: qgroundcontrol-server [--udp <port>] [--serial <device>:<baud>]\n"
+                    "                             [--replay <file>] [--log] [--listen <port>]\n"
+                    "                             [--forward <from>:<to>[:<system id>]]\n"
+                    "At least one link has to be given, --udp and --serial can be repeated.\n"
+                    "--forward passes the frames received on link <from> on to link <to>,\n"
+                    "links are numbered from 1 in the order given. It can be repeated.\n");
+}
+
+void QGroundControlServer::addUAS(UASInterface* uas)
 {
+    connect(uas, SIGNAL(valueChanged(int,QString,double,quint64)), this, SLOT(publishValue(int,QString,double,quint64)));
+    qDebug() << "New system" << uas->getUASID();
 }
 
+void QGroundControlServer::publishValue(int uasId, QString name, double value, quint64 msec)
+{
+    if (clients.isEmpty()) return;
+
+    QByteArray line = QByteArray::number(msec);
+    line.append(' ');
+    line.append(QByteArray::number(uasId));
+    line.append(' ');
+    line.append(name.toLatin1());
+    line.append(' ');
+    line.append(QByteArray::number(value, 'g', 10));
+    line.append('\n');
+
+    foreach (QTcpSocket* client, clients)
+    {
+        if (client->bytesToWrite() < MAX_CLIENT_BACKLOG)
+        {
+            client->write(line);
+        }
+    }
+}
+
+void QGroundControlServer::acceptClient()
+{
+    while (server.hasPendingConnections())
+    {
+        QTcpSocket* client = server.nextPendingConnection();
+        connect(client, SIGNAL(disconnected()), this, SLOT(removeClient()));
+        clients.append(client);
+        qDebug() << "Client connected from" << client->peerAddress().toString();
+    }
+}
+
+void QGroundControlServer::removeClient()
+{
+    QTcpSocket* client = qobject_cast<QTcpSocket*>(sender());
+    if (client)
+    {
+        clients.removeAll(client);
+        client->deleteLater();
+    }
+}
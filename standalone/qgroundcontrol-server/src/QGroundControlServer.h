@@ -23,36 +23,87 @@ This file is part of the PIXHAWK project
 
 /**
  * @file
- *   @brief Definition of class MAVLinkGen
+ *   @brief Definition of class QGroundControlServer
  *
  *   @author Lorenz Meier <mavteam@student.ethz.ch>
  *
  */
 
+#ifndef QGROUNDCONTROLSERVER_H
+#define QGROUNDCONTROLSERVER_H
 
-#ifndef MAVLINKGEN_H
-#define MAVLINKGEN_H
+#include <QCoreApplication>
+#include <QList>
+#include <QTcpServer>
+#include <QTcpSocket>
 
-#include <QApplication>
+class MAVLinkProtocol;
+class LinkInterface;
+class UASInterface;
 
 /**
- * @brief The main application and management class.
+ * @brief Headless ground station.
  *
- * This class is started by the main method and provides
- * the central management unit of the groundstation application.
+ * Runs the link, protocol and vehicle layers without any widget. Links are
+ * given on the command line:
  *
+ *   --udp <port>              listen for MAVLink on an UDP port (repeatable)
+ *   --serial <device>:<baud>  open a serial port (repeatable)
+ *   --replay <file>           replay a binary packet log as fast as possible
+ *   --log                     write all packets to the binary packet log
+ *   --forward <from>:<to>[:<system id>]
+ *                             pass the frames received on one link on to
+ *                             another, links are numbered from 1 in the
+ *                             order given (repeatable)
+ *   --listen <port>           TCP port for telemetry clients (default 14600)
+ *
+ * Every connected TCP client receives one text line per decoded value:
+ * "<time msec> <system id> <name> <value>". Clients which do not keep
+ * up are skipped until their socket buffer drains, so a stalled client
+ * can not make the server grow.
  **/
-class MAVLinkGen : public QApplication
+class QGroundControlServer : public QCoreApplication
 {
-	Q_OBJECT
+    Q_OBJECT
 
 public:
-        MAVLinkGen(int &argc, char* argv[]);
-        ~MAVLinkGen();
+    QGroundControlServer(int &argc, char* argv[]);
+    ~QGroundControlServer();
 
-protected:
+    /** @brief Check if all links and the client port could be opened */
+    bool isValid() const { return valid; }
+
+    enum
+    {
+        DEFAULT_LISTEN_PORT = 14600,
+        MAX_CLIENT_BACKLOG = 1024*1024 ///< Bytes queued for one client before values are skipped
+    };
 
-private:
+public slots:
+    /** @brief Start publishing the values of a new system */
+    void addUAS(UASInterface* uas);
+    /** @brief Send one decoded value to all clients */
+    void publishValue(int uasId, QString name, double value, quint64 msec);
+
+protected slots:
+    void acceptClient();
+    void removeClient();
+
+protected:
+    /** @brief Parse the command line and create the links */
+    bool parseArguments();
+    /** @brief Attach a link to the protocol and connect it */
+    bool addLink(LinkInterface* link);
+    /** @brief Add a forwarding route given on the command line */
+    bool addForwarding(const QString& spec);
+    void printUsage() const;
+
+    MAVLinkProtocol* mavlink;
+    QTcpServer server;
+    QList<QTcpSocket*> clients;
+    QList<LinkInterface*> links; ///< Links in the order given on the command line
+    quint16 listenPort;
+    bool valid;
 };
 
-#endif /* MAVLINKGEN_H */
+#endif /* QGROUNDCONTROLSERVER_H */
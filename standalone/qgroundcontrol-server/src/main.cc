@@ -28,11 +28,10 @@ This file is part of the PIXHAWK project
  *
  */
 
-#include <QtGui/QApplication>
-#include "MAVLinkGen.h"
+#include "QGroundControlServer.h"
 
 /**
- * @brief Starts the application
+ * @brief Starts the server
  *
  * @param argc Number of commandline arguments
  * @param argv Commandline arguments
@@ -40,7 +39,7 @@ This file is part of the PIXHAWK project
  */
 int main(int argc, char *argv[])
 {
-
-    MAVLinkGen gen(argc, argv);
-    return gen.exec();
+    QGroundControlServer server(argc, argv);
+    if (!server.isValid()) return 1;
+    return server.exec();
 }